@@ -1,10 +1,39 @@
 #include "balloonMesh.h"
+#include <algorithm>
 #include <cmath>
 #include <glm/gtc/constants.hpp>
 #include <glm/glm.hpp>
 
-BalloonMesh::BalloonMesh(int heightSegments, int radialSegments, float height, float radius) {
-    generate(heightSegments, radialSegments, height, radius);
+BalloonMesh::BalloonMesh(int heightSegments, int radialSegments, float height, float radius,
+    int levelCount) : m_height(height) {
+    // segment divisor and smallest projected height (pixels) of every level
+    static const int DIVISOR[MAX_LEVELS] = { 1, 4, 8, 16 };
+    static const float MIN_SCREEN_SIZE[MAX_LEVELS] = { 300.0f, 100.0f, 30.0f, 0.0f };
+
+    levelCount = glm::clamp(levelCount, 1, (int)MAX_LEVELS);
+    levels.resize(levelCount);
+    for (int l = 0; l < levelCount; ++l) {
+        int hSeg = std::max((int)MIN_SEGMENTS, heightSegments / DIVISOR[l]);
+        int rSeg = std::max((int)MIN_SEGMENTS, radialSegments / DIVISOR[l]);
+        generate(levels[l], hSeg, rSeg, height, radius);
+        levels[l].minScreenSize = MIN_SCREEN_SIZE[l];
+    }
+    // the coarsest level takes everything below
+    levels.back().minScreenSize = 0.0f;
+}
+
+int BalloonMesh::selectLevel(float screenSize) const {
+    for (int l = 0; l < (int)levels.size(); ++l) {
+        if (screenSize >= levels[l].minScreenSize)
+            return l;
+    }
+    return (int)levels.size() - 1;
+}
+
+float BalloonMesh::screenSize(float radius, float distance, float fovY, float viewportHeight) const {
+    distance = std::max(distance, 0.001f);
+    float size = m_height * radius;
+    return size / (2.0f * distance * std::tan(0.5f * fovY)) * viewportHeight;
 }
 
 // curve that needs to be revoluted r(y):[0,H]-->[0:R]
@@ -38,68 +67,55 @@ float BalloonMesh::radiusAt(float y, float H, float R){
 }
 
 
-void BalloonMesh::generate(int hSeg, int rSeg, float H, float R) {
-    positions.clear();
-    uvs.clear();
-
-    for (int i = 0; i < hSeg; ++i) {
-        float t0 = (float)i / hSeg;
-        float t1 = (float)(i + 1) / hSeg;
-
-        float y0 = H * t0;
-        float y1 = H * t1;
-
-        float r0 = radiusAt(y0, H, R);
-        float r1 = radiusAt(y1, H, R);
-
-        // for numerical approximation of normals
-        float eps = 0.001f;
-        float drdy0 = (radiusAt(y0 + eps, H, R) - radiusAt(y0 - eps, H, R)) / (2.0f * eps);
-        float drdy1 = (radiusAt(y1 + eps, H, R) - radiusAt(y1 - eps, H, R)) / (2.0f * eps);
+void BalloonMesh::generate(Level& level, int hSeg, int rSeg, float H, float R) {
+    level.heightSegments = hSeg;
+    level.radialSegments = rSeg;
+    level.positions.clear();
+    level.uvs.clear();
+    level.indices.clear();
+
+    // one ring of rSeg + 1 vertices (seam duplicated for the uvs) per height step
+    int ringSize = rSeg + 1;
+    int vertexCount = (hSeg + 1) * ringSize;
+    level.positions.reserve(vertexCount);
+    level.uvs.reserve(vertexCount);
+    level.indices.reserve(hSeg * rSeg * 6);
+
+    std::vector<float> cosTheta(ringSize), sinTheta(ringSize);
+    for (int j = 0; j <= rSeg; ++j) {
+        float th = (float)j / rSeg * glm::two_pi<float>();
+        cosTheta[j] = cos(th);
+        sinTheta[j] = sin(th);
+    }
 
+    for (int i = 0; i <= hSeg; ++i) {
+        float t = (float)i / hSeg;
+        float y = H * t;
+        float r = radiusAt(y, H, R);
 
+        for (int j = 0; j <= rSeg; ++j) {
+            float u = (float)j / rSeg;
+            level.positions.push_back(glm::vec3(r * cosTheta[j], y, r * sinTheta[j]));
+            level.uvs.push_back(glm::vec2(u, t));
+        }
+    }
 
+    for (int i = 0; i < hSeg; ++i) {
         for (int j = 0; j < rSeg; ++j) {
-            float u0 = (float)j / rSeg;
-            float u1 = (float)(j + 1) / rSeg;
-
-            float th0 = u0 * glm::two_pi<float>();
-            float th1 = u1 * glm::two_pi<float>();
-
-            // quad vertices
-            glm::vec3 p00(r0 * cos(th0), y0, r0 * sin(th0));
-            glm::vec3 p10(r1 * cos(th0), y1, r1 * sin(th0));
-            glm::vec3 p11(r1 * cos(th1), y1, r1 * sin(th1));
-            glm::vec3 p01(r0 * cos(th1), y0, r0 * sin(th1));
-
-            glm::vec2 uv00(u0, t0);
-            glm::vec2 uv10(u0, t1);
-            glm::vec2 uv11(u1, t1);
-            glm::vec2 uv01(u1, t0);
-
-            glm::vec3 n00 = glm::normalize(glm::vec3(cos(th0), -drdy0, sin(th0)));
-            glm::vec3 n10 = glm::normalize(glm::vec3(cos(th0), -drdy1, sin(th0)));
-            glm::vec3 n11 = glm::normalize(glm::vec3(cos(th1), -drdy1, sin(th1)));
-            glm::vec3 n01 = glm::normalize(glm::vec3(cos(th1), -drdy0, sin(th1)));
-
+            unsigned int i00 = i * ringSize + j;
+            unsigned int i10 = (i + 1) * ringSize + j;
+            unsigned int i11 = (i + 1) * ringSize + j + 1;
+            unsigned int i01 = i * ringSize + j + 1;
 
             // triangle 1
-            positions.push_back(p00); normals.push_back(n00);
-            positions.push_back(p10); normals.push_back(n10);
-            positions.push_back(p11); normals.push_back(n11);
-
-            uvs.push_back(uv00);
-            uvs.push_back(uv10);
-            uvs.push_back(uv11);
+            level.indices.push_back(i00);
+            level.indices.push_back(i10);
+            level.indices.push_back(i11);
 
             // triangle 2
-            positions.push_back(p00); normals.push_back(n00);
-            positions.push_back(p11); normals.push_back(n11);
-            positions.push_back(p01); normals.push_back(n01);
-
-            uvs.push_back(uv00);
-            uvs.push_back(uv11);
-            uvs.push_back(uv01);
+            level.indices.push_back(i00);
+            level.indices.push_back(i11);
+            level.indices.push_back(i01);
         }
     }
-}
\ No newline at end of file
+}
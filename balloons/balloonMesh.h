@@ -5,22 +5,52 @@
 
 class BalloonMesh {
 public:
-	// vertices (pos, normal, uv)
-	std::vector<glm::vec3> positions;
-	std::vector<glm::vec2> uvs;
-	std::vector<glm::vec3> normals;
-
-	BalloonMesh(int heightSegments = 128, 
-				int radialSegments = 128, 
-				float height = 3.0f, 
-				float radius = 1.0f);
+	static const int MAX_LEVELS = 4;
+
+	// one level of detail, indexed (rings share their vertices)
+	struct Level {
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> uvs;		// no normals, the shaders derive them
+		std::vector<unsigned int> indices;
+		int heightSegments;
+		int radialSegments;
+		float minScreenSize;	// used from this projected height (pixels) up
+
+		int triangleCount() const { return (int)indices.size() / 3; }
+	};
+
+	// level 0 is the full mesh, every next level has 4x, 8x, 16x fewer
+	// segments per direction (at least MIN_SEGMENTS)
+	std::vector<Level> levels;
+
+	BalloonMesh(int heightSegments = 128,
+				int radialSegments = 128,
+				float height = 3.0f,
+				float radius = 1.0f,
+				int levelCount = MAX_LEVELS);
+
+	int levelCount() const { return (int)levels.size(); }
+	const Level& level(int i) const { return levels[i]; }
+
+	// finest level whose minScreenSize fits, coarsest for tiny balloons
+	int selectLevel(float screenSize) const;
+
+	// projected height in pixels of a balloon of the given radius at distance,
+	// for a perspective camera with vertical fov (radians)
+	float screenSize(float radius, float distance, float fovY, float viewportHeight) const;
+
 private:
+	static const int MIN_SEGMENTS = 8;
+
+	float m_height;
+
 	float radiusAt(float y,
 				   float H,
 				   float R);
 
-	void generate(int heightSegments,
+	void generate(Level& level,
+				  int heightSegments,
 		   		  int radialSegments,
 				  float height,
 				  float radius);
-};
\ No newline at end of file
+};
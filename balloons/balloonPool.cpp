@@ -0,0 +1,325 @@
+#include "balloonPool.h"
+
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+#include <common/profiler.h>
+#include <common/threadPool.h>
+#include <physics/forces.h>
+
+using namespace glm;
+
+constexpr float BalloonPool::DEFAULT_RADIUS;
+constexpr float BalloonPool::DEFAULT_MASS;
+
+// rope spring-damper and drag constants (see Forces::ropeSpringDamper)
+static const float ROPE_STIFFNESS = 25.0f;
+static const float ROPE_DAMPING = 8.0f;
+static const float AIR_DRAG = 2.0f;
+
+// short pause to make the spawn visible
+static const float SPAWN_TIME = 0.15f;
+
+// below this many balloons the kernels are not worth splitting
+static const int MIN_CHUNK = 1024;
+
+BalloonPool::BalloonPool()
+    : m_threads(nullptr) {
+}
+
+BalloonPool::~BalloonPool() {
+    clear();
+}
+
+void BalloonPool::reserve(size_t count) {
+    m_posX.reserve(count); m_posY.reserve(count); m_posZ.reserve(count);
+    m_velX.reserve(count); m_velY.reserve(count); m_velZ.reserve(count);
+    m_forceX.reserve(count); m_forceY.reserve(count); m_forceZ.reserve(count);
+    m_anchorX.reserve(count); m_anchorY.reserve(count); m_anchorZ.reserve(count);
+    m_mass.reserve(count);
+    m_lift.reserve(count);
+    m_ropeLength.reserve(count);
+    m_simulated.reserve(count);
+    m_attached.reserve(count);
+    m_popped.reserve(count);
+
+    m_previousPosition.reserve(count);
+    m_radius.reserve(count);
+    m_state.reserve(count);
+    m_spawnTimer.reserve(count);
+    m_type.reserve(count);
+    m_glitterTime.reserve(count);
+    m_verletRope.reserve(count);
+}
+
+void BalloonPool::clear() {
+    m_ropes.clear();
+
+    m_posX.clear(); m_posY.clear(); m_posZ.clear();
+    m_velX.clear(); m_velY.clear(); m_velZ.clear();
+    m_forceX.clear(); m_forceY.clear(); m_forceZ.clear();
+    m_anchorX.clear(); m_anchorY.clear(); m_anchorZ.clear();
+    m_mass.clear();
+    m_lift.clear();
+    m_ropeLength.clear();
+    m_simulated.clear();
+    m_attached.clear();
+    m_popped.clear();
+
+    m_previousPosition.clear();
+    m_radius.clear();
+    m_state.clear();
+    m_spawnTimer.clear();
+    m_type.clear();
+    m_glitterTime.clear();
+    m_verletRope.clear();
+}
+
+int BalloonPool::add(BalloonType type, const vec3& anchor, float ropeLength) {
+    // spawn just above the anchor, at rest
+    vec3 position = anchor + vec3(0.0f, 1.2f, 0.0f);
+
+    m_posX.push_back(position.x); m_posY.push_back(position.y); m_posZ.push_back(position.z);
+    m_velX.push_back(0.0f); m_velY.push_back(0.0f); m_velZ.push_back(0.0f);
+    m_forceX.push_back(0.0f); m_forceY.push_back(0.0f); m_forceZ.push_back(0.0f);
+    m_anchorX.push_back(anchor.x); m_anchorY.push_back(anchor.y); m_anchorZ.push_back(anchor.z);
+    m_mass.push_back(DEFAULT_MASS);
+    m_lift.push_back(Forces::buoyancy(DEFAULT_RADIUS).y);
+    m_ropeLength.push_back(ropeLength);
+    m_simulated.push_back(0);
+    m_attached.push_back(1);
+    m_popped.push_back(0);
+
+    m_previousPosition.push_back(position);
+    m_radius.push_back(DEFAULT_RADIUS);
+    m_state.push_back(BalloonState::Spawn);
+    m_spawnTimer.push_back(0.0f);
+    m_type.push_back(type);
+    m_glitterTime.push_back(0.0f);
+    m_verletRope.push_back(-1);
+
+    return (int)m_type.size() - 1;
+}
+
+void BalloonPool::storePreviousState() {
+    for (size_t i = 0; i < m_previousPosition.size(); ++i) {
+        m_previousPosition[i] = vec3(m_posX[i], m_posY[i], m_posZ[i]);
+    }
+}
+
+// gravity + buoyancy + air drag, plus the rope spring-damper while the rope
+// is taut. Same math (and operation order) as Forces::* so the results match
+// the per-object version bit for bit.
+void BalloonPool::applyForcesRange(int begin, int end) {
+    const float* px = m_posX.data();
+    const float* py = m_posY.data();
+    const float* pz = m_posZ.data();
+    const float* vx = m_velX.data();
+    const float* vy = m_velY.data();
+    const float* vz = m_velZ.data();
+    const float* ax = m_anchorX.data();
+    const float* ay = m_anchorY.data();
+    const float* az = m_anchorZ.data();
+    const float* mass = m_mass.data();
+    const float* lift = m_lift.data();
+    const float* ropeLength = m_ropeLength.data();
+    const unsigned char* attached = m_attached.data();
+    float* fx = m_forceX.data();
+    float* fy = m_forceY.data();
+    float* fz = m_forceZ.data();
+
+    for (int i = begin; i < end; ++i) {
+        // gravity, buoyancy and drag
+        float dragX = -AIR_DRAG * vx[i];
+        float dragY = -AIR_DRAG * vy[i];
+        float dragZ = -AIR_DRAG * vz[i];
+        float baseY = (-9.8f * mass[i] + lift[i]) + dragY;
+
+        // rope constraint (spring + damper basically)
+        float dx = px[i] - ax[i];
+        float dy = py[i] - ay[i];
+        float dz = pz[i] - az[i];
+        float dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+        bool taut = attached[i] && dist > ropeLength[i];
+        float safeDist = taut ? dist : 1.0f;
+        float nx = dx / safeDist;
+        float ny = dy / safeDist;
+        float nz = dz / safeDist;
+
+        float spring = -ROPE_STIFFNESS * (dist - ropeLength[i]);
+        float vRel = vx[i] * nx + vy[i] * ny + vz[i] * nz;
+        float damper = -ROPE_DAMPING * vRel;
+
+        float ropeX = spring * nx + damper * nx;
+        float ropeY = spring * ny + damper * ny;
+        float ropeZ = spring * nz + damper * nz;
+
+        fx[i] = taut ? dragX + ropeX : dragX;
+        fy[i] = taut ? baseY + ropeY : baseY;
+        fz[i] = taut ? dragZ + ropeZ : dragZ;
+    }
+}
+
+// semi-implicit euler (RigidBody::integrate) for the balloons in the Physics
+// state, the others keep their position
+void BalloonPool::integrateRange(int begin, int end, float dt) {
+    float* px = m_posX.data();
+    float* py = m_posY.data();
+    float* pz = m_posZ.data();
+    float* vx = m_velX.data();
+    float* vy = m_velY.data();
+    float* vz = m_velZ.data();
+    float* fx = m_forceX.data();
+    float* fy = m_forceY.data();
+    float* fz = m_forceZ.data();
+    const float* mass = m_mass.data();
+    const unsigned char* simulated = m_simulated.data();
+
+    for (int i = begin; i < end; ++i) {
+        bool active = simulated[i] != 0;
+
+        float newVX = vx[i] + (fx[i] / mass[i]) * dt;
+        float newVY = vy[i] + (fy[i] / mass[i]) * dt;
+        float newVZ = vz[i] + (fz[i] / mass[i]) * dt;
+
+        vx[i] = active ? newVX : vx[i];
+        vy[i] = active ? newVY : vy[i];
+        vz[i] = active ? newVZ : vz[i];
+
+        px[i] = active ? px[i] + vx[i] * dt : px[i];
+        py[i] = active ? py[i] + vy[i] * dt : py[i];
+        pz[i] = active ? pz[i] + vz[i] * dt : pz[i];
+
+        fx[i] = 0.0f;
+        fy[i] = 0.0f;
+        fz[i] = 0.0f;
+    }
+}
+
+// spawn pause: balloons become rigid bodies after SPAWN_TIME
+void BalloonPool::updateStatesRange(int begin, int end, float dt) {
+    for (int i = begin; i < end; ++i) {
+        if (m_state[i] == BalloonState::Spawn) {
+            m_spawnTimer[i] += dt;
+            if (m_spawnTimer[i] > SPAWN_TIME) {
+                m_state[i] = BalloonState::Physics;
+                m_simulated[i] = m_popped[i] ? 0 : 1;
+            }
+        }
+    }
+}
+
+void BalloonPool::setThreadPool(ThreadPool* threads) {
+    m_threads = threads;
+    m_ropes.setThreadPool(threads);
+}
+
+void BalloonPool::updateBodies(float dt) {
+    PROFILE_ZONE("BalloonPool::updateBodies");
+    // each chunk stays in cache between the two kernels
+    auto kernel = [this, dt](int begin, int end) {
+        applyForcesRange(begin, end);
+        integrateRange(begin, end, dt);
+        updateStatesRange(begin, end, dt);
+    };
+
+    if (m_threads) {
+        m_threads->parallelFor((int)size(), MIN_CHUNK, kernel);
+    }
+    else {
+        kernel(0, (int)size());
+    }
+}
+
+void BalloonPool::updateRopes(float dt) {
+    m_ropes.update(dt, 5);
+}
+
+void BalloonPool::setPosition(int i, const vec3& p) {
+    m_posX[i] = p.x;
+    m_posY[i] = p.y;
+    m_posZ[i] = p.z;
+}
+
+void BalloonPool::setVelocity(int i, const vec3& v) {
+    m_velX[i] = v.x;
+    m_velY[i] = v.y;
+    m_velZ[i] = v.z;
+}
+
+vec3 BalloonPool::getRenderPosition(int i, float alpha) const {
+    return mix(m_previousPosition[i], getPosition(i), alpha);
+}
+
+void BalloonPool::updateAnchor(int i, const vec3& anchor) {
+    m_anchorX[i] = anchor.x;
+    m_anchorY[i] = anchor.y;
+    m_anchorZ[i] = anchor.z;
+}
+
+vec3 BalloonPool::getRopeStart(int i) const {
+    if (m_attached[i]) {
+        return getAnchor(i); // chimney
+    }
+
+    // free rope
+    return getPosition(i) - vec3(0.0f, m_ropeLength[i], 0.0f);
+}
+
+void BalloonPool::release(int i) {
+    m_attached[i] = 0;
+}
+
+void BalloonPool::pop(int i) {
+    if (m_popped[i]) return;
+    m_popped[i] = 1;
+    m_attached[i] = 1;
+    m_simulated[i] = 0;
+
+    // Verlet rope from anchor to current balloon position
+    int segments = 20; // number of rope segments for simulation
+    m_verletRope[i] = m_ropes.addRope(getAnchor(i), getPosition(i), segments);
+}
+
+int BalloonPool::countAttached() const {
+    int count = 0;
+    for (size_t i = 0; i < size(); ++i) {
+        if (m_attached[i] && !m_popped[i])
+            count++;
+    }
+    return count;
+}
+
+int BalloonPool::countPopped() const {
+    int count = 0;
+    for (size_t i = 0; i < size(); ++i) {
+        if (m_popped[i])
+            count++;
+    }
+    return count;
+}
+
+void BalloonPool::setHouseBounds(const vec3& min, const vec3& max) {
+    m_ropes.setCollisionBox(min, max);
+}
+
+void BalloonPool::writeRenderStates(std::vector<BalloonRenderState>& out, float alpha) const {
+    out.clear();
+    for (int i = 0; i < (int)size(); ++i) {
+        if (m_popped[i]) continue;
+        BalloonRenderState state;
+        state.position = getRenderPosition(i, alpha);
+        state.radius = m_radius[i];
+        state.type = m_type[i];
+        state.glitterTime = m_glitterTime[i];
+        out.push_back(state);
+    }
+}
+
+mat4 BalloonPool::getContentMatrix(const vec3& position) {
+    mat4 innerM(1.0f);
+    innerM = translate(innerM, position + vec3(0.0f, 0.75f, 0.0f));
+    innerM = rotate(innerM, -3.14f / 4.0f, vec3(1.0f, 0.0f, 0.0f));
+    innerM = scale(innerM, vec3(5.0f));
+    return innerM;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "balloonTypes.h"
+#include "ropeWorld.h"
+
+class ThreadPool;
+
+// a balloon that is not popped, as the renderer draws it
+struct BalloonRenderState {
+    glm::vec3 position;
+    float radius;
+    BalloonType type;
+    float glitterTime;
+};
+
+enum class BalloonState {
+    Spawn,
+    Physics,
+    Popped
+};
+
+// All the balloons of a house in structure-of-arrays form.
+// Balloons are addressed by index. The hot physics state (position, velocity,
+// force, anchor) lives in one float array per component so the force and
+// integration kernels of updateBodies() are plain loops over contiguous
+// memory the compiler can vectorize, and which can be split across a
+// ThreadPool. Pure data and simulation, the drawing is BalloonRenderer's.
+class BalloonPool {
+public:
+    static constexpr float DEFAULT_RADIUS = 0.5f;
+    static constexpr float DEFAULT_MASS = 1.2f;
+
+    BalloonPool();
+    ~BalloonPool();
+
+    // owns the verlet ropes
+    BalloonPool(const BalloonPool&) = delete;
+    BalloonPool& operator=(const BalloonPool&) = delete;
+
+    void reserve(size_t count);
+    void clear();
+
+    // new balloon hanging from anchor on a rope of ropeLength, returns its index
+    int add(BalloonType type, const glm::vec3& anchor, float ropeLength);
+
+    size_t size() const { return m_type.size(); }
+    bool empty() const { return m_type.empty(); }
+
+    // simulation (all balloons), two halves independent of each other: the
+    // balloons (forces + integration in one pass over the arrays), and the
+    // verlet ropes of the popped ones
+    void updateBodies(float dt);
+    void updateRopes(float dt);
+    // snapshot before a fixed step, used for render interpolation
+    void storePreviousState();
+
+    // split the batched kernels across this pool (null = single threaded)
+    void setThreadPool(ThreadPool* threads);
+
+    // per balloon state
+    glm::vec3 getPosition(int i) const { return glm::vec3(m_posX[i], m_posY[i], m_posZ[i]); }
+    void setPosition(int i, const glm::vec3& p);
+    glm::vec3 getVelocity(int i) const { return glm::vec3(m_velX[i], m_velY[i], m_velZ[i]); }
+    void setVelocity(int i, const glm::vec3& v);
+    glm::vec3 getRenderPosition(int i, float alpha) const;
+    float getMass(int i) const { return m_mass[i]; }
+    float getRadius(int i) const { return m_radius[i]; }
+
+    // balloon-rope relation
+    bool isRopeAttached(int i) const { return m_attached[i] != 0; }
+    bool isPopped(int i) const { return m_popped[i] != 0; }
+    glm::vec3 getAnchor(int i) const { return glm::vec3(m_anchorX[i], m_anchorY[i], m_anchorZ[i]); }
+    void updateAnchor(int i, const glm::vec3& anchor);
+    float getRopeLength(int i) const { return m_ropeLength[i]; }
+    glm::vec3 getRopeStart(int i) const;
+    // verlet rope of a popped balloon in getRopes(), -1 if none
+    int getVerletRope(int i) const { return m_verletRope[i]; }
+    const RopeWorld& getRopes() const { return m_ropes; }
+
+    // balloon types
+    BalloonType getType(int i) const { return m_type[i]; }
+    glm::vec3 getColor(int i) const { return getBalloonColor(m_type[i]); }
+    float getGlitterTime(int i) const { return m_glitterTime[i]; }
+
+    // balloon methods
+    void release(int i);
+    void pop(int i);
+
+    // attached, non-popped balloons
+    int countAttached() const;
+    int countPopped() const;
+
+    // house collision box for the popped (verlet) ropes
+    void setHouseBounds(const glm::vec3& min, const glm::vec3& max);
+
+    // render
+    // the balloons that are not popped, between the last two steps; out
+    // keeps its storage
+    void writeRenderStates(std::vector<BalloonRenderState>& out, float alpha) const;
+    // model matrix of the banana inside a transparent balloon at position
+    static glm::mat4 getContentMatrix(const glm::vec3& position);
+
+private:
+    // kernels on [begin, end)
+    void applyForcesRange(int begin, int end);
+    void integrateRange(int begin, int end, float dt);
+    void updateStatesRange(int begin, int end, float dt);
+
+    ThreadPool* m_threads;
+
+    // hot: one array per component
+    std::vector<float> m_posX, m_posY, m_posZ;
+    std::vector<float> m_velX, m_velY, m_velZ;
+    std::vector<float> m_forceX, m_forceY, m_forceZ;
+    std::vector<float> m_anchorX, m_anchorY, m_anchorZ;
+    std::vector<float> m_mass;
+    std::vector<float> m_lift;          // buoyancy, constant per balloon
+    std::vector<float> m_ropeLength;
+    std::vector<unsigned char> m_simulated; // 1 while in the Physics state
+    std::vector<unsigned char> m_attached;
+    std::vector<unsigned char> m_popped;
+
+    // cold
+    std::vector<glm::vec3> m_previousPosition;
+    std::vector<float> m_radius;
+    std::vector<BalloonState> m_state;
+    std::vector<float> m_spawnTimer;
+    std::vector<BalloonType> m_type;
+    std::vector<float> m_glitterTime;
+    std::vector<int> m_verletRope;      // popped balloons only, else -1
+
+    // the falling ropes of all popped balloons
+    RopeWorld m_ropes;
+};
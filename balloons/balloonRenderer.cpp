@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cstddef>
+#include "balloonRenderer.h"
+
+using namespace glm;
+
+BalloonRenderer::BalloonRenderer(const BalloonMesh& mesh, const std::vector<Drawable*>& lods)
+    : m_mesh(mesh), m_lods(lods), m_instanceVBO(0), m_capacity(64) {
+    for (int b = 0; b < BUCKET_COUNT; ++b) {
+        m_first[b] = 0;
+        m_count[b] = 0;
+    }
+
+    glGenBuffers(1, &m_instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(Instance), NULL, GL_STREAM_DRAW);
+
+    // the divisors only matter while draw() has the attributes enabled
+    for (int l = 0; l < (int)m_lods.size(); ++l) {
+        m_lods[l]->bind();
+        glVertexAttribDivisor(TRANSFORM_LOCATION, 1);
+        glVertexAttribDivisor(COLOR_LOCATION, 1);
+    }
+    glBindVertexArray(0);
+}
+
+BalloonRenderer::~BalloonRenderer() {
+    glDeleteBuffers(1, &m_instanceVBO);
+}
+
+int BalloonRenderer::getInstanceCount(BalloonType type) const {
+    int count = 0;
+    for (int l = 0; l < LEVEL_COUNT; ++l) {
+        count += getInstanceCount(type, l);
+    }
+    return count;
+}
+
+void BalloonRenderer::update(const std::vector<BalloonRenderState>& balloons, const vec3& eye,
+    float fovY, float viewportHeight) {
+    int n = (int)balloons.size();
+    int maxLevel = (int)m_lods.size() - 1;
+
+    // counting sort by (type, level)
+    int counts[BUCKET_COUNT] = { 0 };
+    m_bucket.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const BalloonRenderState& balloon = balloons[i];
+        float distance = length(balloon.position - eye);
+        float size = m_mesh.screenSize(balloon.radius, distance, fovY, viewportHeight);
+        int level = std::min(m_mesh.selectLevel(size), maxLevel);
+
+        int bucket = (int)balloon.type * LEVEL_COUNT + level;
+        m_bucket[i] = (unsigned char)bucket;
+        counts[bucket]++;
+    }
+    int total = 0;
+    for (int b = 0; b < BUCKET_COUNT; ++b) {
+        m_first[b] = total;
+        m_count[b] = 0;
+        total += counts[b];
+    }
+
+    vec3 diffuse[TYPE_COUNT];
+    for (int t = 0; t < TYPE_COUNT; ++t) {
+        diffuse[t] = getBalloonDiffuse((BalloonType)t);
+    }
+
+    m_instances.resize(total);
+    for (int i = 0; i < n; ++i) {
+        const BalloonRenderState& balloon = balloons[i];
+        int b = m_bucket[i];
+
+        Instance& instance = m_instances[m_first[b] + m_count[b]++];
+        instance.transform = vec4(balloon.position, balloon.radius);
+        instance.color = vec4(diffuse[b / LEVEL_COUNT], balloon.glitterTime);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    while (m_capacity < (size_t)total) m_capacity *= 2;
+    // orphan the old storage so the driver does not wait for last frame's draws
+    glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(Instance), NULL, GL_STREAM_DRAW);
+    if (total > 0) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, total * sizeof(Instance), &m_instances[0]);
+    }
+}
+
+void BalloonRenderer::drawAll(int level) {
+    level = clamp(level, 0, (int)m_lods.size() - 1);
+    m_lods[level]->bind();
+    draw(level, 0, (int)m_instances.size());
+}
+
+void BalloonRenderer::drawType(BalloonType type) {
+    for (int l = 0; l < (int)m_lods.size(); ++l) {
+        int b = (int)type * LEVEL_COUNT + l;
+        if (m_count[b] == 0) continue;
+        m_lods[l]->bind();
+        draw(l, m_first[b], m_count[b]);
+    }
+}
+
+void BalloonRenderer::draw(int level, int first, int count) {
+    if (count == 0) return;
+
+    // GL 3.3 has no base instance, point the attributes at the first instance
+    // of the range instead
+    const char* base = (const char*)NULL + first * sizeof(Instance);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glVertexAttribPointer(TRANSFORM_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+        base + offsetof(Instance, transform));
+    glVertexAttribPointer(COLOR_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+        base + offsetof(Instance, color));
+    glEnableVertexAttribArray(TRANSFORM_LOCATION);
+    glEnableVertexAttribArray(COLOR_LOCATION);
+
+    glDrawElementsInstanced(GL_TRIANGLES, m_lods[level]->indexCount,
+        m_lods[level]->indexType, NULL, count);
+
+    // the LOD VAOs also serve ordinary draws of the balloon mesh
+    glDisableVertexAttribArray(TRANSFORM_LOCATION);
+    glDisableVertexAttribArray(COLOR_LOCATION);
+}
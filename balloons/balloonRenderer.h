@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+#include <common/model.h>
+
+#include "balloonMesh.h"
+#include "balloonPool.h"
+
+// Draws all the balloons of a BalloonPool (its render states) with one
+// instanced call per type and level of detail.
+// update() sorts the visible balloons by BalloonType and LOD into a
+// per-instance buffer (position + scale, colour + glitter time) attached to
+// the balloon meshes, so the number of draw calls does not grow with the
+// balloons. The shaders read the instance attributes when useInstancing is 1.
+class BalloonRenderer {
+public:
+    static const int TYPE_COUNT = 6;
+    static const int LEVEL_COUNT = BalloonMesh::MAX_LEVELS;
+
+    // instance attribute locations, after the mesh's pos / normal / uv
+    static const GLuint TRANSFORM_LOCATION = 3;
+    static const GLuint COLOR_LOCATION = 4;
+
+    struct Instance {
+        glm::vec4 transform; // xyz: position, w: scale (radius)
+        glm::vec4 color;     // rgb: diffuse colour, a: glitter time
+    };
+
+    // lods: one Drawable per level of mesh (finest first), the instance
+    // attributes are enabled on their VAOs only for the instanced draws
+    BalloonRenderer(const BalloonMesh& mesh, const std::vector<Drawable*>& lods);
+    ~BalloonRenderer();
+
+    BalloonRenderer(const BalloonRenderer&) = delete;
+    BalloonRenderer& operator=(const BalloonRenderer&) = delete;
+
+    // rebuild and upload the instance buffer from BalloonPool::writeRenderStates,
+    // the level of every balloon is picked by its projected size seen from eye
+    void update(const std::vector<BalloonRenderState>& balloons, const glm::vec3& eye,
+        float fovY, float viewportHeight);
+
+    // every balloon in one call with the given level, for the depth pass
+    void drawAll(int level);
+    // balloons of one type (one call per level in use), material and shader
+    // flag are set by the caller
+    void drawType(BalloonType type);
+
+    int getInstanceCount() const { return (int)m_instances.size(); }
+    int getInstanceCount(BalloonType type) const;
+    int getInstanceCount(BalloonType type, int level) const {
+        return m_count[(int)type * LEVEL_COUNT + level];
+    }
+
+private:
+    static const int BUCKET_COUNT = TYPE_COUNT * LEVEL_COUNT;
+
+    void draw(int level, int first, int count);
+
+    const BalloonMesh& m_mesh;
+    std::vector<Drawable*> m_lods; // not owned
+    GLuint m_instanceVBO;
+    size_t m_capacity;  // instances the GPU buffer can hold
+
+    std::vector<Instance> m_instances;
+    // bucket type * LEVEL_COUNT + level
+    int m_first[BUCKET_COUNT];
+    int m_count[BUCKET_COUNT];
+    std::vector<unsigned char> m_bucket; // per balloon, scratch for update()
+};
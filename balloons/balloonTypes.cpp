@@ -94,6 +94,11 @@ Material getBalloonMaterial(BalloonType type) {
     }
 }
 
+// diffuse colour of the material, per-instance colour of the balloon renderer
+glm::vec3 getBalloonDiffuse(BalloonType type) {
+    return glm::vec3(getBalloonMaterial(type).Kd);
+}
+
 
 // get shader flag
 // glUniform1i(useTextureLocation, flag)
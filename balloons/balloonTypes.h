@@ -19,6 +19,9 @@ struct Material;
 
 vec3 getBalloonColor(BalloonType type);
 
+// diffuse colour of the material (Kd.rgb)
+vec3 getBalloonDiffuse(BalloonType type);
+
 // get material (Ka, Kd, Ks, Ns)
 Material getBalloonMaterial(BalloonType type);
 
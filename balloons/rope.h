@@ -0,0 +1,8 @@
+#pragma once
+
+// rope dimensions, the tube geometry is built by RopeRenderer
+class Rope {
+public:
+    static constexpr float DEFAULT_LENGTH = 5.0f;
+    static constexpr float DEFAULT_RADIUS = 0.01f;
+};
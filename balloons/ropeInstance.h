@@ -1,16 +1,22 @@
 #pragma once
 
 #include <glm/glm.hpp>
-#include <common/model.h>
 
 class RopeInstance {
 public:
+    // bezier samples handed to the renderer: SEGMENTS + 1 points
+    static const int SEGMENTS = 16;
+
     RopeInstance(float length);
 
     float getLength() const { return m_length; }
 
     void update(const glm::vec3& anchor, const glm::vec3& balloonPos);
-    void draw(GLuint modelMatrixLocation) const;
+    // curve points (alpha interpolates the last step), SEGMENTS + 1 of them
+    void getRenderPoints(float alpha, glm::vec3* points) const;
+
+    // snapshot before a fixed step, used for render interpolation
+    void storePreviousState();
 
     void updateBezier(const glm::vec3& anchor, const glm::vec3& end, bool hanging, float dt);
 
@@ -21,9 +27,12 @@ private:
     glm::vec3 m_balloonPos;
     float m_length;
 
-    Drawable* m_mesh;
-
     // Bezier control
     float m_sag;          // hanging coeff
     bool m_hanging;       // hanging flag (bascially balloon popped flag)
+
+    // curve at the start of the last fixed step
+    glm::vec3 m_prevAnchor;
+    glm::vec3 m_prevEnd;
+    float m_prevSag;
 };
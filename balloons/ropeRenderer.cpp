@@ -0,0 +1,148 @@
+#include "ropeRenderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <glm/gtc/constants.hpp>
+
+using namespace glm;
+
+RopeRenderer::RopeRenderer(int radialSegments, float radius)
+    : m_radialSegments(radialSegments), m_radius(radius),
+    m_VAO(0), m_VBO(0), m_EBO(0), m_vertexCapacity(0), m_indexCapacity(0),
+    m_vertices(nullptr), m_indices(nullptr), m_vertexCount(0), m_indexCount(0) {
+    for (int j = 0; j < radialSegments; ++j) {
+        float a = float(j) / radialSegments * two_pi<float>();
+        m_cos.push_back(cos(a));
+        m_sin.push_back(sin(a));
+    }
+
+    glGenVertexArrays(1, &m_VAO);
+    glBindVertexArray(m_VAO);
+
+    glGenBuffers(1, &m_VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+        (void*)offsetof(Vertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+        (void*)offsetof(Vertex, normal));
+    glEnableVertexAttribArray(1);
+
+    glGenBuffers(1, &m_EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+
+    glBindVertexArray(0);
+
+    // a few dozen ropes before the first grow
+    reserve(64 * 32 * radialSegments, 64 * 32 * radialSegments * 6);
+}
+
+RopeRenderer::~RopeRenderer() {
+    glDeleteBuffers(1, &m_VBO);
+    glDeleteBuffers(1, &m_EBO);
+    glDeleteVertexArrays(1, &m_VAO);
+}
+
+void RopeRenderer::reserve(int vertices, int indices) {
+    glBindVertexArray(m_VAO);
+    if (vertices > m_vertexCapacity) {
+        m_vertexCapacity = std::max(vertices, 2 * m_vertexCapacity);
+        glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+        glBufferData(GL_ARRAY_BUFFER, m_vertexCapacity * sizeof(Vertex), NULL, GL_STREAM_DRAW);
+    }
+    if (indices > m_indexCapacity) {
+        m_indexCapacity = std::max(indices, 2 * m_indexCapacity);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indexCapacity * sizeof(GLuint), NULL, GL_STREAM_DRAW);
+    }
+    glBindVertexArray(0);
+}
+
+void RopeRenderer::begin(int maxPoints) {
+    reserve(maxPoints * m_radialSegments, maxPoints * m_radialSegments * 6);
+
+    // GL 3.3 has no persistent mapping: map the whole buffer every frame and
+    // let the driver hand out fresh storage (invalidate) instead of waiting
+    // for the previous frame's draw
+    glBindVertexArray(m_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    m_vertices = (Vertex*)glMapBufferRange(GL_ARRAY_BUFFER, 0,
+        m_vertexCapacity * sizeof(Vertex), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    m_indices = (GLuint*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0,
+        m_indexCapacity * sizeof(GLuint), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    glBindVertexArray(0);
+
+    m_vertexCount = 0;
+    m_indexCount = 0;
+}
+
+void RopeRenderer::addRope(const vec3* points, int count) {
+    if (!m_vertices || !m_indices || count < 2) return;
+
+    int R = m_radialSegments;
+    if (m_vertexCount + count * R > m_vertexCapacity ||
+        m_indexCount + (count - 1) * R * 6 > m_indexCapacity)
+        return;
+
+    // rings around the polyline, the frame is carried from point to point
+    // (parallel transport) so the tube does not twist
+    GLuint base = (GLuint)m_vertexCount;
+    vec3 tangent(0.0f, 1.0f, 0.0f);
+    vec3 normal(1.0f, 0.0f, 0.0f);
+    for (int k = 0; k < count; ++k) {
+        vec3 d = points[std::min(k + 1, count - 1)] - points[std::max(k - 1, 0)];
+        float len = length(d);
+        if (len > 0.0001f) {
+            tangent = d / len;
+        }
+
+        vec3 n = normal - tangent * dot(normal, tangent);
+        if (length(n) < 0.0001f) {
+            // normal ended up along the rope, pick any perpendicular
+            vec3 up = abs(tangent.y) > 0.9f ? vec3(1, 0, 0) : vec3(0, 1, 0);
+            n = cross(tangent, up);
+        }
+        normal = normalize(n);
+        // same winding as the old per-segment rope mesh
+        vec3 binormal = cross(normal, tangent);
+
+        Vertex* ring = m_vertices + m_vertexCount;
+        for (int j = 0; j < R; ++j) {
+            vec3 dir = m_cos[j] * normal + m_sin[j] * binormal;
+            ring[j].position = points[k] + m_radius * dir;
+            ring[j].normal = dir;
+        }
+        m_vertexCount += R;
+    }
+
+    GLuint* out = m_indices + m_indexCount;
+    for (int k = 0; k < count - 1; ++k) {
+        for (int j = 0; j < R; ++j) {
+            GLuint a = base + k * R + j;
+            GLuint b = base + k * R + (j + 1) % R;
+            GLuint c = a + R;
+            GLuint d = b + R;
+
+            *out++ = a; *out++ = c; *out++ = d;
+            *out++ = a; *out++ = d; *out++ = b;
+        }
+    }
+    m_indexCount += (count - 1) * R * 6;
+}
+
+void RopeRenderer::end() {
+    glBindVertexArray(m_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    if (m_vertices) glUnmapBuffer(GL_ARRAY_BUFFER);
+    if (m_indices) glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+    glBindVertexArray(0);
+
+    m_vertices = nullptr;
+    m_indices = nullptr;
+}
+
+void RopeRenderer::draw() const {
+    if (m_indexCount == 0) return;
+    glBindVertexArray(m_VAO);
+    glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, NULL);
+}
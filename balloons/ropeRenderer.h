@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "rope.h"
+
+// Draws every rope of the scene (bezier ropes of attached balloons and verlet
+// ropes of popped ones) in a single call.
+// Each rope is given as a polyline; begin() maps a streaming vertex/index
+// buffer, addRope() writes a tube around the polyline straight into it and
+// end() unmaps it. The buffers only grow, so a steady scene does not allocate.
+// Vertex layout: location 0 position, location 1 normal (world space), drawn
+// with an identity model matrix.
+class RopeRenderer {
+public:
+    RopeRenderer(int radialSegments = 8, float radius = Rope::DEFAULT_RADIUS);
+    ~RopeRenderer();
+
+    RopeRenderer(const RopeRenderer&) = delete;
+    RopeRenderer& operator=(const RopeRenderer&) = delete;
+
+    // maxPoints: upper bound of the polyline points added until end()
+    void begin(int maxPoints);
+    // tube along points[0 .. count), ignored when full or count < 2
+    void addRope(const glm::vec3* points, int count);
+    void end();
+
+    void draw() const;
+
+    int getVertexCount() const { return m_vertexCount; }
+    int getIndexCount() const { return m_indexCount; }
+
+private:
+    struct Vertex {
+        glm::vec3 position;
+        glm::vec3 normal;
+    };
+
+    void reserve(int vertices, int indices);
+
+    int m_radialSegments;
+    float m_radius;
+    std::vector<float> m_cos, m_sin; // ring directions
+
+    GLuint m_VAO;
+    GLuint m_VBO;
+    GLuint m_EBO;
+    int m_vertexCapacity;
+    int m_indexCapacity;
+
+    // current frame, valid between begin() and end()
+    Vertex* m_vertices;
+    GLuint* m_indices;
+    int m_vertexCount;
+    int m_indexCount;
+};
@@ -0,0 +1,211 @@
+#include "ropeWorld.h"
+#include <cmath>
+#include <common/profiler.h>
+#include <common/threadPool.h>
+
+using namespace glm;
+
+static const float GRAVITY = -9.8f;
+// air damping (to prevent infinite swinging)
+static const float AIR_DAMPING = 0.98f;
+// small offset to prevent re-collision after the push-out
+static const float PUSH_OUT = 0.02f;
+
+// below this many ropes a chunk is not worth a thread
+static const int MIN_CHUNK = 16;
+
+RopeWorld::RopeWorld()
+    : m_threads(nullptr), m_boxMin(0.0f), m_boxMax(0.0f) {
+}
+
+void RopeWorld::clear() {
+    m_posX.clear(); m_posY.clear(); m_posZ.clear();
+    m_oldX.clear(); m_oldY.clear(); m_oldZ.clear();
+    m_weight.clear();
+    m_restLength.clear();
+    m_segment.clear();
+    m_offset.clear();
+    m_count.clear();
+}
+
+void RopeWorld::reserve(int ropes, int points) {
+    m_posX.reserve(points); m_posY.reserve(points); m_posZ.reserve(points);
+    m_oldX.reserve(points); m_oldY.reserve(points); m_oldZ.reserve(points);
+    m_weight.reserve(points);
+    m_restLength.reserve(points);
+    m_segment.reserve(points);
+    m_offset.reserve(ropes);
+    m_count.reserve(ropes);
+}
+
+int RopeWorld::addRope(const vec3& start, const vec3& end, int segments) {
+    float restLength = length(end - start) / segments;
+
+    m_offset.push_back(pointCount());
+    m_count.push_back(segments + 1);
+
+    // divide the rope into points, the first one is pinned (chimney)
+    for (int i = 0; i <= segments; ++i) {
+        float t = float(i) / segments;
+        vec3 pos = mix(start, end, t);
+
+        m_posX.push_back(pos.x); m_posY.push_back(pos.y); m_posZ.push_back(pos.z);
+        m_oldX.push_back(pos.x); m_oldY.push_back(pos.y); m_oldZ.push_back(pos.z);
+        m_weight.push_back(i == 0 ? 0.0f : 1.0f);
+        m_restLength.push_back(restLength);
+        m_segment.push_back(i < segments ? 1.0f : 0.0f);
+    }
+
+    return ropeCount() - 1;
+}
+
+void RopeWorld::pinStart(int rope, const vec3& position) {
+    int p = m_offset[rope];
+    m_posX[p] = m_oldX[p] = position.x;
+    m_posY[p] = m_oldY[p] = position.y;
+    m_posZ[p] = m_oldZ[p] = position.z;
+    m_weight[p] = 0.0f;
+}
+
+void RopeWorld::setCollisionBox(const vec3& min, const vec3& max) {
+    m_boxMin = min;
+    m_boxMax = max;
+}
+
+vec3 RopeWorld::getRenderPoint(int p, float alpha) const {
+    return mix(getPreviousPoint(p), getPoint(p), alpha);
+}
+
+// Verlet integration: x_new = x + (x - x_old) + a*dt^2, pinned points have
+// no velocity and weight 0 so they stay put
+void RopeWorld::integrateRange(int begin, int end, float dt) {
+    float* px = m_posX.data();
+    float* py = m_posY.data();
+    float* pz = m_posZ.data();
+    float* ox = m_oldX.data();
+    float* oy = m_oldY.data();
+    float* oz = m_oldZ.data();
+    const float* w = m_weight.data();
+
+    float damping = AIR_DAMPING * dt;
+    float gravity = GRAVITY * dt * dt;
+
+    for (int p = begin; p < end; ++p) {
+        float vx = px[p] - ox[p];
+        float vy = py[p] - oy[p];
+        float vz = pz[p] - oz[p];
+        ox[p] = px[p];
+        oy[p] = py[p];
+        oz[p] = pz[p];
+
+        px[p] += w[p] * (vx + vx * damping);
+        py[p] += w[p] * (vy + gravity + vy * damping);
+        pz[p] += w[p] * (vz + vz * damping);
+    }
+}
+
+// distance constraints of the segments p = parity (mod 2) in [begin, end):
+// each free end takes half the correction back to the rest length
+void RopeWorld::constrainRange(int begin, int end, int parity) {
+    float* px = m_posX.data();
+    float* py = m_posY.data();
+    float* pz = m_posZ.data();
+    const float* w = m_weight.data();
+    const float* rest = m_restLength.data();
+    const float* segment = m_segment.data();
+
+    int first = begin + (((begin & 1) != parity) ? 1 : 0);
+    for (int p = first; p < end - 1; p += 2) {
+        float dx = px[p + 1] - px[p];
+        float dy = py[p + 1] - py[p];
+        float dz = pz[p + 1] - pz[p];
+        float len = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+        // no segment to the next rope, and degenerate segments are skipped
+        bool valid = segment[p] != 0.0f && len >= 0.0001f;
+        float k = valid ? 0.5f * (len - rest[p]) / len : 0.0f;
+
+        float cx = dx * k;
+        float cy = dy * k;
+        float cz = dz * k;
+
+        px[p] += cx * w[p];
+        py[p] += cy * w[p];
+        pz[p] += cz * w[p];
+        px[p + 1] -= cx * w[p + 1];
+        py[p + 1] -= cy * w[p + 1];
+        pz[p + 1] -= cz * w[p + 1];
+    }
+}
+
+// free points inside the house box are thrown out through the nearest face
+void RopeWorld::collideRange(int begin, int end) {
+    if (m_boxMin == m_boxMax) return;
+
+    float* px = m_posX.data();
+    float* py = m_posY.data();
+    float* pz = m_posZ.data();
+    const float* w = m_weight.data();
+
+    for (int p = begin; p < end; ++p) {
+        if (w[p] == 0.0f) continue;
+
+        vec3 pos(px[p], py[p], pz[p]);
+        if (pos.x < m_boxMin.x || pos.x > m_boxMax.x ||
+            pos.y < m_boxMin.y || pos.y > m_boxMax.y ||
+            pos.z < m_boxMin.z || pos.z > m_boxMax.z)
+            continue;
+
+        float distances[6] = {
+            pos.x - m_boxMin.x,  // dist to left face
+            m_boxMax.x - pos.x,  // dist to right face
+            pos.y - m_boxMin.y,  // dist bottom face
+            m_boxMax.y - pos.y,  // dist to top face
+            pos.z - m_boxMin.z,  // dist to front face
+            m_boxMax.z - pos.z   // dist to back face
+        };
+
+        // get nearest face
+        int minIdx = 0;
+        for (int i = 1; i < 6; ++i) {
+            if (distances[i] < distances[minIdx])
+                minIdx = i;
+        }
+
+        switch (minIdx) {
+        case 0: px[p] = m_boxMin.x - PUSH_OUT; break;
+        case 1: px[p] = m_boxMax.x + PUSH_OUT; break;
+        case 2: py[p] = m_boxMin.y - PUSH_OUT; break;
+        case 3: py[p] = m_boxMax.y + PUSH_OUT; break;
+        case 4: pz[p] = m_boxMin.z - PUSH_OUT; break;
+        case 5: pz[p] = m_boxMax.z + PUSH_OUT; break;
+        }
+    }
+}
+
+void RopeWorld::update(float dt, int iterations) {
+    PROFILE_ZONE("RopeWorld::update");
+    if (m_offset.empty()) return;
+
+    // ropes [ropeBegin, ropeEnd) own one contiguous run of points, a chunk
+    // runs every pass on its own ropes
+    auto kernel = [this, dt, iterations](int ropeBegin, int ropeEnd) {
+        int begin = m_offset[ropeBegin];
+        int end = m_offset[ropeEnd - 1] + m_count[ropeEnd - 1];
+
+        integrateRange(begin, end, dt);
+        // constraints - apply multiple times for stability
+        for (int i = 0; i < iterations; ++i) {
+            constrainRange(begin, end, 0);
+            constrainRange(begin, end, 1);
+        }
+        collideRange(begin, end);
+    };
+
+    if (m_threads) {
+        m_threads->parallelFor(ropeCount(), MIN_CHUNK, kernel);
+    }
+    else {
+        kernel(0, ropeCount());
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+class ThreadPool;
+
+// All the verlet ropes (popped balloons) solved together.
+// The points of every rope live in one structure-of-arrays buffer, rope r
+// owning points [offset(r), offset(r) + pointCount(r)). Segment p joins point
+// p and p + 1; the last point of a rope has no segment, so passes can run over
+// the whole buffer (or any range of whole ropes) without looking at the rope
+// boundaries. The distance constraints are solved red/black: first every even
+// segment, then every odd one. Segments of one colour share no points, so each
+// pass is a plain loop without dependencies between iterations.
+class RopeWorld {
+public:
+    RopeWorld();
+
+    void clear();
+    void reserve(int ropes, int points);
+
+    // new rope of segments + 1 points from start (pinned) to end, returns its id
+    int addRope(const glm::vec3& start, const glm::vec3& end, int segments);
+
+    int ropeCount() const { return (int)m_offset.size(); }
+    int pointCount() const { return (int)m_posX.size(); }
+
+    // integration, constraint iterations and house push-out for every rope
+    void update(float dt, int iterations = 5);
+
+    // split the ropes across this pool (null = single threaded)
+    void setThreadPool(ThreadPool* threads) { m_threads = threads; }
+
+    // move the first point of a rope (chimney anchor) and pin it
+    void pinStart(int rope, const glm::vec3& position);
+    // house AABB the rope points are pushed out of
+    void setCollisionBox(const glm::vec3& min, const glm::vec3& max);
+
+    // per rope points
+    int getOffset(int rope) const { return m_offset[rope]; }
+    int getPointCount(int rope) const { return m_count[rope]; }
+    glm::vec3 getPoint(int p) const { return glm::vec3(m_posX[p], m_posY[p], m_posZ[p]); }
+    // position at the start of the last step
+    glm::vec3 getPreviousPoint(int p) const { return glm::vec3(m_oldX[p], m_oldY[p], m_oldZ[p]); }
+    glm::vec3 getRenderPoint(int p, float alpha) const;
+
+private:
+    // kernels on the points [begin, end) (whole ropes)
+    void integrateRange(int begin, int end, float dt);
+    void constrainRange(int begin, int end, int parity);
+    void collideRange(int begin, int end);
+
+    ThreadPool* m_threads;
+
+    // per point
+    std::vector<float> m_posX, m_posY, m_posZ;
+    std::vector<float> m_oldX, m_oldY, m_oldZ;
+    std::vector<float> m_weight;      // 0 pinned, 1 free
+    std::vector<float> m_restLength;  // segment to the next point
+    std::vector<float> m_segment;     // 1 if the next point is on the same rope
+
+    // per rope
+    std::vector<int> m_offset;
+    std::vector<int> m_count;
+
+    glm::vec3 m_boxMin;
+    glm::vec3 m_boxMax;
+};
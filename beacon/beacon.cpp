@@ -1,5 +1,5 @@
 #include "beacon.h"
-#include <terrain/terrain.h>
+#include <terrain/heightfield.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/constants.hpp>
 #include <cmath>
@@ -15,7 +15,6 @@ Beacon::Beacon(const vec3& position, float radius, float height)
     m_animationTime(0.0f),
     m_animationSpeed(1.0f)
 {
-    generateCylinderMesh(16, 8);
 }
 
 Beacon::~Beacon() {
@@ -24,6 +23,12 @@ Beacon::~Beacon() {
     }
 }
 
+void Beacon::createMesh() {
+    if (!m_mesh) {
+        generateCylinderMesh(16, 8);
+    }
+}
+
 void Beacon::generateCylinderMesh(int radialSegments, int heightSegments) {
     std::vector<vec3> vertices;
     std::vector<vec2> uvs;
@@ -93,7 +98,7 @@ void Beacon::update(float dt) {
     }
 }
 
-void Beacon::draw(GLuint modelMatrixLocation, GLuint timeLocation) const {
+void Beacon::draw(GLuint modelMatrixLocation, GLuint timeLocation, float animationTime) const {
     mat4 M(1.0f);
     M = translate(M, m_position);
 
@@ -101,17 +106,24 @@ void Beacon::draw(GLuint modelMatrixLocation, GLuint timeLocation) const {
 
     // Pass animation time to shader for surface patterns
     if (timeLocation != (GLuint)-1) {
-        glUniform1f(timeLocation, m_animationTime);
+        glUniform1f(timeLocation, animationTime);
     }
 
+    if (!m_mesh) return;
+
     m_mesh->bind();
     m_mesh->draw();
 }
 
-vec3 Beacon::generateRandomBeaconPosition(float terrainSize, float maxHeight, const vec3& housePosition) {
+vec3 Beacon::generateRandomBeaconPosition(const Heightfield& terrain, const vec3& housePosition, unsigned int seed) {
+    float terrainSize = terrain.getSize();
+
     // Use random device for better randomness
     static std::random_device rd;
-    static std::mt19937 gen(rd());
+    static std::mt19937 randomGen(rd());
+    // fixed seed -> reproducible runs (headless / benchmarks)
+    std::mt19937 seededGen(seed);
+    std::mt19937& gen = (seed != 0) ? seededGen : randomGen;
 
     // Tepui centers from terrain.cpp
     float leftPlateauCenter = -0.30f * terrainSize;
@@ -160,22 +172,10 @@ vec3 Beacon::generateRandomBeaconPosition(float terrainSize, float maxHeight, co
         z = zDist(gen);
 
         // Get the terrain height at this position
-        terrainHeight = Terrain::sampleHeight(x, z, terrainSize, maxHeight);
-
-        // Calculate slope by sampling nearby points
-        const float sampleDist = 0.5f;  // Distance to sample for gradient calculation
-
-        float heightX1 = Terrain::sampleHeight(x - sampleDist, z, terrainSize, maxHeight);
-        float heightX2 = Terrain::sampleHeight(x + sampleDist, z, terrainSize, maxHeight);
-        float heightZ1 = Terrain::sampleHeight(x, z - sampleDist, terrainSize, maxHeight);
-        float heightZ2 = Terrain::sampleHeight(x, z + sampleDist, terrainSize, maxHeight);
-
-        // Calculate gradients
-        float gradientX = (heightX2 - heightX1) / (2.0f * sampleDist);
-        float gradientZ = (heightZ2 - heightZ1) / (2.0f * sampleDist);
+        terrainHeight = terrain.height(x, z);
 
-        // Calculate slope magnitude (tan of the angle)
-        float slope = sqrt(gradientX * gradientX + gradientZ * gradientZ);
+        // slope magnitude (tan of the angle)
+        float slope = terrain.slope(x, z);
 
         // Check if slope is acceptable
         if (slope < MAX_SLOPE) {
@@ -4,13 +4,19 @@
 #include <GL/glew.h>
 #include <common/model.h>
 
+class Heightfield;
+
 class Beacon {
 public:
     Beacon(const glm::vec3& position, float radius = 5.0f, float height = 20.0f);
     ~Beacon();
 
-    // Rendering
-    void draw(GLuint modelMatrixLocation, GLuint timeLocation) const;
+    // builds the cylinder mesh (needs a GL context, headless runs skip it)
+    void createMesh();
+
+    // Rendering, animationTime is getAnimationTime() of the simulated beacon
+    // (the renderer draws from a snapshot while the simulation runs on)
+    void draw(GLuint modelMatrixLocation, GLuint timeLocation, float animationTime) const;
     void update(float dt);
 
     // Getters
@@ -20,7 +26,8 @@ public:
     float getAnimationTime() const { return m_animationTime; }
 
     // Generate a random position on the right tepui (opposite from house)
-    static glm::vec3 generateRandomBeaconPosition(float terrainSize, float maxHeight, const glm::vec3& housePosition);
+    // seed = 0 picks a different position every run
+    static glm::vec3 generateRandomBeaconPosition(const Heightfield& terrain, const glm::vec3& housePosition, unsigned int seed = 0);
 
 private:
     void generateCylinderMesh(int radialSegments, int heightSegments);
@@ -0,0 +1,610 @@
+// Microbenchmarks of the mesh generation, loaders and physics kernels, with
+// fixed inputs (fixed seeds, generated geometry) so runs compare between
+// builds. Every benchmark runs once to warm up, then at least --min-runs
+// times and until --min-time seconds are spent; the per-run times give
+// min / median / mean / stddev. Results go to a JSON file, a table to stdout.
+//
+// The GL half of River::createFloodedCanyon is left out: the mesh data of
+// the terrain and the river (buildGrid / buildFloodedCanyon) is what is
+// measured, so no window is needed.
+//
+// usage: bench [--out file.json] [--filter text] [--min-time s]
+//              [--min-runs n] [--quick] [--list]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <balloons/balloonMesh.h>
+#include <balloons/ropeWorld.h>
+#include <common/model.h>
+#include <particles/particleSystem.h>
+#include <physics/collision.h>
+#include <terrain/heightfield.h>
+#include <terrain/river.h>
+#include <terrain/terrain.h>
+
+using namespace glm;
+using namespace std;
+
+#ifndef ASSET_DIR
+#define ASSET_DIR "../assets"
+#endif
+
+// same scene as the game, see World
+static const float TERRAIN_SIZE = 100.0f;
+static const float TERRAIN_MAX_HEIGHT = 15.0f;
+static const int TERRAIN_RESOLUTION = 400;
+static const float WATER_LEVEL = -2.0f;
+
+static const unsigned int SEED = 1234;
+
+struct Options {
+    string outPath = "bench.json";
+    string filter;
+    double minTime = 0.25;
+    int minRuns = 5;
+    int maxRuns = 1000;
+    bool list = false;
+};
+
+struct Benchmark {
+    string name;
+    string group;
+    long long items;            // work per run (triangles, pairs, points...)
+    string itemName;
+    function<void()> setup;     // before every run, not timed
+    function<void()> run;
+};
+
+struct Result {
+    string name;
+    string group;
+    long long items;
+    string itemName;
+    int runs;
+    double minMs, medianMs, meanMs, stddevMs;
+};
+
+static double seconds() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static Result measure(const Benchmark& bench, const Options& options) {
+    // warm-up, also fills the caches and grows the output vectors
+    if (bench.setup) bench.setup();
+    bench.run();
+
+    vector<double> times;
+    double total = 0.0;
+    while ((int)times.size() < options.minRuns ||
+        (total < options.minTime && (int)times.size() < options.maxRuns)) {
+        if (bench.setup) bench.setup();
+        double t = seconds();
+        bench.run();
+        double elapsed = seconds() - t;
+        times.push_back(elapsed * 1e3);
+        total += elapsed;
+    }
+
+    Result result;
+    result.name = bench.name;
+    result.group = bench.group;
+    result.items = bench.items;
+    result.itemName = bench.itemName;
+    result.runs = (int)times.size();
+
+    sort(times.begin(), times.end());
+    size_t n = times.size();
+    result.minMs = times[0];
+    result.medianMs = n % 2 ? times[n / 2] : 0.5 * (times[n / 2 - 1] + times[n / 2]);
+    double sum = 0.0;
+    for (double t : times) sum += t;
+    result.meanMs = sum / n;
+    double variance = 0.0;
+    for (double t : times) variance += (t - result.meanMs) * (t - result.meanMs);
+    result.stddevMs = n > 1 ? sqrt(variance / (n - 1)) : 0.0;
+    return result;
+}
+
+// --- inputs -----------------------------------------------------------------
+
+struct Soup {
+    vector<vec3> vertices, normals;
+    vector<vec2> uvs;
+};
+
+// unindexed uv sphere, 6 vertices per quad
+static Soup sphereSoup(int rings, int sectors) {
+    Soup soup;
+    auto point = [&](int r, int s) {
+        float theta = 3.14159265f * r / rings;
+        float phi = 2.0f * 3.14159265f * s / sectors;
+        vec3 n(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+        soup.vertices.push_back(n);
+        soup.normals.push_back(n);
+        soup.uvs.push_back(vec2((float)s / sectors, (float)r / rings));
+    };
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < sectors; ++s) {
+            point(r, s); point(r + 1, s); point(r + 1, s + 1);
+            point(r, s); point(r + 1, s + 1); point(r, s + 1);
+        }
+    }
+    return soup;
+}
+
+// indexed uv sphere as an .obj (v / vt / vn triangles, what loadOBJ reads)
+static bool writeSphereOBJ(const string& path, int rings, int sectors) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) return false;
+    for (int r = 0; r <= rings; ++r) {
+        for (int s = 0; s <= sectors; ++s) {
+            float theta = 3.14159265f * r / rings;
+            float phi = 2.0f * 3.14159265f * s / sectors;
+            vec3 n(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+            fprintf(file, "v %f %f %f\nvt %f %f\nvn %f %f %f\n", n.x, n.y, n.z,
+                (float)s / sectors, (float)r / rings, n.x, n.y, n.z);
+        }
+    }
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < sectors; ++s) {
+            int a = r * (sectors + 1) + s + 1, b = a + sectors + 1;
+            fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, b + 1, b + 1, b + 1);
+            fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b + 1, b + 1, b + 1, a + 1, a + 1, a + 1);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+// the same sphere as an ascii VTK PolyData file (what loadVTP reads)
+static bool writeSphereVTP(const string& path, int rings, int sectors) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) return false;
+    int points = (rings + 1) * (sectors + 1);
+    int polys = 2 * rings * sectors;
+    vector<vec3> positions;
+    for (int r = 0; r <= rings; ++r) {
+        for (int s = 0; s <= sectors; ++s) {
+            float theta = 3.14159265f * r / rings;
+            float phi = 2.0f * 3.14159265f * s / sectors;
+            positions.push_back(vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi)));
+        }
+    }
+
+    fprintf(file, "<?xml version=\"1.0\"?>\n"
+        "<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n"
+        "<PolyData>\n<Piece NumberOfPoints=\"%d\" NumberOfPolys=\"%d\">\n", points, polys);
+    fprintf(file, "<PointData Normals=\"Normals\">\n"
+        "<DataArray type=\"Float32\" Name=\"Normals\" NumberOfComponents=\"3\" format=\"ascii\">\n");
+    for (const vec3& p : positions) fprintf(file, "%f %f %f\n", p.x, p.y, p.z);
+    fprintf(file, "</DataArray>\n</PointData>\n<Points>\n"
+        "<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"ascii\">\n");
+    for (const vec3& p : positions) fprintf(file, "%f %f %f\n", p.x, p.y, p.z);
+    fprintf(file, "</DataArray>\n</Points>\n<Polys>\n"
+        "<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n");
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < sectors; ++s) {
+            int a = r * (sectors + 1) + s, b = a + sectors + 1;
+            fprintf(file, "%d %d %d\n%d %d %d\n", a, b, b + 1, a, b + 1, a + 1);
+        }
+    }
+    fprintf(file, "</DataArray>\n<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n");
+    for (int p = 1; p <= polys; ++p) fprintf(file, "%d\n", 3 * p);
+    fprintf(file, "</DataArray>\n</Polys>\n</Piece>\n</PolyData>\n</VTKFile>\n");
+    fclose(file);
+    return true;
+}
+
+static bool fileExists(const string& path) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) return false;
+    fclose(file);
+    return true;
+}
+
+static string fileName(const string& path) {
+    return path.substr(path.find_last_of("/\\") + 1);
+}
+
+// loadOBJ reports every file on cout
+class SilenceCout {
+public:
+    SilenceCout() : m_buffer(cout.rdbuf(m_null.rdbuf())) {}
+    ~SilenceCout() { cout.rdbuf(m_buffer); }
+
+private:
+    ostringstream m_null;
+    streambuf* m_buffer;
+};
+
+// --- benchmarks -------------------------------------------------------------
+
+static void addGeometry(vector<Benchmark>& benches, const Heightfield& field) {
+    static const int TERRAIN_RESOLUTIONS[] = {100, 200, 400};
+    for (int res : TERRAIN_RESOLUTIONS) {
+        auto grid = make_shared<TerrainGrid>();
+        Benchmark b;
+        b.name = "terrain/generate/" + to_string(res);
+        b.group = "geometry";
+        b.items = 2LL * res * res;
+        b.itemName = "triangles";
+        b.run = [&field, res, grid] { Terrain::buildGrid(field, res, *grid); };
+        benches.push_back(b);
+    }
+
+    {
+        auto soup = make_shared<Soup>();
+        // the game's river resolution
+        const int res = 200;
+        Benchmark b;
+        b.name = "river/createFloodedCanyon/" + to_string(res);
+        b.group = "geometry";
+        River::buildFloodedCanyon(field, res, WATER_LEVEL, soup->vertices, soup->uvs,
+            soup->normals);
+        b.items = (long long)soup->vertices.size() / 3;
+        b.itemName = "triangles";
+        b.run = [&field, soup, res] {
+            soup->vertices.clear(); soup->uvs.clear(); soup->normals.clear();
+            River::buildFloodedCanyon(field, res, WATER_LEVEL, soup->vertices, soup->uvs,
+                soup->normals);
+        };
+        benches.push_back(b);
+    }
+
+    static const int BALLOON_SEGMENTS[] = {64, 128};
+    for (int segments : BALLOON_SEGMENTS) {
+        BalloonMesh mesh(segments, segments);
+        long long triangles = 0;
+        for (int l = 0; l < mesh.levelCount(); ++l) triangles += mesh.level(l).triangleCount();
+
+        Benchmark b;
+        b.name = "balloonMesh/" + to_string(segments);
+        b.group = "geometry";
+        b.items = triangles;
+        b.itemName = "triangles";
+        b.run = [segments] {
+            BalloonMesh mesh(segments, segments);
+            if (mesh.levelCount() == 0) abort();
+        };
+        benches.push_back(b);
+    }
+
+    for (int optimize = 0; optimize <= 1; ++optimize) {
+        auto soup = make_shared<Soup>(sphereSoup(128, 256));
+        auto out = make_shared<Soup>();
+        auto indices = make_shared<vector<unsigned int> >();
+        Benchmark b;
+        b.name = string("indexVBO/sphere/") + (optimize ? "optimized" : "plain");
+        b.group = "geometry";
+        b.items = (long long)soup->vertices.size();
+        b.itemName = "vertices";
+        b.run = [soup, out, indices, optimize] {
+            indices->clear();
+            out->vertices.clear(); out->uvs.clear(); out->normals.clear();
+            indexVBO(soup->vertices, soup->uvs, soup->normals, *indices, out->vertices,
+                out->uvs, out->normals, optimize != 0);
+        };
+        benches.push_back(b);
+    }
+}
+
+typedef void (*Loader)(const string&, vector<vec3>&, vector<vec2>&, vector<vec3>&,
+    vector<unsigned int>&);
+
+static void addLoader(vector<Benchmark>& benches, const string& loaderName, Loader loader,
+    const string& path) {
+    auto mesh = make_shared<Soup>();
+    auto indices = make_shared<vector<unsigned int> >();
+    try {
+        SilenceCout silence;
+        loader(path, mesh->vertices, mesh->uvs, mesh->normals, *indices);
+    }
+    catch (exception& ex) {
+        printf("skipped %s on %s: %s\n", loaderName.c_str(), path.c_str(), ex.what());
+        return;
+    }
+
+    Benchmark b;
+    b.name = loaderName + "/" + fileName(path);
+    b.group = "loaders";
+    b.items = (long long)mesh->vertices.size() / 3;
+    b.itemName = "triangles";
+    b.run = [loader, path, mesh, indices] {
+        SilenceCout silence;
+        mesh->vertices.clear(); mesh->uvs.clear(); mesh->normals.clear();
+        loader(path, mesh->vertices, mesh->uvs, mesh->normals, *indices);
+    };
+    benches.push_back(b);
+}
+
+static void addLoaders(vector<Benchmark>& benches, vector<string>& generatedFiles) {
+    // the bundled models where present
+    vector<string> objs;
+    static const char* MODELS[] = {"models/houseUP.obj", "models/cactus.obj",
+        "models/banana.obj", "bird_anim/bird01.obj"};
+    for (const char* model : MODELS) {
+        string path = string(ASSET_DIR) + "/" + model;
+        if (fileExists(path)) objs.push_back(path);
+    }
+
+    // and a generated sphere in every format, so every loader runs on the
+    // same geometry whatever is checked out
+    string obj = "bench_sphere.obj", vtp = "bench_sphere.vtp";
+    if (writeSphereOBJ(obj, 128, 256)) {
+        objs.push_back(obj);
+        generatedFiles.push_back(obj);
+    }
+    for (const string& path : objs) {
+        addLoader(benches, "loadOBJ", loadOBJ, path);
+        addLoader(benches, "loadOBJWithTiny", loadOBJWithTiny, path);
+    }
+    if (writeSphereVTP(vtp, 128, 256)) {
+        generatedFiles.push_back(vtp);
+        addLoader(benches, "loadVTP", loadVTP, vtp);
+    }
+}
+
+static void addPhysics(vector<Benchmark>& benches) {
+    mt19937 random(SEED);
+    uniform_real_distribution<float> position(-20.0f, 20.0f);
+    uniform_real_distribution<float> radius(0.5f, 1.5f);
+    uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    // broad spread of spheres, about one pair in ten touches
+    {
+        const int PAIRS = 100000;
+        auto spheres = make_shared<vector<Sphere> >(2 * PAIRS);
+        for (Sphere& s : *spheres) {
+            s.x = vec3(position(random), position(random), position(random)) * 0.1f;
+            s.r = radius(random);
+        }
+        auto hits = make_shared<int>(0);
+        Benchmark b;
+        b.name = "collision/checkSphereSphere";
+        b.group = "physics";
+        b.items = PAIRS;
+        b.itemName = "pairs";
+        b.run = [spheres, hits] {
+            int count = 0;
+            const vector<Sphere>& s = *spheres;
+            for (size_t i = 0; i < s.size(); i += 2) {
+                count += checkSphereSphereCollision(s[i], s[i + 1]) ? 1 : 0;
+            }
+            *hits = count;
+        };
+        benches.push_back(b);
+    }
+
+    // balloon pairs (body and lower sphere) that all overlap, resolved from
+    // the same state every run
+    {
+        const int PAIRS = 20000;
+        struct DualPair {
+            Sphere main1, lower1, main2, lower2;
+            vec3 vel1, vel2;
+        };
+        auto initial = make_shared<vector<DualPair> >(PAIRS);
+        auto pairs = make_shared<vector<DualPair> >();
+        for (DualPair& p : *initial) {
+            vec3 at(position(random), position(random), position(random));
+            vec3 offset = normalize(vec3(unit(random), unit(random), unit(random)) + vec3(0.01f));
+            p.main1.x = at;
+            p.main1.r = 1.0f;
+            p.lower1.x = at - vec3(0.0f, 1.0f, 0.0f);
+            p.lower1.r = 0.6f;
+            p.main2.x = at + offset * 1.5f;
+            p.main2.r = 1.0f;
+            p.lower2.x = p.main2.x - vec3(0.0f, 1.0f, 0.0f);
+            p.lower2.r = 0.6f;
+            p.vel1 = vec3(unit(random), unit(random), unit(random));
+            p.vel2 = vec3(unit(random), unit(random), unit(random));
+        }
+        Benchmark b;
+        b.name = "collision/handleDualSphere";
+        b.group = "physics";
+        b.items = PAIRS;
+        b.itemName = "pairs";
+        b.setup = [initial, pairs] { *pairs = *initial; };
+        b.run = [pairs] {
+            for (DualPair& p : *pairs) {
+                handleDualSphereCollision(p.main1, p.lower1, p.main2, p.lower2, p.vel1,
+                    p.vel2, 1.0f, 1.0f);
+            }
+        };
+        benches.push_back(b);
+    }
+
+    // verlet ropes of popped balloons: 20 segments each, hanging off a box,
+    // back in their first pose before every run
+    static const int ROPE_COUNTS[] = {100, 1000};
+    for (int ropes : ROPE_COUNTS) {
+        auto initial = make_shared<RopeWorld>();
+        initial->reserve(ropes, ropes * 21);
+        for (int r = 0; r < ropes; ++r) {
+            vec3 start(position(random), 10.0f + radius(random), position(random));
+            initial->addRope(start, start + vec3(unit(random), -4.0f, unit(random)), 20);
+        }
+        initial->setCollisionBox(vec3(-5.0f, 0.0f, -5.0f), vec3(5.0f, 6.0f, 5.0f));
+        auto world = make_shared<RopeWorld>(*initial);
+        Benchmark b;
+        b.name = "ropeWorld/update/" + to_string(ropes);
+        b.group = "physics";
+        b.items = initial->pointCount();
+        b.itemName = "points";
+        b.setup = [initial, world] { *world = *initial; };
+        b.run = [world] { world->update(1.0f / 120.0f); };
+        benches.push_back(b);
+    }
+
+    // sparks that never die, emitted again before every run so every run
+    // moves the same particles from the same place
+    static const int PARTICLE_COUNTS[] = {10000, 100000};
+    for (int count : PARTICLE_COUNTS) {
+        auto positions = make_shared<vector<vec3> >(count);
+        auto velocities = make_shared<vector<vec3> >(count);
+        for (int i = 0; i < count; ++i) {
+            (*positions)[i] = vec3(position(random), 10.0f, position(random));
+            (*velocities)[i] = vec3(unit(random), unit(random) * 5.0f, unit(random));
+        }
+        auto particles = make_shared<ParticleSystem>(count);
+        Benchmark b;
+        b.name = "particleSystem/update/" + to_string(count);
+        b.group = "physics";
+        b.items = count;
+        b.itemName = "particles";
+        b.setup = [particles, positions, velocities] {
+            particles->clear();
+            for (size_t i = 0; i < positions->size(); ++i) {
+                particles->emit((*positions)[i], (*velocities)[i], vec3(1.0f), 0.0f, 0.1f);
+            }
+        };
+        b.run = [particles] { particles->update(1.0f / 120.0f); };
+        benches.push_back(b);
+    }
+}
+
+// --- output -----------------------------------------------------------------
+
+static void writeJsonString(FILE* file, const string& s) {
+    fputc('"', file);
+    for (char c : s) {
+        if (c == '"' || c == '\\') fputc('\\', file);
+        if ((unsigned char)c >= 0x20) fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+static bool writeJson(const string& path, const vector<Result>& results, const Options& options) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) return false;
+
+#if defined(__clang__)
+    const char* compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    const char* compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    string msvc = "msvc " + to_string(_MSC_VER);
+    const char* compiler = msvc.c_str();
+#else
+    const char* compiler = "unknown";
+#endif
+#ifdef NDEBUG
+    bool optimized = true;
+#else
+    bool optimized = false;
+#endif
+
+    fprintf(file, "{\n  \"schema\": 1,\n  \"context\": {\n    \"compiler\": ");
+    writeJsonString(file, compiler);
+    fprintf(file, ",\n    \"ndebug\": %s,\n    \"simd\": ", optimized ? "true" : "false");
+    writeJsonString(file, Terrain::simdPath());
+    fprintf(file, ",\n    \"hardware_threads\": %u,\n    \"min_time_s\": %g,\n"
+        "    \"min_runs\": %d\n  },\n  \"benchmarks\": [", thread::hardware_concurrency(),
+        options.minTime, options.minRuns);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        double perSecond = r.medianMs > 0.0 ? r.items / (r.medianMs * 1e-3) : 0.0;
+        fprintf(file, "%s\n    {\"name\": ", i ? "," : "");
+        writeJsonString(file, r.name);
+        fprintf(file, ", \"group\": ");
+        writeJsonString(file, r.group);
+        fprintf(file, ", \"runs\": %d, \"min_ms\": %.6f, \"median_ms\": %.6f, "
+            "\"mean_ms\": %.6f, \"stddev_ms\": %.6f, \"items\": %lld, \"item\": ",
+            r.runs, r.minMs, r.medianMs, r.meanMs, r.stddevMs, r.items);
+        writeJsonString(file, r.itemName);
+        fprintf(file, ", \"items_per_second\": %.1f}", perSecond);
+    }
+    fprintf(file, "\n  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+static bool parseArguments(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--out" && hasValue) {
+            options.outPath = argv[++i];
+        }
+        else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        }
+        else if (arg == "--min-time" && hasValue) {
+            options.minTime = atof(argv[++i]);
+        }
+        else if (arg == "--min-runs" && hasValue) {
+            options.minRuns = std::max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--quick") {
+            // smoke test: every benchmark once
+            options.minTime = 0.0;
+            options.minRuns = 1;
+        }
+        else if (arg == "--list") {
+            options.list = true;
+        }
+        else {
+            printf("Unknown argument: %s\n", arg.c_str());
+            printf("usage: %s [--out file.json] [--filter text] [--min-time s] "
+                "[--min-runs n] [--quick] [--list]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        return 1;
+    }
+
+    Heightfield field(TERRAIN_SIZE, TERRAIN_RESOLUTION, TERRAIN_MAX_HEIGHT);
+
+    vector<Benchmark> benches;
+    vector<string> generatedFiles;
+    addGeometry(benches, field);
+    addLoaders(benches, generatedFiles);
+    addPhysics(benches);
+
+    vector<Result> results;
+    if (!options.list) {
+        printf("%-36s %6s %11s %11s %9s %14s\n", "benchmark", "runs", "median ms", "min ms",
+            "stddev", "items/s");
+    }
+    for (const Benchmark& bench : benches) {
+        if (bench.name.find(options.filter) == string::npos) continue;
+        if (options.list) {
+            printf("%s\n", bench.name.c_str());
+            continue;
+        }
+        Result r = measure(bench, options);
+        results.push_back(r);
+        printf("%-36s %6d %11.4f %11.4f %8.1f%% %14.4g\n", r.name.c_str(), r.runs,
+            r.medianMs, r.minMs, r.meanMs > 0.0 ? 100.0 * r.stddevMs / r.meanMs : 0.0,
+            r.medianMs > 0.0 ? r.items / (r.medianMs * 1e-3) : 0.0);
+    }
+
+    for (const string& path : generatedFiles) {
+        remove(path.c_str());
+    }
+
+    if (options.list) return 0;
+    if (!writeJson(options.outPath, results, options)) {
+        printf("Cannot write %s\n", options.outPath.c_str());
+        return 1;
+    }
+    printf("%zu results written to %s\n", results.size(), options.outPath.c_str());
+    return 0;
+}
@@ -0,0 +1,166 @@
+// indexVBO before (std::map dedupe) and after (hash dedupe, vertex cache and
+// fetch reordering) on the OBJ assets: load time and vertex shader runs per
+// triangle (ACMR of a 16 / 32 entry FIFO cache).
+// usage: mesh_index_bench [file.obj ...] (default: the game's models)
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <common/model.h>
+#include <common/meshOptimizer.h>
+
+using namespace glm;
+using namespace std;
+
+#ifndef ASSET_DIR
+#define ASSET_DIR "../assets"
+#endif
+
+static const int REPEAT = 5;
+
+static double seconds() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// the indexVBO this replaces
+struct LegacyVertex {
+    vec3 position;
+    vec2 uv;
+    vec3 normal;
+    bool operator<(const LegacyVertex that) const {
+        return memcmp((void*) this, (void*) &that, sizeof(LegacyVertex)) > 0;
+    };
+};
+
+static void legacyIndexVBO(const vector<vec3>& in_vertices, const vector<vec2>& in_uvs,
+    const vector<vec3>& in_normals, vector<unsigned int>& out_indices,
+    vector<vec3>& out_vertices, vector<vec2>& out_uvs, vector<vec3>& out_normals) {
+    map<LegacyVertex, unsigned int> vertexToOutIndex;
+    for (size_t i = 0; i < in_vertices.size(); i++) {
+        LegacyVertex packed = {in_vertices[i],
+            in_uvs.size() != 0 ? in_uvs[i] : vec2(0.0f),
+            in_normals.size() != 0 ? in_normals[i] : vec3(0.0f)};
+        map<LegacyVertex, unsigned int>::iterator it = vertexToOutIndex.find(packed);
+        if (it != vertexToOutIndex.end()) {
+            out_indices.push_back(it->second);
+        } else {
+            out_vertices.push_back(packed.position);
+            if (in_uvs.size() != 0) out_uvs.push_back(packed.uv);
+            if (in_normals.size() != 0) out_normals.push_back(packed.normal);
+            unsigned int index = (unsigned int) out_vertices.size() - 1;
+            out_indices.push_back(index);
+            vertexToOutIndex[packed] = index;
+        }
+    }
+}
+
+struct Soup {
+    string name;
+    vector<vec3> vertices, normals;
+    vector<vec2> uvs;
+};
+
+// unindexed uv sphere, when no model is found
+static Soup sphereSoup(int rings, int sectors) {
+    Soup soup;
+    soup.name = "generated sphere";
+    auto point = [&](int r, int s) {
+        float theta = 3.14159265f * r / rings;
+        float phi = 2.0f * 3.14159265f * s / sectors;
+        vec3 n(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+        soup.vertices.push_back(n);
+        soup.normals.push_back(n);
+        soup.uvs.push_back(vec2((float)s / sectors, (float)r / rings));
+    };
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < sectors; ++s) {
+            point(r, s); point(r + 1, s); point(r + 1, s + 1);
+            point(r, s); point(r + 1, s + 1); point(r, s + 1);
+        }
+    }
+    return soup;
+}
+
+struct Result {
+    double milliseconds;
+    size_t vertexCount;
+    float acmr16, acmr32;
+};
+
+template<class F>
+static Result measure(const Soup& soup, F index) {
+    Result result = {1e30, 0, 0.0f, 0.0f};
+    vector<unsigned int> indices;
+    vector<vec3> vertices, normals;
+    vector<vec2> uvs;
+    for (int r = 0; r < REPEAT; ++r) {
+        indices.clear(); vertices.clear(); normals.clear(); uvs.clear();
+        double t = seconds();
+        index(soup, indices, vertices, uvs, normals);
+        result.milliseconds = std::min(result.milliseconds, (seconds() - t) * 1e3);
+    }
+    result.vertexCount = vertices.size();
+    result.acmr16 = averageCacheMissRatio(indices, vertices.size(), 16);
+    result.acmr32 = averageCacheMissRatio(indices, vertices.size(), 32);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    vector<string> paths;
+    for (int i = 1; i < argc; ++i) {
+        paths.push_back(argv[i]);
+    }
+    if (paths.empty()) {
+        paths.push_back(ASSET_DIR "/models/houseUP.obj");
+        paths.push_back(ASSET_DIR "/models/cactus.obj");
+        paths.push_back(ASSET_DIR "/models/banana.obj");
+        char path[256];
+        for (int i = 1; i <= 21; ++i) {
+            sprintf(path, ASSET_DIR "/bird_anim/bird%02d.obj", i);
+            paths.push_back(path);
+        }
+    }
+
+    vector<Soup> soups;
+    for (const string& path : paths) {
+        Soup soup;
+        soup.name = path.substr(path.find_last_of("/\\") + 1);
+        try {
+            vector<unsigned int> ignored;
+            loadOBJWithTiny(path, soup.vertices, soup.uvs, soup.normals, ignored);
+            soups.push_back(soup);
+        }
+        catch (exception&) {
+            printf("skipped %s (not found)\n", path.c_str());
+        }
+    }
+    if (soups.empty()) {
+        soups.push_back(sphereSoup(128, 256));
+    }
+
+    printf("%-20s %9s %9s | %9s %8s %8s | %9s %8s %8s\n", "mesh", "triangles",
+        "vertices", "map ms", "acmr16", "acmr32", "hash+opt", "acmr16", "acmr32");
+    double before = 0.0, after = 0.0;
+    for (const Soup& soup : soups) {
+        Result legacy = measure(soup, [](const Soup& s, vector<unsigned int>& i,
+            vector<vec3>& v, vector<vec2>& u, vector<vec3>& n) {
+            legacyIndexVBO(s.vertices, s.uvs, s.normals, i, v, u, n);
+        });
+        Result hashed = measure(soup, [](const Soup& s, vector<unsigned int>& i,
+            vector<vec3>& v, vector<vec2>& u, vector<vec3>& n) {
+            indexVBO(s.vertices, s.uvs, s.normals, i, v, u, n);
+        });
+        before += legacy.milliseconds;
+        after += hashed.milliseconds;
+        printf("%-20s %9zu %9zu | %9.2f %8.3f %8.3f | %9.2f %8.3f %8.3f\n",
+            soup.name.c_str(), soup.vertices.size() / 3, hashed.vertexCount,
+            legacy.milliseconds, legacy.acmr16, legacy.acmr32,
+            hashed.milliseconds, hashed.acmr16, hashed.acmr32);
+    }
+    printf("total indexing: %.2f ms -> %.2f ms\n", before, after);
+    return 0;
+}
@@ -0,0 +1,53 @@
+// Terrain::sampleHeight one point at a time against Terrain::sampleHeights,
+// in ns per height on a 1025 x 1025 grid (a heightfield bake).
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <terrain/terrain.h>
+
+using namespace std;
+
+static const float SIZE = 100.0f;
+static const float MAX_HEIGHT = 15.0f;
+static const int SIDE = 1025;
+static const int REPEAT = 5;
+
+static double seconds() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main() {
+    vector<float> x, z;
+    for (int j = 0; j < SIDE; ++j) {
+        for (int i = 0; i < SIDE; ++i) {
+            x.push_back(SIZE * ((float)i / (SIDE - 1) - 0.5f));
+            z.push_back(SIZE * ((float)j / (SIDE - 1) - 0.5f));
+        }
+    }
+    size_t n = x.size();
+    vector<float> out(n);
+
+    // best of a few runs
+    double scalar = 1e30, batch = 1e30;
+    float sum = 0.0f;
+    for (int r = 0; r < REPEAT; ++r) {
+        double t = seconds();
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = Terrain::sampleHeight(x[i], z[i], SIZE, MAX_HEIGHT);
+        }
+        scalar = std::min(scalar, seconds() - t);
+        sum += out[n / 2];
+
+        t = seconds();
+        Terrain::sampleHeights(x.data(), z.data(), out.data(), n, SIZE, MAX_HEIGHT);
+        batch = std::min(batch, seconds() - t);
+        sum += out[n / 2];
+    }
+
+    printf("%zu heights, path %s (checksum %g)\n", n, Terrain::simdPath(), sum);
+    printf("scalar sampleHeight:  %6.2f ns/height\n", scalar * 1e9 / n);
+    printf("batch sampleHeights:  %6.2f ns/height (x%.1f)\n", batch * 1e9 / n, scalar / batch);
+    return 0;
+}
@@ -0,0 +1,226 @@
+#include "assetLoader.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <SOIL.h>
+#include "model.h"
+
+using namespace std;
+
+// loadSOIL()
+static const unsigned int TEXTURE_FLAGS = SOIL_FLAG_TEXTURE_REPEATS | SOIL_FLAG_POWER_OF_TWO;
+
+AssetLoader::AssetLoader(MeshCache& cache, int workerCount, int maxReady)
+    : m_cache(cache), m_maxReady(max(1, maxReady)), m_pending(0), m_loading(0),
+    m_quit(false) {
+    workerCount = max(1, workerCount);
+    for (int i = 0; i < workerCount; ++i) {
+        m_workers.push_back(thread(&AssetLoader::workerLoop, this));
+    }
+}
+
+AssetLoader::~AssetLoader() {
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_quit = true;
+        for (Job* job : m_requests) {
+            destroy(job);
+        }
+        m_requests.clear();
+    }
+    m_wake.notify_all();
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        m_workers[i].join();
+    }
+
+    // the placeholders stay with their owners
+    for (Job* job : m_ready) {
+        destroy(job);
+    }
+}
+
+AssetLoader::Job* AssetLoader::request(Type type, const string& path) {
+    Job* job = new Job();
+    job->type = type;
+    job->path = path;
+    job->texture = 0;
+    job->drawable = nullptr;
+    job->pixels = nullptr;
+    job->width = job->height = 0;
+    m_pending++;
+    return job;
+}
+
+void AssetLoader::submit(Job* job) {
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_requests.push_back(job);
+    }
+    m_wake.notify_one();
+}
+
+GLuint AssetLoader::loadTexture(const string& path) {
+    Job* job = request(TEXTURE, path);
+
+    // one grey texel until the image is there
+    static const unsigned char GREY[3] = {128, 128, 128};
+    glGenTextures(1, &job->texture);
+    glBindTexture(GL_TEXTURE_2D, job->texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, GREY);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    GLuint texture = job->texture;
+    submit(job);
+    return texture;
+}
+
+Drawable* AssetLoader::loadDrawable(const string& path) {
+    Job* job = request(MESH, path);
+    job->drawable = new Drawable();
+    Drawable* drawable = job->drawable;
+    submit(job);
+    return drawable;
+}
+
+Drawable* AssetLoader::generateDrawable(const string& key,
+    const MeshCache::SoupBuilder& build) {
+    Job* job = request(GENERATED_MESH, key);
+    job->build = build;
+    job->drawable = new Drawable();
+    Drawable* drawable = job->drawable;
+    submit(job);
+    return drawable;
+}
+
+void AssetLoader::run(const string& name, const function<void()>& load,
+    const function<void()>& upload) {
+    Job* job = request(TASK, name);
+    job->load = load;
+    job->upload = upload;
+    submit(job);
+}
+
+void AssetLoader::workerLoop() {
+    while (true) {
+        Job* job;
+        {
+            // only take a request while its blob has room in m_ready
+            unique_lock<mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] {
+                return m_quit || (!m_requests.empty() &&
+                    (int)m_ready.size() + m_loading < m_maxReady);
+            });
+            if (m_quit) return;
+            job = m_requests.front();
+            m_requests.pop_front();
+            m_loading++;
+        }
+
+        load(*job);
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_loading--;
+            m_ready.push_back(job);
+        }
+        m_loaded.notify_all();
+    }
+}
+
+// everything but GL
+void AssetLoader::load(Job& job) {
+    try {
+        switch (job.type) {
+        case TEXTURE: {
+            printf("Reading image: %s\n", job.path.c_str());
+            int channels;
+            job.pixels = SOIL_load_image(job.path.c_str(), &job.width, &job.height,
+                &channels, SOIL_LOAD_RGB);
+            if (!job.pixels) {
+                // SOIL keeps the reason in a global, good enough for a message
+                job.error = SOIL_last_result();
+            }
+            break;
+        }
+        case MESH:
+            m_cache.loadIndexed(job.path, job.mesh);
+            break;
+        case GENERATED_MESH:
+            m_cache.generateIndexed(job.path, job.build, job.mesh);
+            break;
+        case TASK:
+            job.load();
+            break;
+        }
+    }
+    catch (exception& e) {
+        job.error = e.what();
+    }
+}
+
+void AssetLoader::upload(Job& job) {
+    if (job.type == TEXTURE) {
+        if (job.pixels) {
+            SOIL_create_OGL_texture(job.pixels, job.width, job.height, SOIL_LOAD_RGB,
+                job.texture, TEXTURE_FLAGS);
+        }
+        else {
+            printf("SOIL loading error: %s (%s)\n", job.error.c_str(), job.path.c_str());
+        }
+    }
+    else if (!job.error.empty()) {
+        return;
+    }
+    else if (job.type == TASK) {
+        job.upload();
+    }
+    else {
+        job.mesh.upload(*job.drawable);
+    }
+}
+
+void AssetLoader::destroy(Job* job) {
+    if (job->pixels) {
+        SOIL_free_image_data(job->pixels);
+    }
+    delete job;
+}
+
+int AssetLoader::uploadReady(int maxUploads) {
+    int uploaded = 0;
+    while (uploaded < maxUploads) {
+        Job* job;
+        {
+            lock_guard<mutex> lock(m_mutex);
+            if (m_ready.empty()) break;
+            job = m_ready.front();
+            m_ready.pop_front();
+        }
+        // room for another blob
+        m_wake.notify_all();
+
+        upload(*job);
+        m_pending--;
+        uploaded++;
+
+        string error = job->type != TEXTURE ? job->error : string();
+        destroy(job);
+        if (!error.empty()) {
+            throw runtime_error(error);
+        }
+    }
+    return uploaded;
+}
+
+void AssetLoader::finish() {
+    while (m_pending > 0) {
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_loaded.wait(lock, [this] { return !m_ready.empty(); });
+        }
+        uploadReady(m_maxReady);
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <GL/glew.h>
+
+#include "meshCache.h"
+
+class Drawable;
+
+/**
+* Loads textures and meshes in the background.
+*
+* Requests return right away with a placeholder: a texture name holding one
+* grey texel, or an empty Drawable that draws nothing. Worker threads read
+* the files, decode the images and parse / index the meshes (through the
+* MeshCache) into CPU side blobs; uploadReady(), called once per frame on
+* the GL thread, turns a few finished blobs into GL objects by filling the
+* placeholders in place, so every pointer / name handed out stays valid.
+*
+* At most maxReady finished blobs wait for their upload, a worker that gets
+* ahead of the GL thread blocks instead of piling up decoded images.
+* Requests, uploadReady(), finish() and the destructor run on the GL thread.
+*/
+class AssetLoader {
+public:
+    AssetLoader(MeshCache& cache, int workerCount = 2, int maxReady = 4);
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    /* image file read as RGB, same flags as loadSOIL() */
+    GLuint loadTexture(const std::string& path);
+    /* .obj / .vtp file, see MeshCache::loadIndexed() */
+    Drawable* loadDrawable(const std::string& path);
+    /* generated soup, see MeshCache::generateIndexed(); build runs on a worker */
+    Drawable* generateDrawable(const std::string& key, const MeshCache::SoupBuilder& build);
+    /**
+    * Anything else: load() runs on a worker, upload() later on the GL thread
+    * (e.g. a bake and its textures). name is for error messages.
+    */
+    void run(const std::string& name, const std::function<void()>& load,
+        const std::function<void()>& upload);
+
+    /**
+    * GL upload of at most maxUploads finished assets, returns how many.
+    * A mesh or task that failed to load throws (like
+    * MeshCache::loadDrawable()), a texture keeps its placeholder (like
+    * loadSOIL()).
+    */
+    int uploadReady(int maxUploads = 2);
+    /* uploads everything requested so far, blocks until done */
+    void finish();
+
+    /* requested and not uploaded yet */
+    int getPendingCount() const { return m_pending; }
+
+private:
+    enum Type { TEXTURE, MESH, GENERATED_MESH, TASK };
+
+    struct Job {
+        Type type;
+        std::string path;  // file, or the cache key of a generated mesh
+        MeshCache::SoupBuilder build;
+        std::function<void()> load, upload;  // TASK
+        GLuint texture;
+        Drawable* drawable;
+
+        // filled by a worker
+        unsigned char* pixels;
+        int width, height;
+        MeshCache::IndexedMesh mesh;
+        std::string error;
+    };
+
+    Job* request(Type type, const std::string& path);
+    void submit(Job* job);
+    void workerLoop();
+    void load(Job& job);
+    void upload(Job& job);
+    static void destroy(Job* job);
+
+    MeshCache& m_cache;
+    int m_maxReady;
+    int m_pending;  // GL thread
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;   // a request, or room in m_ready
+    std::condition_variable m_loaded; // a blob in m_ready
+    std::deque<Job*> m_requests;
+    std::deque<Job*> m_ready;
+    int m_loading;                    // jobs the workers are on
+    bool m_quit;
+    std::vector<std::thread> m_workers;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#include "frustum.h"
+
+using namespace glm;
+
+Frustum::Frustum() {
+    // everything passes until set() is called
+    for (int i = 0; i < 6; ++i) {
+        m_planes[i] = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+Frustum::Frustum(const mat4& viewProjection) {
+    set(viewProjection);
+}
+
+void Frustum::set(const mat4& viewProjection) {
+    // rows of the matrix (glm is column major)
+    vec4 row[4];
+    for (int r = 0; r < 4; ++r) {
+        row[r] = vec4(viewProjection[0][r], viewProjection[1][r],
+            viewProjection[2][r], viewProjection[3][r]);
+    }
+
+    m_planes[0] = row[3] + row[0]; // left
+    m_planes[1] = row[3] - row[0]; // right
+    m_planes[2] = row[3] + row[1]; // bottom
+    m_planes[3] = row[3] - row[1]; // top
+    m_planes[4] = row[3] + row[2]; // near
+    m_planes[5] = row[3] - row[2]; // far
+
+    for (int i = 0; i < 6; ++i) {
+        m_planes[i] /= length(vec3(m_planes[i]));
+    }
+}
+
+bool Frustum::intersects(const vec3& min, const vec3& max) const {
+    for (int i = 0; i < 6; ++i) {
+        const vec4& p = m_planes[i];
+        // corner of the box furthest along the plane normal
+        vec3 corner(p.x >= 0.0f ? max.x : min.x,
+            p.y >= 0.0f ? max.y : min.y,
+            p.z >= 0.0f ? max.z : min.z);
+        if (dot(vec3(p), corner) + p.w < 0.0f) return false;
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+/**
+* View frustum as six planes, extracted from a view-projection matrix.
+* http://www.cs.otago.ac.nz/postgrads/alexis/planeExtraction.pdf
+*
+* Planes point inwards; a box is rejected only when it lies entirely behind
+* one of them, so the test is conservative (some boxes outside a corner of
+* the frustum pass).
+*/
+class Frustum {
+public:
+    Frustum();
+    Frustum(const glm::mat4& viewProjection);
+
+    void set(const glm::mat4& viewProjection);
+
+    /* false when the axis aligned box [min, max] is surely outside */
+    bool intersects(const glm::vec3& min, const glm::vec3& max) const;
+
+private:
+    glm::vec4 m_planes[6]; // xyz normal, w distance
+};
+
+#endif
@@ -0,0 +1,93 @@
+#include "gpuTimer.h"
+
+#ifdef ENABLE_PROFILER
+
+#include <cstdio>
+
+using namespace std;
+
+// the two clocks drift apart a little, realign them every so often
+static const int CALIBRATE_EVERY = 256;
+
+GpuTimer::GpuTimer()
+    : m_frame(0), m_offset(0), m_sinceCalibration(0), m_dropped(0) {
+    for (Frame& frame : m_frames) {
+        frame.used = 0;
+    }
+    m_track = Profiler::get().addTrack("GPU");
+    calibrate();
+}
+
+GpuTimer::~GpuTimer() {
+    if (m_dropped > 0) {
+        printf("GPU timer: %d frames dropped, the GPU was more than %d frames behind\n",
+            m_dropped, FRAMES_IN_FLIGHT - 1);
+    }
+    for (Frame& frame : m_frames) {
+        for (Query& query : frame.queries) {
+            glDeleteQueries(1, &query.begin);
+            glDeleteQueries(1, &query.end);
+        }
+    }
+}
+
+void GpuTimer::calibrate() {
+    GLint64 gpuTime = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+    m_offset = Profiler::now() - (int64_t)gpuTime;
+    m_sinceCalibration = 0;
+}
+
+void GpuTimer::begin(const char* name) {
+    Frame& frame = m_frames[m_frame];
+    if (frame.used == frame.queries.size()) {
+        Query query;
+        glGenQueries(1, &query.begin);
+        glGenQueries(1, &query.end);
+        frame.queries.push_back(query);
+    }
+    Query& query = frame.queries[frame.used];
+    query.name = name;
+    glQueryCounter(query.begin, GL_TIMESTAMP);
+    m_open.push_back(frame.used);
+    frame.used++;
+}
+
+void GpuTimer::end() {
+    if (m_open.empty()) return;
+    glQueryCounter(m_frames[m_frame].queries[m_open.back()].end, GL_TIMESTAMP);
+    m_open.pop_back();
+}
+
+void GpuTimer::endFrame() {
+    // the oldest frame in flight, recorded FRAMES_IN_FLIGHT - 1 frames ago
+    m_frame = (m_frame + 1) % FRAMES_IN_FLIGHT;
+    Frame& frame = m_frames[m_frame];
+
+    // normally long done; if not, drop the frame rather than wait for the GPU
+    GLuint available = GL_TRUE;
+    for (size_t i = 0; i < frame.used && available; ++i) {
+        glGetQueryObjectuiv(frame.queries[i].end, GL_QUERY_RESULT_AVAILABLE, &available);
+    }
+    if (!available) {
+        m_dropped++;
+        frame.used = 0;
+    }
+
+    Profiler& profiler = Profiler::get();
+    for (size_t i = 0; i < frame.used; ++i) {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(frame.queries[i].begin, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[i].end, GL_QUERY_RESULT, &end);
+        profiler.recordTrack(m_track, frame.queries[i].name,
+            (int64_t)begin + m_offset, (int64_t)end + m_offset);
+    }
+    frame.used = 0;
+    m_open.clear();
+
+    if (++m_sinceCalibration >= CALIBRATE_EVERY) {
+        calibrate();
+    }
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include "profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+#include <vector>
+#include <GL/glew.h>
+
+/**
+* GPU time of render passes, from GL timestamp queries around them.
+*
+* The results are read FRAMES_IN_FLIGHT frames later, when the GPU is done
+* with them, so timing never stalls the pipeline. They go to the Profiler on
+* a "GPU" track, moved onto the CPU clock so the trace shows both timelines
+* side by side. A frame still not done by then is dropped. Zones may nest.
+* Needs the GL context for its whole life.
+*/
+class GpuTimer {
+public:
+    GpuTimer();
+    ~GpuTimer();
+
+    void begin(const char* name);
+    void end();
+    /* after the frame's last pass; collects the frames that are done */
+    void endFrame();
+
+    class Zone {
+    public:
+        Zone(GpuTimer* timer, const char* name) : m_timer(timer) {
+            if (m_timer) m_timer->begin(name);
+        }
+        ~Zone() {
+            if (m_timer) m_timer->end();
+        }
+
+    private:
+        GpuTimer* m_timer;
+    };
+
+private:
+    struct Query {
+        const char* name;       // a literal, read frames later
+        GLuint begin, end;
+    };
+    struct Frame {
+        std::vector<Query> queries;
+        size_t used;
+    };
+
+    static const int FRAMES_IN_FLIGHT = 4;
+
+    void calibrate();
+
+    Frame m_frames[FRAMES_IN_FLIGHT];
+    int m_frame;                // being recorded
+    std::vector<size_t> m_open; // queries begun but not ended
+    int m_track;
+    int64_t m_offset;           // CPU clock minus GL clock, ns
+    int m_sinceCalibration;
+    int m_dropped;              // frames not ready in time
+};
+
+#define PROFILE_GPU_ZONE(timer, name) GpuTimer::Zone PROFILE_CONCAT(profileGpuZone, __LINE__)(timer, name)
+#define PROFILE_GPU_FRAME(timer) ((timer) ? (timer)->endFrame() : (void)0)
+
+#else
+
+#define PROFILE_GPU_ZONE(timer, name) ((void)0)
+#define PROFILE_GPU_FRAME(timer) ((void)0)
+
+#endif
+
+#endif
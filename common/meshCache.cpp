@@ -0,0 +1,349 @@
+#include "meshCache.h"
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "model.h"
+
+using namespace glm;
+using namespace std;
+
+static const char MAGIC[4] = {'U', 'P', 'M', 'C'};
+static const int MAX_ARRAYS = 16;
+
+struct FileHeader {
+    char magic[4];
+    unsigned int version;
+    unsigned int keyBytes;
+    unsigned int arrayCount;
+};
+
+static size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+// FNV-1a, names the entry files
+static unsigned long long hashKey(const string& key) {
+    unsigned long long h = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        h = (h ^ c) * 1099511628211ull;
+    }
+    return h;
+}
+
+/*****************************************************************************/
+
+MeshCache::Entry::Entry()
+    : m_base(nullptr), m_size(0), m_arrayCount(0), m_arrayBytes(nullptr),
+    m_arrays(nullptr)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr)
+#endif
+{
+}
+
+MeshCache::Entry::~Entry() {
+    unmap();
+}
+
+const void* MeshCache::Entry::data(int i) const {
+    const char* p = m_arrays;
+    for (int a = 0; a < i; ++a) {
+        p += align8((size_t)m_arrayBytes[a]);
+    }
+    return p;
+}
+
+size_t MeshCache::Entry::bytes(int i) const {
+    return (size_t)m_arrayBytes[i];
+}
+
+bool MeshCache::Entry::map(const string& path) {
+    unmap();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void* base = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!base) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_base = (char*)base;
+    m_size = (size_t)size.QuadPart;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps the file alive
+    close(fd);
+    if (base == MAP_FAILED) return false;
+    m_base = (char*)base;
+    m_size = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+void MeshCache::Entry::unmap() {
+    if (m_base) {
+#ifdef _WIN32
+        UnmapViewOfFile(m_base);
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+        m_mapping = nullptr;
+#else
+        munmap(m_base, m_size);
+#endif
+    }
+    m_base = nullptr;
+    m_size = 0;
+    m_arrayCount = 0;
+    m_arrayBytes = nullptr;
+    m_arrays = nullptr;
+}
+
+/*****************************************************************************/
+
+MeshCache::MeshCache(const string& directory)
+    : m_directory(directory), m_hits(0), m_misses(0) {
+    if (m_directory.empty()) return;
+#ifdef _WIN32
+    _mkdir(m_directory.c_str());
+#else
+    mkdir(m_directory.c_str(), 0755);
+#endif
+}
+
+string MeshCache::fileKey(const string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return "file:" + path;
+    }
+    char buffer[64];
+    sprintf(buffer, ":%lld:%lld", (long long)st.st_mtime, (long long)st.st_size);
+    return "file:" + path + buffer;
+}
+
+string MeshCache::paramKey(const string& name, initializer_list<float> params) {
+    string key = "gen:" + name;
+    char buffer[32];
+    for (float p : params) {
+        sprintf(buffer, ":%.9g", p);
+        key += buffer;
+    }
+    return key;
+}
+
+string MeshCache::entryPath(const string& key) const {
+    char name[32];
+    sprintf(name, "/%016llx.bin", hashKey(key));
+    return m_directory + name;
+}
+
+bool MeshCache::read(const string& key, Entry& entry) {
+    if (!enabled()) return false;
+
+    if (entry.map(entryPath(key))) {
+        // check everything before pointing into the file
+        const FileHeader* header = (const FileHeader*)entry.m_base;
+        size_t offset = sizeof(FileHeader);
+        bool valid = entry.m_size >= offset &&
+            memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+            header->version == VERSION &&
+            header->keyBytes == key.size() &&
+            header->arrayCount <= (unsigned int)MAX_ARRAYS;
+        if (valid) {
+            const unsigned long long* arrayBytes =
+                (const unsigned long long*)(entry.m_base + offset);
+            offset += header->arrayCount * sizeof(unsigned long long);
+            valid = entry.m_size >= offset + key.size() &&
+                memcmp(entry.m_base + offset, key.data(), key.size()) == 0;
+            offset = align8(offset + key.size());
+
+            size_t end = offset;
+            for (unsigned int a = 0; valid && a < header->arrayCount; ++a) {
+                end += align8((size_t)arrayBytes[a]);
+            }
+            if (valid && end == entry.m_size) {
+                entry.m_arrayCount = (int)header->arrayCount;
+                entry.m_arrayBytes = arrayBytes;
+                entry.m_arrays = entry.m_base + offset;
+                m_hits++;
+                return true;
+            }
+        }
+        entry.unmap();
+    }
+    m_misses++;
+    return false;
+}
+
+bool MeshCache::write(const string& key, const Array* arrays, int count) const {
+    if (!enabled() || count > MAX_ARRAYS) return false;
+
+    // written aside and renamed, a crash never leaves a half entry behind
+    string path = entryPath(key);
+    string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (!file) {
+        printf("Mesh cache: can't write %s\n", temporary.c_str());
+        return false;
+    }
+
+    static const char ZEROS[8] = {0};
+    FileHeader header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.keyBytes = (unsigned int)key.size();
+    header.arrayCount = (unsigned int)count;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    size_t offset = sizeof(header);
+    for (int a = 0; a < count; ++a) {
+        unsigned long long bytes = arrays[a].bytes;
+        ok = ok && fwrite(&bytes, sizeof(bytes), 1, file) == 1;
+        offset += sizeof(bytes);
+    }
+    ok = ok && fwrite(key.data(), 1, key.size(), file) == key.size();
+    offset += key.size();
+    ok = ok && fwrite(ZEROS, 1, align8(offset) - offset, file) == align8(offset) - offset;
+    for (int a = 0; a < count; ++a) {
+        size_t bytes = arrays[a].bytes;
+        size_t padding = align8(bytes) - bytes;
+        ok = ok && (bytes == 0 || fwrite(arrays[a].data, 1, bytes, file) == bytes);
+        ok = ok && fwrite(ZEROS, 1, padding, file) == padding;
+    }
+    ok = (fclose(file) == 0) && ok;
+
+    if (ok) {
+        remove(path.c_str());
+        ok = rename(temporary.c_str(), path.c_str()) == 0;
+    }
+    if (!ok) {
+        remove(temporary.c_str());
+        printf("Mesh cache: can't write %s\n", path.c_str());
+    }
+    return ok;
+}
+
+/*****************************************************************************/
+
+// arrays of a Drawable entry
+enum { POSITIONS, UVS, NORMALS, INDICES, DRAWABLE_ARRAYS };
+
+MeshCache::IndexedMesh::IndexedMesh()
+    : positions(nullptr), uvs(nullptr), normals(nullptr), vertexCount(0),
+    indices(nullptr), indexCount(0) {
+}
+
+Drawable* MeshCache::IndexedMesh::createDrawable() const {
+    return new Drawable(positions, uvs, normals, vertexCount, indices, indexCount);
+}
+
+void MeshCache::IndexedMesh::upload(Drawable& drawable) const {
+    drawable.upload(positions, uvs, normals, vertexCount, indices, indexCount);
+}
+
+bool MeshCache::mapIndexed(const string& key, IndexedMesh& mesh) {
+    Entry& entry = mesh.m_entry;
+    if (!read(key, entry)) return false;
+    if (entry.arrayCount() != DRAWABLE_ARRAYS) {
+        entry.unmap();
+        return false;
+    }
+
+    int vertexCount = (int)entry.count<vec3>(POSITIONS);
+    if (vertexCount == 0 ||
+        (entry.bytes(UVS) != 0 && (int)entry.count<vec2>(UVS) != vertexCount) ||
+        (entry.bytes(NORMALS) != 0 && (int)entry.count<vec3>(NORMALS) != vertexCount)) {
+        entry.unmap();
+        return false;
+    }
+
+    mesh.positions = entry.array<vec3>(POSITIONS);
+    mesh.uvs = entry.bytes(UVS) ? entry.array<vec2>(UVS) : nullptr;
+    mesh.normals = entry.bytes(NORMALS) ? entry.array<vec3>(NORMALS) : nullptr;
+    mesh.vertexCount = vertexCount;
+    mesh.indices = entry.array<unsigned int>(INDICES);
+    mesh.indexCount = (int)entry.count<unsigned int>(INDICES);
+    return true;
+}
+
+// a miss: index the soup and store the buffers
+void MeshCache::indexSoup(const string& key, const vector<vec3>& vertices,
+    const vector<vec2>& uvs, const vector<vec3>& normals, IndexedMesh& mesh) const {
+    indexVBO(vertices, uvs, normals, mesh.m_indices, mesh.m_positions, mesh.m_uvs,
+        mesh.m_normals);
+
+    Array arrays[DRAWABLE_ARRAYS] = {
+        {mesh.m_positions.data(), mesh.m_positions.size() * sizeof(vec3)},
+        {mesh.m_uvs.data(), mesh.m_uvs.size() * sizeof(vec2)},
+        {mesh.m_normals.data(), mesh.m_normals.size() * sizeof(vec3)},
+        {mesh.m_indices.data(), mesh.m_indices.size() * sizeof(unsigned int)}
+    };
+    write(key, arrays, DRAWABLE_ARRAYS);
+
+    mesh.positions = mesh.m_positions.data();
+    mesh.uvs = mesh.m_uvs.empty() ? nullptr : mesh.m_uvs.data();
+    mesh.normals = mesh.m_normals.empty() ? nullptr : mesh.m_normals.data();
+    mesh.vertexCount = (int)mesh.m_positions.size();
+    mesh.indices = mesh.m_indices.data();
+    mesh.indexCount = (int)mesh.m_indices.size();
+}
+
+void MeshCache::loadIndexed(const string& path, IndexedMesh& mesh) {
+    string key = fileKey(path);
+    if (!mapIndexed(key, mesh)) {
+        vector<vec3> vertices, normals;
+        vector<vec2> uvs;
+        loadMesh(path, vertices, uvs, normals);
+        indexSoup(key, vertices, uvs, normals, mesh);
+    }
+}
+
+void MeshCache::generateIndexed(const string& key, const SoupBuilder& build,
+    IndexedMesh& mesh) {
+    if (!mapIndexed(key, mesh)) {
+        vector<vec3> vertices, normals;
+        vector<vec2> uvs;
+        build(vertices, uvs, normals);
+        indexSoup(key, vertices, uvs, normals, mesh);
+    }
+}
+
+Drawable* MeshCache::loadDrawable(const string& path) {
+    IndexedMesh mesh;
+    loadIndexed(path, mesh);
+    return mesh.createDrawable();
+}
+
+Drawable* MeshCache::generateDrawable(const string& key, const SoupBuilder& build) {
+    IndexedMesh mesh;
+    generateIndexed(key, build, mesh);
+    return mesh.createDrawable();
+}
@@ -0,0 +1,144 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+class Drawable;
+
+/**
+* Versioned on-disk cache of finished geometry (indexed vertex / index
+* buffers, baked heights), so a warm start skips parsing and indexing.
+*
+* An entry is a list of arrays stored under a key. Source files are keyed by
+* path, modification time and size (fileKey()), generated data by the
+* generator name and its parameters (paramKey()); editing a file or changing
+* a parameter just misses. Bump VERSION when the layout or a generator
+* changes. Entries are memory mapped when read, the arrays point straight
+* into the file and go to glBufferData without a copy.
+*
+* File: header, array sizes, key, arrays, each part 8 byte aligned. A file
+* of another version, a truncated file or a hash collision (the key is
+* stored and compared) is a miss and gets rewritten.
+*
+* read(), write() and the loadIndexed() / generateIndexed() pair may run on
+* several threads at once (AssetLoader workers), as long as no two of them
+* write the same key.
+*/
+class MeshCache {
+public:
+    static const unsigned int VERSION = 2;
+
+    struct Array {
+        const void* data;
+        size_t bytes;
+    };
+
+    /* mapped entry, the arrays are valid while it lives */
+    class Entry {
+    public:
+        Entry();
+        ~Entry();
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+
+        int arrayCount() const { return m_arrayCount; }
+        const void* data(int i) const;
+        size_t bytes(int i) const;
+        template<class T> const T* array(int i) const { return (const T*)data(i); }
+        template<class T> size_t count(int i) const { return bytes(i) / sizeof(T); }
+
+    private:
+        friend class MeshCache;
+        bool map(const std::string& path);
+        void unmap();
+
+        char* m_base;
+        size_t m_size;
+        int m_arrayCount;
+        const unsigned long long* m_arrayBytes;
+        const char* m_arrays;
+#ifdef _WIN32
+        void* m_file;
+        void* m_mapping;
+#endif
+    };
+
+    /* entries live in directory (created when missing), "" disables the cache */
+    explicit MeshCache(const std::string& directory);
+
+    static std::string fileKey(const std::string& path);
+    static std::string paramKey(const std::string& name, std::initializer_list<float> params);
+
+    /* false on a miss (or when disabled) */
+    bool read(const std::string& key, Entry& entry);
+    bool write(const std::string& key, const Array* arrays, int count) const;
+
+    /* triangle soup (vertices, uvs, normals) of a generator */
+    typedef std::function<void(std::vector<glm::vec3>&, std::vector<glm::vec2>&,
+        std::vector<glm::vec3>&)> SoupBuilder;
+
+    /**
+    * Indexed buffers of a Drawable, CPU side: pointers into the mapped entry
+    * on a hit, into the freshly indexed vectors on a miss. uvs / normals may
+    * be null.
+    */
+    class IndexedMesh {
+    public:
+        IndexedMesh();
+        IndexedMesh(const IndexedMesh&) = delete;
+        IndexedMesh& operator=(const IndexedMesh&) = delete;
+
+        const glm::vec3* positions;
+        const glm::vec2* uvs;
+        const glm::vec3* normals;
+        int vertexCount;
+        const unsigned int* indices;
+        int indexCount;
+
+        /* GL thread */
+        Drawable* createDrawable() const;
+        void upload(Drawable& drawable) const;
+
+    private:
+        friend class MeshCache;
+        Entry m_entry;
+        std::vector<glm::vec3> m_positions, m_normals;
+        std::vector<glm::vec2> m_uvs;
+        std::vector<unsigned int> m_indices;
+    };
+
+    /**
+    * Buffers of an .obj / .vtp file: mapped from the cache, or loaded,
+    * indexed and stored on a miss. No GL calls.
+    */
+    void loadIndexed(const std::string& path, IndexedMesh& mesh);
+    /* buffers of the soup build() makes on a miss, indexed and stored under key */
+    void generateIndexed(const std::string& key, const SoupBuilder& build, IndexedMesh& mesh);
+
+    /* loadIndexed() / generateIndexed() and the upload in one go */
+    Drawable* loadDrawable(const std::string& path);
+    Drawable* generateDrawable(const std::string& key, const SoupBuilder& build);
+
+    bool enabled() const { return !m_directory.empty(); }
+    int getHits() const { return m_hits; }
+    int getMisses() const { return m_misses; }
+
+private:
+    std::string entryPath(const std::string& key) const;
+    bool mapIndexed(const std::string& key, IndexedMesh& mesh);
+    void indexSoup(const std::string& key, const std::vector<glm::vec3>& vertices,
+        const std::vector<glm::vec2>& uvs, const std::vector<glm::vec3>& normals,
+        IndexedMesh& mesh) const;
+
+    std::string m_directory;
+    std::atomic<int> m_hits;
+    std::atomic<int> m_misses;
+};
+
+#endif
@@ -0,0 +1,186 @@
+#include "meshOptimizer.h"
+#include <cmath>
+
+using namespace std;
+
+// Forsyth's tuning: LRU cache of 32, the last triangle's vertices get a fixed
+// score (they were just used, the cache position scores assume reuse later)
+static const int CACHE_SIZE = 32;
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRIANGLE_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+static const int VALENCE_TABLE_SIZE = 32;
+
+namespace {
+
+struct ScoreTables {
+    float cache[CACHE_SIZE];
+    float valence[VALENCE_TABLE_SIZE];
+
+    ScoreTables() {
+        for (int i = 0; i < CACHE_SIZE; ++i) {
+            cache[i] = i < 3 ? LAST_TRIANGLE_SCORE :
+                pow(1.0f - (i - 3) / (float)(CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+        for (int i = 0; i < VALENCE_TABLE_SIZE; ++i) {
+            valence[i] = i == 0 ? 0.0f : VALENCE_BOOST_SCALE * pow((float)i, -VALENCE_BOOST_POWER);
+        }
+    }
+
+    // vertex with the given cache position (-1 = not cached) and triangles left
+    float vertex(int cachePosition, unsigned int remaining) const {
+        // no triangle left, the vertex is no use any more
+        if (remaining == 0) return -1.0f;
+        float score = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+        return score + (remaining < (unsigned int)VALENCE_TABLE_SIZE ? valence[remaining] :
+            VALENCE_BOOST_SCALE * pow((float)remaining, -VALENCE_BOOST_POWER));
+    }
+};
+
+}
+
+void optimizeVertexCache(vector<unsigned int>& indices, size_t vertexCount) {
+    static const ScoreTables scores;
+
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // triangles of every vertex, compressed rows; the first remaining[v]
+    // entries of a row are the triangles not emitted yet
+    vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int index : indices) {
+        remaining[index]++;
+    }
+    vector<unsigned int> offset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        offset[v + 1] = offset[v] + remaining[v];
+    }
+    vector<unsigned int> adjacency(triangleCount * 3);
+    {
+        vector<unsigned int> fill(offset.begin(), offset.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (int k = 0; k < 3; ++k) {
+                adjacency[fill[indices[t * 3 + k]]++] = (unsigned int)t;
+            }
+        }
+    }
+
+    vector<int> cachePosition(vertexCount, -1);
+    vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        vertexScore[v] = scores.vertex(-1, remaining[v]);
+    }
+
+    vector<float> triangleScore(triangleCount);
+    vector<char> emitted(triangleCount, 0);
+    int best = 0;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const unsigned int* tri = &indices[t * 3];
+        triangleScore[t] = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+        if (triangleScore[t] > triangleScore[best]) best = (int)t;
+    }
+
+    vector<unsigned int> output(indices.size());
+    // cache before and after a triangle, the tail past CACHE_SIZE was evicted
+    vector<unsigned int> cache, next;
+    cache.reserve(CACHE_SIZE + 3);
+    next.reserve(CACHE_SIZE + 3);
+    size_t cursor = 0;
+
+    for (size_t out = 0; out < triangleCount; ++out) {
+        // nothing in the cache to continue from: next triangle in input order
+        if (best < 0) {
+            while (emitted[cursor]) cursor++;
+            best = (int)cursor;
+        }
+
+        const unsigned int* tri = &indices[best * 3];
+        emitted[best] = 1;
+        next.clear();
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = tri[k];
+            output[out * 3 + k] = v;
+            next.push_back(v);
+
+            // drop the triangle from the vertex's remaining ones
+            unsigned int* row = &adjacency[offset[v]];
+            unsigned int last = --remaining[v];
+            for (unsigned int i = 0; i <= last; ++i) {
+                if (row[i] == (unsigned int)best) {
+                    row[i] = row[last];
+                    row[last] = best;
+                    break;
+                }
+            }
+        }
+        for (unsigned int v : cache) {
+            if (v != tri[0] && v != tri[1] && v != tri[2]) next.push_back(v);
+        }
+
+        // new cache positions and scores, evicted vertices fall out
+        for (size_t i = 0; i < next.size(); ++i) {
+            unsigned int v = next[i];
+            cachePosition[v] = i < (size_t)CACHE_SIZE ? (int)i : -1;
+            vertexScore[v] = scores.vertex(cachePosition[v], remaining[v]);
+        }
+
+        // only triangles around the changed vertices change score
+        best = -1;
+        float bestScore = -1.0f;
+        for (unsigned int v : next) {
+            const unsigned int* row = &adjacency[offset[v]];
+            for (unsigned int i = 0; i < remaining[v]; ++i) {
+                unsigned int t = row[i];
+                const unsigned int* other = &indices[t * 3];
+                float score = vertexScore[other[0]] + vertexScore[other[1]] + vertexScore[other[2]];
+                triangleScore[t] = score;
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = (int)t;
+                }
+            }
+        }
+
+        if (next.size() > (size_t)CACHE_SIZE) next.resize(CACHE_SIZE);
+        cache.swap(next);
+    }
+
+    indices.swap(output);
+}
+
+vector<unsigned int> optimizeVertexFetch(vector<unsigned int>& indices, size_t vertexCount) {
+    const unsigned int UNUSED = ~0u;
+    vector<unsigned int> remap(vertexCount, UNUSED);
+
+    unsigned int next = 0;
+    for (unsigned int& index : indices) {
+        if (remap[index] == UNUSED) {
+            remap[index] = next++;
+        }
+        index = remap[index];
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        if (remap[v] == UNUSED) {
+            remap[v] = next++;
+        }
+    }
+    return remap;
+}
+
+float averageCacheMissRatio(const vector<unsigned int>& indices, size_t vertexCount,
+    int cacheSize) {
+    if (indices.size() < 3) return 0.0f;
+
+    // FIFO: a vertex is in the cache while fewer than cacheSize misses
+    // happened since it was loaded
+    vector<size_t> loadedAt(vertexCount, 0);
+    size_t misses = 0;
+    for (unsigned int index : indices) {
+        if (loadedAt[index] == 0 || misses - loadedAt[index] >= (size_t)cacheSize) {
+            misses++;
+            loadedAt[index] = misses;
+        }
+    }
+    return misses / (float)(indices.size() / 3);
+}
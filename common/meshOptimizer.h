@@ -0,0 +1,42 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+* Reorders the triangles of an indexed triangle list so that consecutive
+* triangles share vertices, which lets the post-transform cache of the GPU
+* skip vertex shader runs.
+* Tom Forsyth, "Linear-Speed Vertex Cache Optimisation", 2006
+* https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+*/
+void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+
+/**
+* Renumbers the vertices in the order the (reordered) triangles first use
+* them, so vertex fetch walks the buffers forwards. Returns the old -> new
+* remap table for remapVertices(); unused vertices go to the end.
+*/
+std::vector<unsigned int> optimizeVertexFetch(std::vector<unsigned int>& indices,
+    size_t vertexCount);
+
+/* applies an optimizeVertexFetch() remap to one attribute array */
+template<class T>
+void remapVertices(std::vector<T>& attribute, const std::vector<unsigned int>& remap) {
+    if (attribute.empty()) return;
+    std::vector<T> remapped(attribute.size());
+    for (size_t v = 0; v < attribute.size(); ++v) {
+        remapped[remap[v]] = attribute[v];
+    }
+    attribute.swap(remapped);
+}
+
+/**
+* Average cache miss ratio: vertex shader runs per triangle with a FIFO
+* post-transform cache of cacheSize entries (3 = no reuse, ~0.5 = ideal grid).
+*/
+float averageCacheMissRatio(const std::vector<unsigned int>& indices,
+    size_t vertexCount, int cacheSize = 16);
+
+#endif
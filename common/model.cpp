@@ -7,6 +7,7 @@
 #include "util.h"
 #include "model.h"
 #include "texture.h"
+#include "meshOptimizer.h"
 
 using namespace glm;
 using namespace std;
@@ -272,22 +273,27 @@ struct PackedVertex {
     glm::vec3 position;
     glm::vec2 uv;
     glm::vec3 normal;
-    bool operator<(const PackedVertex that) const {
-        return memcmp((void*) this, (void*) &that, sizeof(PackedVertex)) > 0;
-    };
+    // bitwise, like the old memcmp ordering (-0 and 0 stay apart)
+    bool operator==(const PackedVertex& that) const {
+        return memcmp((const void*) this, (const void*) &that, sizeof(PackedVertex)) == 0;
+    }
 };
 
-bool getSimilarVertexIndex(
-    PackedVertex& packed,
-    map<PackedVertex, unsigned int>& vertexToOutIndex,
-    unsigned int& result) {
-    map<PackedVertex, unsigned int>::iterator it = vertexToOutIndex.find(packed);
-    if (it == vertexToOutIndex.end()) {
-        return false;
-    } else {
-        result = it->second;
-        return true;
+static unsigned int hashVertex(const PackedVertex& packed) {
+    unsigned int words[sizeof(PackedVertex) / sizeof(unsigned int)];
+    memcpy(words, &packed, sizeof(words));
+    // murmur style mixing of the float bits
+    unsigned int h = 0x9747b28cu;
+    for (unsigned int w : words) {
+        w *= 0xcc9e2d51u;
+        w = (w << 15) | (w >> 17);
+        h ^= w * 0x1b873593u;
+        h = ((h << 13) | (h >> 19)) * 5 + 0xe6546b64u;
     }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
 }
 
 void indexVBO(
@@ -297,44 +303,279 @@ void indexVBO(
     vector<unsigned int>& out_indices,
     vector<vec3>& out_vertices,
     vector<vec2>& out_uvs,
-    vector<vec3>& out_normals) {
-    map<PackedVertex, unsigned int> vertexToOutIndex;
-
-    // For each input vertex
-    for (int i = 0; i < static_cast<int>(in_vertices.size()); i++) {
-        vec3 vertices = in_vertices[i];
-        vec2 uvs;
-        vec3 normals;
-        if (in_uvs.size() != 0) uvs = in_uvs[i];
-        if (in_normals.size() != 0) normals = in_normals[i];
-        PackedVertex packed = {vertices, uvs, normals};
-
-        // Try to find a similar vertex in out_XXXX
-        unsigned int index;
-        bool found = getSimilarVertexIndex(packed, vertexToOutIndex, index);
-
-        if (found) { // A similar vertex is already in the VBO, use it instead !
-            out_indices.push_back(index);
-        } else { // If not, it needs to be added in the output data.
-            out_vertices.push_back(vertices);
-            if (in_uvs.size() != 0) out_uvs.push_back(uvs);
-            if (in_normals.size() != 0) out_normals.push_back(normals);
-            unsigned int newindex = (unsigned int) out_vertices.size() - 1;
-            out_indices.push_back(newindex);
-            vertexToOutIndex[packed] = newindex;
+    vector<vec3>& out_normals,
+    bool optimize) {
+    size_t count = in_vertices.size();
+    size_t base = out_vertices.size();
+
+    // open addressing, linear probing, at most half full; a slot holds the
+    // output index of the vertex or EMPTY
+    const unsigned int EMPTY = ~0u;
+    size_t tableSize = 16;
+    while (tableSize < count * 2) tableSize *= 2;
+    vector<unsigned int> table(tableSize, EMPTY);
+    vector<PackedVertex> unique;
+    unique.reserve(count);
+
+    out_indices.reserve(out_indices.size() + count);
+    for (size_t i = 0; i < count; i++) {
+        PackedVertex packed = {in_vertices[i],
+            in_uvs.size() != 0 ? in_uvs[i] : vec2(0.0f),
+            in_normals.size() != 0 ? in_normals[i] : vec3(0.0f)};
+
+        size_t slot = hashVertex(packed) & (tableSize - 1);
+        while (table[slot] != EMPTY && !(unique[table[slot]] == packed)) {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+
+        if (table[slot] == EMPTY) { // first time seen, add it to the VBO
+            table[slot] = (unsigned int) unique.size();
+            unique.push_back(packed);
+        }
+        out_indices.push_back((unsigned int) base + table[slot]);
+    }
+
+    // the triangles of this call only, earlier output stays as it is
+    if (optimize && count % 3 == 0) {
+        vector<unsigned int> local(out_indices.end() - count, out_indices.end());
+        for (unsigned int& index : local) index -= (unsigned int) base;
+        optimizeVertexCache(local, unique.size());
+        vector<unsigned int> remap = optimizeVertexFetch(local, unique.size());
+        remapVertices(unique, remap);
+        for (size_t i = 0; i < count; i++) {
+            out_indices[out_indices.size() - count + i] = (unsigned int) base + local[i];
         }
     }
+
+    out_vertices.reserve(base + unique.size());
+    for (const PackedVertex& packed : unique) {
+        out_vertices.push_back(packed.position);
+        if (in_uvs.size() != 0) out_uvs.push_back(packed.uv);
+        if (in_normals.size() != 0) out_normals.push_back(packed.normal);
+    }
 }
 
-Drawable::Drawable(string path) {
+void loadMesh(
+    const string& path,
+    vector<vec3>& vertices,
+    vector<vec2>& uvs,
+    vector<vec3>& normals) {
+    // soup, the sequential indices are not needed
+    vector<unsigned int> indices;
     if (path.substr(path.size() - 3, 3) == "obj") {
-        loadOBJWithTiny(path.c_str(), vertices, uvs, normals, VEC_UINT_DEFAUTL_VALUE);
+        loadOBJWithTiny(path.c_str(), vertices, uvs, normals, indices);
     } else if (path.substr(path.size() - 3, 3) == "vtp") {
-        loadVTP(path.c_str(), vertices, uvs, normals, VEC_UINT_DEFAUTL_VALUE);
+        loadVTP(path.c_str(), vertices, uvs, normals, indices);
     } else {
         throw runtime_error("File format not supported: " + path);
     }
+}
+
+/*****************************************************************************/
+
+static MeshFormat meshFormat = {false, false};
+
+void setMeshFormat(const MeshFormat& format) {
+    meshFormat = format;
+}
+
+MeshFormat getMeshFormat() {
+    return meshFormat;
+}
+
+template<class T>
+static void releaseVector(vector<T>& v) {
+    vector<T>().swap(v);
+}
+
+template<class T>
+static size_t vectorBytes(const vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+// float -> IEEE half, round to nearest; out of range / tiny values give
+// inf / 0 (the callers check the round trip)
+static unsigned short floatToHalf(float f) {
+    unsigned int bits;
+    memcpy(&bits, &f, sizeof(bits));
+    unsigned short sign = (unsigned short)((bits >> 16) & 0x8000);
+    int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+    unsigned int mantissa = bits & 0x7fffff;
+    if (exponent <= 0) return sign;
+    if (exponent >= 31) return sign | 0x7c00;
+    unsigned short half = (unsigned short)(sign | (exponent << 10) | (mantissa >> 13));
+    // a carry out of the mantissa rounds up into the exponent
+    if (mantissa & 0x1000) half++;
+    return half;
+}
+
+static float halfToFloat(unsigned short h) {
+    unsigned int sign = (unsigned int)(h & 0x8000) << 16;
+    unsigned int exponent = (h >> 10) & 0x1f;
+    unsigned int mantissa = h & 0x3ff;
+    unsigned int bits;
+    if (exponent == 0) {
+        bits = sign; // zero (subnormals are never produced)
+    } else if (exponent == 31) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// octahedral normal in a GL_INT_2_10_10_10_REV, w = -1 marks the encoding
+// http://jcgt.org/published/0003/02/01/
+static unsigned int packNormal(vec3 n) {
+    float l1 = glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z);
+    vec2 e = l1 > 0.0f ? vec2(n.x, n.y) / l1 : vec2(0.0f);
+    if (l1 > 0.0f && n.z < 0.0f) {
+        vec2 folded = vec2(1.0f) - abs(vec2(e.y, e.x));
+        e = vec2(e.x >= 0.0f ? folded.x : -folded.x, e.y >= 0.0f ? folded.y : -folded.y);
+    }
+    int x = (int)round(clamp(e.x, -1.0f, 1.0f) * 511.0f);
+    int y = (int)round(clamp(e.y, -1.0f, 1.0f) * 511.0f);
+    return (unsigned int)(x & 0x3ff) | ((unsigned int)(y & 0x3ff) << 10) | (3u << 30);
+}
+
+enum UVFormat { UV_UNORM16, UV_HALF, UV_FLOAT };
+
+static UVFormat chooseUVFormat(const vec2* uvs, int count) {
+    bool unit = true, halfExact = true;
+    for (int i = 0; i < count && (unit || halfExact); ++i) {
+        for (int c = 0; c < 2; ++c) {
+            float f = uvs[i][c];
+            unit = unit && f >= 0.0f && f <= 1.0f;
+            halfExact = halfExact && halfToFloat(floatToHalf(f)) == f;
+        }
+    }
+    return unit ? UV_UNORM16 : halfExact ? UV_HALF : UV_FLOAT;
+}
+
+/**
+* Uploads one indexed mesh in the current MeshFormat into a new VAO,
+* returns the bytes of GL buffer memory. uvs / normals may be null.
+*/
+static size_t uploadMesh(const vec3* positions, const vec2* uvs, const vec3* normals,
+    int vertexCount, const unsigned int* indices, int indexCount,
+    GLuint& VAO, GLuint& verticesVBO, GLuint& uvsVBO, GLuint& normalsVBO,
+    GLuint& elementVBO, GLenum& indexType) {
+    uvsVBO = 0;
+    normalsVBO = 0;
+    size_t bytes = 0;
+
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+
+    if (meshFormat.compact) {
+        UVFormat uvFormat = uvs ? chooseUVFormat(uvs, vertexCount) : UV_FLOAT;
+        size_t normalOffset = sizeof(vec3);
+        size_t uvOffset = normalOffset + (normals ? sizeof(unsigned int) : 0);
+        size_t uvBytes = !uvs ? 0 : uvFormat == UV_FLOAT ? sizeof(vec2) : 2 * sizeof(unsigned short);
+        size_t stride = uvOffset + uvBytes;
+
+        vector<unsigned char> interleaved(stride * vertexCount);
+        for (int v = 0; v < vertexCount; ++v) {
+            unsigned char* out = &interleaved[v * stride];
+            memcpy(out, &positions[v], sizeof(vec3));
+            if (normals) {
+                unsigned int packed = packNormal(normals[v]);
+                memcpy(out + normalOffset, &packed, sizeof(packed));
+            }
+            if (uvs) {
+                if (uvFormat == UV_FLOAT) {
+                    memcpy(out + uvOffset, &uvs[v], sizeof(vec2));
+                } else {
+                    unsigned short uv[2];
+                    for (int c = 0; c < 2; ++c) {
+                        uv[c] = uvFormat == UV_HALF ? floatToHalf(uvs[v][c]) :
+                            (unsigned short)round(uvs[v][c] * 65535.0f);
+                    }
+                    memcpy(out + uvOffset, uv, sizeof(uv));
+                }
+            }
+        }
+
+        glGenBuffers(1, &verticesVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, verticesVBO);
+        glBufferData(GL_ARRAY_BUFFER, interleaved.size(), interleaved.data(), GL_STATIC_DRAW);
+        bytes += interleaved.size();
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, (GLsizei)stride, NULL);
+        glEnableVertexAttribArray(0);
+        if (normals) {
+            glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, (GLsizei)stride,
+                (const void*)normalOffset);
+            glEnableVertexAttribArray(1);
+        }
+        if (uvs) {
+            if (uvFormat == UV_FLOAT) {
+                glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, (GLsizei)stride, (const void*)uvOffset);
+            } else if (uvFormat == UV_HALF) {
+                glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, (GLsizei)stride, (const void*)uvOffset);
+            } else {
+                glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, (GLsizei)stride, (const void*)uvOffset);
+            }
+            glEnableVertexAttribArray(2);
+        }
+    } else {
+        glGenBuffers(1, &verticesVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, verticesVBO);
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(vec3),
+                     positions, GL_STATIC_DRAW);
+        bytes += vertexCount * sizeof(vec3);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
+        glEnableVertexAttribArray(0);
+
+        if (normals) {
+            glGenBuffers(1, &normalsVBO);
+            glBindBuffer(GL_ARRAY_BUFFER, normalsVBO);
+            glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(vec3),
+                         normals, GL_STATIC_DRAW);
+            bytes += vertexCount * sizeof(vec3);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, NULL);
+            glEnableVertexAttribArray(1);
+        }
 
+        if (uvs) {
+            glGenBuffers(1, &uvsVBO);
+            glBindBuffer(GL_ARRAY_BUFFER, uvsVBO);
+            glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(vec2),
+                         uvs, GL_STATIC_DRAW);
+            bytes += vertexCount * sizeof(vec2);
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+            glEnableVertexAttribArray(2);
+        }
+    }
+
+    // Generate a buffer for the indices as well
+    glGenBuffers(1, &elementVBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementVBO);
+    if (meshFormat.compact && vertexCount <= 65536) {
+        vector<unsigned short> shortIndices(indices, indices + indexCount);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned short),
+                     shortIndices.data(), GL_STATIC_DRAW);
+        bytes += indexCount * sizeof(unsigned short);
+        indexType = GL_UNSIGNED_SHORT;
+    } else {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int),
+                     indices, GL_STATIC_DRAW);
+        bytes += indexCount * sizeof(unsigned int);
+        indexType = GL_UNSIGNED_INT;
+    }
+    return bytes;
+}
+
+/*****************************************************************************/
+
+Drawable::Drawable()
+    : VAO(0), verticesVBO(0), uvsVBO(0), normalsVBO(0), elementVBO(0),
+    indexCount(0), indexType(GL_UNSIGNED_INT), gpuBytes(0) {
+}
+
+Drawable::Drawable(string path) {
+    loadMesh(path, vertices, uvs, normals);
     createContext();
 }
 
@@ -343,12 +584,26 @@ Drawable::Drawable(const vector<vec3>& vertices, const vector<vec2>& uvs,
     createContext();
 }
 
+Drawable::Drawable(const vector<vec3>& indexedVertices, const vector<vec2>& indexedUVS,
+                   const vector<vec3>& indexedNormals, const vector<unsigned int>& indices)
+    : indexedVertices(indexedVertices), indexedNormals(indexedNormals),
+    indexedUVS(indexedUVS), indices(indices) {
+    uploadContext();
+}
+
+Drawable::Drawable(const vec3* positions, const vec2* uvs, const vec3* normals,
+                   int vertexCount, const unsigned int* indices, int indexCount) {
+    uploadContext(positions, uvs, normals, vertexCount, indices, indexCount);
+}
+
 Drawable::~Drawable() {
-    glDeleteBuffers(1, &verticesVBO);
-    glDeleteBuffers(1, &uvsVBO);
-    glDeleteBuffers(1, &normalsVBO);
-    glDeleteBuffers(1, &elementVBO);
-    glDeleteBuffers(1, &VAO);
+    deleteContext();
+}
+
+void Drawable::upload(const vec3* positions, const vec2* uvs, const vec3* normals,
+                      int vertexCount, const unsigned int* indices, int indexCount) {
+    deleteContext();
+    uploadContext(positions, uvs, normals, vertexCount, indices, indexCount);
 }
 
 void Drawable::bind() {
@@ -356,46 +611,57 @@ void Drawable::bind() {
 }
 
 void Drawable::draw(int mode) {
-    glDrawElements(mode, indices.size(), GL_UNSIGNED_INT, NULL);
+    // placeholder, nothing uploaded yet
+    if (indexCount == 0) return;
+    glDrawElements(mode, indexCount, indexType, NULL);
+}
+
+size_t Drawable::getCPUBytes() const {
+    return vectorBytes(vertices) + vectorBytes(normals) + vectorBytes(uvs) +
+        vectorBytes(indexedVertices) + vectorBytes(indexedNormals) +
+        vectorBytes(indexedUVS) + vectorBytes(indices);
+}
+
+void Drawable::deleteContext() {
+    glDeleteBuffers(1, &verticesVBO);
+    glDeleteBuffers(1, &uvsVBO);
+    glDeleteBuffers(1, &normalsVBO);
+    glDeleteBuffers(1, &elementVBO);
+    glDeleteVertexArrays(1, &VAO);
+    VAO = verticesVBO = uvsVBO = normalsVBO = elementVBO = 0;
+    indexCount = 0;
+    gpuBytes = 0;
 }
 
 void Drawable::createContext() {
     indices = vector<unsigned int>();
     indexVBO(vertices, uvs, normals, indices, indexedVertices, indexedUVS, indexedNormals);
 
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-
-    glGenBuffers(1, &verticesVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, verticesVBO);
-    glBufferData(GL_ARRAY_BUFFER, indexedVertices.size() * sizeof(vec3),
-                 &indexedVertices[0], GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(0);
-
-    if (indexedNormals.size() != 0) {
-        glGenBuffers(1, &normalsVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, normalsVBO);
-        glBufferData(GL_ARRAY_BUFFER, indexedNormals.size() * sizeof(vec3),
-                     &indexedNormals[0], GL_STATIC_DRAW);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-        glEnableVertexAttribArray(1);
-    }
+    uploadContext();
+}
 
-    if (indexedUVS.size() != 0) {
-        glGenBuffers(1, &uvsVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, uvsVBO);
-        glBufferData(GL_ARRAY_BUFFER, indexedUVS.size() * sizeof(vec2),
-                     &indexedUVS[0], GL_STATIC_DRAW);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, NULL);
-        glEnableVertexAttribArray(2);
+void Drawable::uploadContext() {
+    uploadContext(indexedVertices.data(),
+        indexedUVS.empty() ? nullptr : indexedUVS.data(),
+        indexedNormals.empty() ? nullptr : indexedNormals.data(),
+        (int)indexedVertices.size(), indices.data(), (int)indices.size());
+
+    if (meshFormat.releaseCPU) {
+        releaseVector(vertices);
+        releaseVector(normals);
+        releaseVector(uvs);
+        releaseVector(indexedVertices);
+        releaseVector(indexedNormals);
+        releaseVector(indexedUVS);
+        releaseVector(indices);
     }
+}
 
-    // Generate a buffer for the indices as well
-    glGenBuffers(1, &elementVBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementVBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
-                 &indices[0], GL_STATIC_DRAW);
+void Drawable::uploadContext(const vec3* positions, const vec2* uvs,
+    const vec3* normals, int vertexCount, const unsigned int* indices, int count) {
+    indexCount = count;
+    gpuBytes = uploadMesh(positions, uvs, normals, vertexCount, indices, count,
+        VAO, verticesVBO, uvsVBO, normalsVBO, elementVBO, indexType);
 }
 
 /*****************************************************************************/
@@ -415,7 +681,8 @@ Mesh::Mesh(Mesh&& other)
     uvs{std::move(other.uvs)}, indexedUVS{std::move(other.indexedUVS)},
     indices{std::move(other.indices)}, mtl{std::move(other.mtl)},
     VAO{other.VAO}, verticesVBO{other.verticesVBO}, normalsVBO{other.normalsVBO},
-    uvsVBO{other.uvsVBO}, elementVBO{other.elementVBO} {
+    uvsVBO{other.uvsVBO}, elementVBO{other.elementVBO},
+    indexCount{other.indexCount}, indexType{other.indexType} {
     other.VAO = 0;
     other.verticesVBO = 0;
     other.normalsVBO = 0;
@@ -436,46 +703,29 @@ void Mesh::bind() {
 }
 
 void Mesh::draw(int mode) {
-    glDrawElements(mode, indices.size(), GL_UNSIGNED_INT, NULL);
+    glDrawElements(mode, indexCount, indexType, NULL);
 }
 
 void Mesh::createContext() {
     indices = vector<unsigned int>();
     indexVBO(vertices, uvs, normals, indices, indexedVertices, indexedUVS, indexedNormals);
 
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-
-    glGenBuffers(1, &verticesVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, verticesVBO);
-    glBufferData(GL_ARRAY_BUFFER, indexedVertices.size() * sizeof(vec3),
-                 &indexedVertices[0], GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(0);
-
-    if (indexedNormals.size() != 0) {
-        glGenBuffers(1, &normalsVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, normalsVBO);
-        glBufferData(GL_ARRAY_BUFFER, indexedNormals.size() * sizeof(vec3),
-                     &indexedNormals[0], GL_STATIC_DRAW);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-        glEnableVertexAttribArray(1);
+    indexCount = (int)indices.size();
+    uploadMesh(indexedVertices.data(),
+        indexedUVS.empty() ? nullptr : indexedUVS.data(),
+        indexedNormals.empty() ? nullptr : indexedNormals.data(),
+        (int)indexedVertices.size(), indices.data(), indexCount,
+        VAO, verticesVBO, uvsVBO, normalsVBO, elementVBO, indexType);
+
+    if (meshFormat.releaseCPU) {
+        releaseVector(vertices);
+        releaseVector(normals);
+        releaseVector(uvs);
+        releaseVector(indexedVertices);
+        releaseVector(indexedNormals);
+        releaseVector(indexedUVS);
+        releaseVector(indices);
     }
-
-    if (indexedUVS.size() != 0) {
-        glGenBuffers(1, &uvsVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, uvsVBO);
-        glBufferData(GL_ARRAY_BUFFER, indexedUVS.size() * sizeof(vec2),
-                     &indexedUVS[0], GL_STATIC_DRAW);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, NULL);
-        glEnableVertexAttribArray(2);
-    }
-
-    // Generate a buffer for the indices as well
-    glGenBuffers(1, &elementVBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementVBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
-                 &indices[0], GL_STATIC_DRAW);
 }
 
 Model::Model(string path, Model::MTLUploadFunction* uploader)
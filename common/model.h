@@ -47,9 +47,25 @@ void loadOBJWithTiny(
     std::vector<unsigned int>& indices = VEC_UINT_DEFAUTL_VALUE
 );
 
+/**
+* Loads an .obj (loadOBJWithTiny()) or .vtp (loadVTP()) file as a triangle
+* soup, picked by the extension.
+*/
+void loadMesh(
+    const std::string& path,
+    std::vector<glm::vec3>& vertices,
+    std::vector<glm::vec2>& uvs,
+    std::vector<glm::vec3>& normals
+);
+
 /**
 * Create VBO indexing.
 * http://www.opengl-tutorial.org/intermediate-tutorials/tutorial-9-vbo-indexing/
+*
+* Bitwise identical vertices are merged through an open addressing hash
+* table. With optimize the triangles are then reordered for the vertex cache
+* and the vertices for fetch (see meshOptimizer.h); the mesh is the same, only
+* the order changes.
 */
 void indexVBO(
     const std::vector<glm::vec3>& in_vertices,
@@ -58,11 +74,37 @@ void indexVBO(
     std::vector<unsigned int> & out_indices,
     std::vector<glm::vec3> & out_vertices,
     std::vector<glm::vec2> & out_uvs,
-    std::vector<glm::vec3> & out_normals
+    std::vector<glm::vec3> & out_normals,
+    bool optimize = true
 );
 
+/**
+* Vertex layout of the Drawables and ogl::Meshes created from now on.
+*
+* compact: one interleaved VBO of float positions, octahedral normals
+* (GL_INT_2_10_10_10_REV, w = -1 tells the shader to decode them) and uvs as
+* unorm16 when they lie in [0, 1], as half floats when that is lossless and as
+* floats otherwise; 16-bit indices when there are at most 65536 vertices.
+* Otherwise: float positions, normals and uvs in separate VBOs, 32-bit indices.
+*
+* releaseCPU: the vertex and index vectors are freed once uploaded.
+*/
+struct MeshFormat {
+    bool compact;
+    bool releaseCPU;
+};
+
+void setMeshFormat(const MeshFormat& format);
+MeshFormat getMeshFormat();
+
 class Drawable {
 public:
+    /**
+    * Placeholder without buffers, draws nothing until upload() fills it
+    * (meshes still loading in the AssetLoader).
+    */
+    Drawable();
+
     Drawable(std::string path);
 
     Drawable(
@@ -70,22 +112,65 @@ public:
         const std::vector<glm::vec2>& uvs = VEC_VEC2_DEFAUTL_VALUE,
         const std::vector<glm::vec3>& normals = VEC_VEC3_DEFAUTL_VALUE);
 
+    /**
+    * Already indexed geometry (e.g. generated meshes), skips indexVBO().
+    * uvs / normals may be empty, otherwise one per vertex.
+    */
+    Drawable(
+        const std::vector<glm::vec3>& indexedVertices,
+        const std::vector<glm::vec2>& indexedUVS,
+        const std::vector<glm::vec3>& indexedNormals,
+        const std::vector<unsigned int>& indices);
+
+    /**
+    * Already indexed geometry in memory (e.g. a mapped MeshCache entry),
+    * uploaded without keeping CPU copies. uvs / normals may be null.
+    */
+    Drawable(
+        const glm::vec3* positions,
+        const glm::vec2* uvs,
+        const glm::vec3* normals,
+        int vertexCount,
+        const unsigned int* indices,
+        int indexCount);
+
     ~Drawable();
 
+    /* replaces the buffers with already indexed geometry, see above */
+    void upload(
+        const glm::vec3* positions,
+        const glm::vec2* uvs,
+        const glm::vec3* normals,
+        int vertexCount,
+        const unsigned int* indices,
+        int indexCount);
+
     void bind();
 
     /* Bind VAO before calling draw */
     void draw(int mode = GL_TRIANGLES);
 
+    /* buffer memory on the GPU / vectors kept in RAM, in bytes */
+    size_t getGPUBytes() const { return gpuBytes; }
+    size_t getCPUBytes() const;
+
 public:
     std::vector<glm::vec3> vertices, normals, indexedVertices, indexedNormals;
     std::vector<glm::vec2> uvs, indexedUVS;
     std::vector<unsigned int> indices;
 
     GLuint VAO, verticesVBO, uvsVBO, normalsVBO, elementVBO;
+    int indexCount;
+    GLenum indexType;  // GL_UNSIGNED_INT or GL_UNSIGNED_SHORT
+    size_t gpuBytes;
 
 private:
     void createContext();
+    void deleteContext();
+    void uploadContext();
+    void uploadContext(const glm::vec3* positions, const glm::vec2* uvs,
+        const glm::vec3* normals, int vertexCount,
+        const unsigned int* indices, int count);
 };
 
 /*****************************************************************************/
@@ -119,6 +204,8 @@ namespace ogl {
         std::vector<unsigned int> indices;
         Material mtl;
         GLuint VAO, verticesVBO, uvsVBO, normalsVBO, elementVBO;
+        int indexCount;
+        GLenum indexType;
     private:
         void createContext();
     };
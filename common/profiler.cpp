@@ -0,0 +1,252 @@
+#include "profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+using namespace std;
+
+// trace rows of the tracks (GPU), after the threads
+static const int TRACK_ROW = 1000;
+
+static thread_local void* t_buffer = nullptr;
+
+Profiler& Profiler::get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+int64_t Profiler::now() {
+    static const chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+Profiler::Profiler()
+    : m_bufferCount(0), m_summaryEvery(300), m_frames(0), m_frameStart(now()), m_dropped(0) {
+    for (int i = 0; i < MAX_THREADS; ++i) {
+        m_buffers[i].store(nullptr);
+    }
+    m_tracks.push_back("CPU");
+}
+
+Profiler::~Profiler() {
+    for (int i = 0; i < MAX_THREADS; ++i) {
+        delete m_buffers[i].load();
+    }
+}
+
+Profiler::ThreadBuffer* Profiler::threadBuffer(const char* name) {
+    if (t_buffer) return static_cast<ThreadBuffer*>(t_buffer);
+
+    int index = m_bufferCount.fetch_add(1);
+    if (index >= MAX_THREADS) {
+        // too many threads, this one goes unprofiled
+        m_bufferCount.fetch_sub(1);
+        return nullptr;
+    }
+    ThreadBuffer* buffer = new ThreadBuffer();
+    buffer->head.store(0);
+    buffer->tail.store(0);
+    buffer->dropped.store(0);
+    buffer->name = name ? name : "thread " + to_string(index);
+    // the collector sees the buffer complete or not at all
+    m_buffers[index].store(buffer, memory_order_release);
+    t_buffer = buffer;
+    return buffer;
+}
+
+void Profiler::setThreadName(const char* name) {
+    // only before the thread's first zone, the name is not synchronized
+    threadBuffer(name);
+}
+
+void Profiler::record(const char* name, int64_t start, int64_t end) {
+    ThreadBuffer* buffer = threadBuffer(nullptr);
+    if (!buffer) return;
+
+    uint32_t head = buffer->head.load(memory_order_relaxed);
+    if (head - buffer->tail.load(memory_order_acquire) == ThreadBuffer::CAPACITY) {
+        buffer->dropped.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    Event& event = buffer->events[head & (ThreadBuffer::CAPACITY - 1)];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    buffer->head.store(head + 1, memory_order_release);
+}
+
+int Profiler::addTrack(const string& name) {
+    m_tracks.push_back(name);
+    return (int)m_tracks.size() - 1;
+}
+
+void Profiler::recordTrack(int track, const char* name, int64_t start, int64_t end) {
+    Event event = {name, start, end};
+    consume(TRACK_ROW + track, track, event);
+}
+
+int Profiler::findZone(int track, const char* name) {
+    // GPU zones may have the names of CPU ones, keep them apart
+    m_key.assign(track == 0 ? "" : m_tracks[track] + ":");
+    m_key.append(name);
+    auto found = m_zoneIds.find(m_key);
+    if (found != m_zoneIds.end()) return found->second;
+
+    ZoneStats zone;
+    zone.name = m_key;
+    zone.track = track;
+    zone.frameMs = 0.0;
+    zone.frameCalls = 0;
+    zone.windowCalls = 0;
+    m_zones.push_back(zone);
+    m_zoneIds[m_key] = (int)m_zones.size() - 1;
+    return (int)m_zones.size() - 1;
+}
+
+void Profiler::consume(int thread, int track, const Event& event) {
+    int zone = findZone(track, event.name);
+    m_zones[zone].frameMs += (event.end - event.start) * 1e-6;
+    m_zones[zone].frameCalls++;
+
+    if (!m_tracePath.empty() && m_trace.size() < MAX_TRACE_EVENTS) {
+        TraceEvent traceEvent = {zone, thread, event.start, event.end};
+        m_trace.push_back(traceEvent);
+    }
+}
+
+void Profiler::drain() {
+    int count = min(m_bufferCount.load(), MAX_THREADS);
+    for (int i = 0; i < count; ++i) {
+        ThreadBuffer* buffer = m_buffers[i].load(memory_order_acquire);
+        // registered, not published yet
+        if (!buffer) continue;
+
+        uint32_t tail = buffer->tail.load(memory_order_relaxed);
+        uint32_t head = buffer->head.load(memory_order_acquire);
+        for (; tail != head; ++tail) {
+            consume(i, 0, buffer->events[tail & (ThreadBuffer::CAPACITY - 1)]);
+        }
+        // hands the slots back to the writer
+        buffer->tail.store(tail, memory_order_release);
+        m_dropped += buffer->dropped.exchange(0, memory_order_relaxed);
+    }
+}
+
+void Profiler::endFrame() {
+    int64_t frameEnd = now();
+    record("frame", m_frameStart, frameEnd);
+    m_frameStart = frameEnd;
+
+    drain();
+    // no summaries, no window to keep (it would grow all session)
+    bool summaries = m_summaryEvery > 0;
+    for (ZoneStats& zone : m_zones) {
+        if (summaries) {
+            zone.windowMs.push_back((float)zone.frameMs);
+            zone.windowCalls += zone.frameCalls;
+        }
+        zone.frameMs = 0.0;
+        zone.frameCalls = 0;
+    }
+
+    m_frames++;
+    if (summaries && m_frames % m_summaryEvery == 0) {
+        printSummary();
+    }
+}
+
+void Profiler::printSummary() {
+    // slowest first, the CPU before the other tracks
+    vector<int> order;
+    for (size_t i = 0; i < m_zones.size(); ++i) {
+        if (!m_zones[i].windowMs.empty()) order.push_back((int)i);
+    }
+    vector<double> avg(m_zones.size(), 0.0);
+    for (int i : order) {
+        for (float ms : m_zones[i].windowMs) avg[i] += ms;
+        avg[i] /= m_zones[i].windowMs.size();
+    }
+    sort(order.begin(), order.end(), [&](int a, int b) {
+        if (m_zones[a].track != m_zones[b].track) return m_zones[a].track < m_zones[b].track;
+        return avg[a] > avg[b];
+    });
+
+    int first = m_frames - m_summaryEvery;
+    printf("profile: frames %d-%d, ms per frame\n", first, m_frames - 1);
+    printf("  %-32s %8s %9s %9s %9s\n", "zone", "calls", "min", "avg", "p99");
+    for (int i : order) {
+        ZoneStats& zone = m_zones[i];
+        vector<float>& ms = zone.windowMs;
+        size_t frames = ms.size();
+        float minMs = *min_element(ms.begin(), ms.end());
+        size_t p99 = min(frames - 1, (size_t)(frames * 0.99));
+        nth_element(ms.begin(), ms.begin() + p99, ms.end());
+        printf("  %-32s %8.2f %9.4f %9.4f %9.4f\n", zone.name.c_str(),
+            (double)zone.windowCalls / frames, minMs, avg[i], ms[p99]);
+        ms.clear();
+        zone.windowCalls = 0;
+    }
+    if (m_dropped > 0) {
+        printf("  %u zones dropped, a ring buffer was full\n", m_dropped);
+        m_dropped = 0;
+    }
+}
+
+static void writeJsonString(FILE* file, const string& s) {
+    fputc('"', file);
+    for (char c : s) {
+        if (c == '"' || c == '\\') fputc('\\', file);
+        if ((unsigned char)c >= 0x20) fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+bool Profiler::writeTrace() {
+    if (m_tracePath.empty()) return false;
+    drain();
+
+    FILE* file = fopen(m_tracePath.c_str(), "w");
+    if (!file) {
+        printf("Cannot write the profile trace %s\n", m_tracePath.c_str());
+        return false;
+    }
+
+    // Chrome trace_event format, complete events ("X") in microseconds
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+    int threads = min(m_bufferCount.load(), MAX_THREADS);
+    for (int i = 0; i < threads; ++i) {
+        ThreadBuffer* buffer = m_buffers[i].load(memory_order_acquire);
+        if (!buffer) continue;
+        fprintf(file, "%s{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 0, \"tid\": %d, "
+            "\"args\": {\"name\": ", first ? "" : ",\n", i);
+        writeJsonString(file, buffer->name);
+        fprintf(file, "}}");
+        first = false;
+    }
+    for (size_t t = 1; t < m_tracks.size(); ++t) {
+        fprintf(file, "%s{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 0, \"tid\": %d, "
+            "\"args\": {\"name\": ", first ? "" : ",\n", TRACK_ROW + (int)t);
+        writeJsonString(file, m_tracks[t]);
+        fprintf(file, "}}");
+        first = false;
+    }
+    for (const TraceEvent& event : m_trace) {
+        fprintf(file, "%s{\"ph\": \"X\", \"name\": ", first ? "" : ",\n");
+        writeJsonString(file, m_zones[event.zone].name);
+        fprintf(file, ", \"pid\": 0, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+            event.thread, event.start * 1e-3, (event.end - event.start) * 1e-3);
+        first = false;
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    printf("Profile trace: %zu events written to %s%s\n", m_trace.size(),
+        m_tracePath.c_str(), m_trace.size() >= MAX_TRACE_EVENTS ? " (full)" : "");
+    return true;
+}
+
+#endif
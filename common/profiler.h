@@ -0,0 +1,144 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/**
+* Frame profiler, built only with ENABLE_PROFILER (cmake -DPROFILER=ON).
+*
+* PROFILE_ZONE("name") times the rest of the enclosing scope on the calling
+* thread. Every thread writes its zones into a ring buffer of its own, single
+* producer / single consumer, so recording takes no lock. PROFILE_FRAME() on
+* the main thread drains all buffers once per frame: the events are kept for
+* a Chrome trace (chrome://tracing, ui.perfetto.dev) when a trace path is
+* set, and every few frames the min / avg / p99 of every zone's time per frame
+* is printed. GPU passes are timed by GpuTimer (gpuTimer.h), which hands its
+* results in on a track of their own.
+*
+* Without ENABLE_PROFILER the macros expand to nothing and none of the
+* profiler is compiled.
+*/
+
+#ifdef ENABLE_PROFILER
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Profiler {
+public:
+    static Profiler& get();
+
+    /* nanoseconds since the profiler started */
+    static int64_t now();
+
+    /* summary every frames frames, 0 = never */
+    void setSummaryEvery(int frames) { m_summaryEvery = frames; }
+    /* keeps every event for writeTrace(), empty = no trace */
+    void setTracePath(const std::string& path) { m_tracePath = path; }
+
+    /* names the calling thread in the trace */
+    void setThreadName(const char* name);
+
+    /* a zone of the calling thread; name must stay valid until the next
+       endFrame() (literals, stage names) */
+    void record(const char* name, int64_t start, int64_t end);
+
+    /* another timeline (the GPU), main thread only */
+    int addTrack(const std::string& name);
+    void recordTrack(int track, const char* name, int64_t start, int64_t end);
+
+    /* main thread, once per frame */
+    void endFrame();
+    /* drains and writes the trace gathered so far to the trace path */
+    bool writeTrace();
+
+    /* times a scope */
+    class Zone {
+    public:
+        explicit Zone(const char* name) : m_name(name), m_start(now()) {}
+        ~Zone() { get().record(m_name, m_start, now()); }
+
+    private:
+        const char* m_name;
+        int64_t m_start;
+    };
+
+private:
+    struct Event {
+        const char* name;
+        int64_t start, end;
+    };
+
+    // one per thread, written by its thread, read by endFrame()
+    struct ThreadBuffer {
+        static const uint32_t CAPACITY = 1 << 14;
+        Event events[CAPACITY];
+        std::atomic<uint32_t> head;     // next write, owner
+        std::atomic<uint32_t> tail;     // next read, collector
+        std::atomic<uint32_t> dropped;  // full when written to
+        std::string name;               // set before the buffer is published
+    };
+
+    // a zone's time per frame over the summary window
+    struct ZoneStats {
+        std::string name;
+        int track;
+        double frameMs;         // this frame so far
+        int frameCalls;
+        std::vector<float> windowMs;
+        int windowCalls;
+    };
+
+    struct TraceEvent {
+        int zone;
+        int thread;             // buffer index, or trace row of a track
+        int64_t start, end;
+    };
+
+    Profiler();
+    ~Profiler();
+    Profiler(const Profiler&);
+    Profiler& operator=(const Profiler&);
+
+    ThreadBuffer* threadBuffer(const char* name);
+    void drain();
+    void consume(int thread, int track, const Event& event);
+    int findZone(int track, const char* name);
+    void printSummary();
+
+    static const int MAX_THREADS = 64;
+    static const size_t MAX_TRACE_EVENTS = 1 << 22;
+
+    std::atomic<ThreadBuffer*> m_buffers[MAX_THREADS];
+    std::atomic<int> m_bufferCount;
+
+    // collector side, main thread only
+    std::vector<std::string> m_tracks;
+    std::vector<ZoneStats> m_zones;
+    std::unordered_map<std::string, int> m_zoneIds;
+    std::string m_key;
+    std::vector<TraceEvent> m_trace;
+    std::string m_tracePath;
+    int m_summaryEvery;
+    int m_frames;
+    int64_t m_frameStart;
+    uint32_t m_dropped;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::get().setThreadName(name)
+#define PROFILE_FRAME() Profiler::get().endFrame()
+
+#else
+
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <cmath>
+#include "simClock.h"
+
+SimClock::SimClock(float stepHz, int maxSubsteps)
+    : m_step(1.0f / 120.0f), m_maxSubsteps(8), m_timeWarp(1.0f) {
+    setStepRate(stepHz);
+    setMaxSubsteps(maxSubsteps);
+    reset();
+}
+
+int SimClock::advance(double frameTime) {
+    // negative deltas can happen when the timer is reset, ignore them
+    if (frameTime < 0.0) frameTime = 0.0;
+
+    m_accumulator += frameTime * m_timeWarp;
+
+    int steps = 0;
+    while (m_accumulator >= m_step && steps < m_maxSubsteps) {
+        m_accumulator -= m_step;
+        m_simTime += m_step;
+        ++steps;
+    }
+
+    // could not catch up: drop the backlog instead of carrying it over
+    // into the next frame, but keep the fraction for interpolation
+    if (m_accumulator >= m_step) {
+        m_accumulator = std::fmod(m_accumulator, (double)m_step);
+        ++m_droppedFrames;
+    }
+
+    m_stepCount += steps;
+    return steps;
+}
+
+float SimClock::getAlpha() const {
+    return std::min(1.0f, (float)(m_accumulator / m_step));
+}
+
+void SimClock::setStepRate(float hz) {
+    if (hz > 0.0f) m_step = 1.0f / hz;
+}
+
+void SimClock::setMaxSubsteps(int maxSubsteps) {
+    m_maxSubsteps = std::max(1, maxSubsteps);
+}
+
+void SimClock::setTimeWarp(float warp) {
+    m_timeWarp = std::max(0.0f, warp);
+}
+
+void SimClock::reset() {
+    m_accumulator = 0.0;
+    m_simTime = 0.0;
+    m_stepCount = 0;
+    m_droppedFrames = 0;
+}
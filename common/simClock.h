@@ -0,0 +1,55 @@
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+/**
+* Fixed-timestep simulation clock (accumulator pattern).
+* https://gafferongames.com/post/fix_your_timestep/
+*
+* Feed the wall-clock frame time to advance(); it returns how many steps of
+* getStep() seconds the simulation has to run this frame. Whatever is left in
+* the accumulator is exposed as getAlpha() in [0, 1) so the renderer can
+* interpolate between the previous and the current simulation state.
+*/
+class SimClock {
+public:
+    SimClock(float stepHz = 120.0f, int maxSubsteps = 8);
+
+    /* Returns the number of fixed steps to simulate for this frame */
+    int advance(double frameTime);
+
+    float getStep() const { return m_step; }
+    float getAlpha() const;
+
+    double getSimTime() const { return m_simTime; }
+    long long getStepCount() const { return m_stepCount; }
+
+    // configuration
+    void setStepRate(float hz);
+    float getStepRate() const { return 1.0f / m_step; }
+
+    // upper bound of steps per frame (avoids the "spiral of death" when a
+    // frame takes longer than the steps it has to catch up)
+    void setMaxSubsteps(int maxSubsteps);
+    int getMaxSubsteps() const { return m_maxSubsteps; }
+
+    // scales the wall-clock time fed to the accumulator (soak tests)
+    void setTimeWarp(float warp);
+    float getTimeWarp() const { return m_timeWarp; }
+
+    // number of frames where simulation time had to be dropped
+    long long getDroppedFrames() const { return m_droppedFrames; }
+
+    void reset();
+
+private:
+    float m_step;
+    int m_maxSubsteps;
+    float m_timeWarp;
+
+    double m_accumulator;
+    double m_simTime;
+    long long m_stepCount;
+    long long m_droppedFrames;
+};
+
+#endif
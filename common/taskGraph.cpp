@@ -0,0 +1,132 @@
+#include "taskGraph.h"
+#include "profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static double nowMs() {
+    return chrono::duration<double, milli>(Clock::now().time_since_epoch()).count();
+}
+
+TaskGraph::TaskGraph()
+    : m_threads(nullptr), m_running(0), m_runStart(0.0), m_runs(0), m_totalRunTime(0.0) {
+}
+
+TaskGraph::Stage TaskGraph::add(const string& name, const function<void()>& fn,
+    initializer_list<Stage> after) {
+    Stage stage = (Stage)m_stages.size();
+    StageInfo info;
+    info.name = name;
+    info.fn = fn;
+    info.start = info.end = 0.0;
+    info.thread = 0;
+    info.totalStart = info.totalTime = 0.0;
+    for (Stage dependency : after) {
+        if (dependency < 0 || dependency >= stage) {
+            throw runtime_error("Stage " + name + " depends on an unknown stage");
+        }
+        info.after.push_back(dependency);
+        m_stages[dependency].successors.push_back(stage);
+    }
+    m_stages.push_back(info);
+
+    m_pending.reset(new atomic<int>[m_stages.size()]);
+    return stage;
+}
+
+void TaskGraph::runJob(void* data, int begin, int) {
+    static_cast<TaskGraph*>(data)->runStage(begin);
+}
+
+void TaskGraph::runStage(Stage stage) {
+    StageInfo& info = m_stages[stage];
+    info.start = nowMs() - m_runStart;
+    info.thread = m_threads ? m_threads->getCurrentThread() : 0;
+    {
+        PROFILE_ZONE(info.name.c_str());
+        info.fn();
+    }
+    info.end = nowMs() - m_runStart;
+
+    if (!m_threads) return;
+    // the last dependency to finish starts the successor
+    for (Stage next : info.successors) {
+        if (--m_pending[next] == 0) {
+            m_threads->submit(runJob, this, next, next + 1, m_running);
+        }
+    }
+}
+
+void TaskGraph::run(ThreadPool* threads) {
+    m_threads = threads && threads->getThreadCount() > 1 ? threads : nullptr;
+    m_runStart = nowMs();
+
+    if (m_threads) {
+        for (size_t i = 0; i < m_stages.size(); ++i) {
+            m_pending[i] = (int)m_stages[i].after.size();
+        }
+        for (size_t i = 0; i < m_stages.size(); ++i) {
+            if (m_stages[i].after.empty()) {
+                m_threads->submit(runJob, this, (int)i, (int)i + 1, m_running);
+            }
+        }
+        m_threads->wait(m_running);
+    }
+    else {
+        for (size_t i = 0; i < m_stages.size(); ++i) {
+            runStage((Stage)i);
+        }
+    }
+
+    m_totalRunTime += nowMs() - m_runStart;
+    m_runs++;
+    for (StageInfo& info : m_stages) {
+        info.totalStart += info.start;
+        info.totalTime += info.end - info.start;
+    }
+}
+
+void TaskGraph::printTimings(const char* title) const {
+    if (m_runs == 0) return;
+
+    // longest chain of average stage times, stages are in dependency order
+    vector<double> finish(m_stages.size());
+    vector<Stage> previous(m_stages.size(), -1);
+    Stage last = -1;
+    for (size_t i = 0; i < m_stages.size(); ++i) {
+        double ready = 0.0;
+        for (Stage dependency : m_stages[i].after) {
+            if (finish[dependency] > ready) {
+                ready = finish[dependency];
+                previous[i] = dependency;
+            }
+        }
+        finish[i] = ready + m_stages[i].totalTime / m_runs;
+        if (last < 0 || finish[i] > finish[last]) last = (Stage)i;
+    }
+
+    printf("%s: %d runs, %.4f ms per run\n", title, m_runs, m_totalRunTime / m_runs);
+    printf("  %-20s %10s %10s %7s\n", "stage", "start ms", "time ms", "thread");
+    for (const StageInfo& info : m_stages) {
+        printf("  %-20s %10.4f %10.4f %7d\n", info.name.c_str(), info.totalStart / m_runs,
+            info.totalTime / m_runs, info.thread);
+    }
+
+    string path;
+    for (Stage s = last; s >= 0; s = previous[s]) {
+        path = m_stages[s].name + (path.empty() ? "" : " -> ") + path;
+    }
+    printf("  critical path: %s (%.4f ms)\n", path.c_str(), last >= 0 ? finish[last] : 0.0);
+}
+
+void TaskGraph::resetTimings() {
+    m_runs = 0;
+    m_totalRunTime = 0.0;
+    for (StageInfo& info : m_stages) {
+        info.totalStart = info.totalTime = 0.0;
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "threadPool.h"
+
+/**
+* Declarative graph of the stages of a frame (or a simulation step).
+*
+* Stages are added once with the stages they must wait for; a stage can
+* only depend on stages added before it, so the order of add() is always a
+* valid serial order and there are no cycles. run() starts every stage whose
+* dependencies are done on the ThreadPool (each stage counts down its
+* successors' dependency counters) and returns when all are done; without a
+* pool the stages run one after the other in the order they were added.
+*
+* Every run is timed per stage. printTimings() prints the averages since the
+* last print and the critical path, the chain of dependent stages that
+* bounds the step no matter how many threads there are.
+*/
+class TaskGraph {
+public:
+    typedef int Stage;
+
+    TaskGraph();
+
+    /* after: stages that must finish first, returns the new stage */
+    Stage add(const std::string& name, const std::function<void()>& fn,
+        std::initializer_list<Stage> after = {});
+
+    int getStageCount() const { return (int)m_stages.size(); }
+
+    /* runs every stage once, threads may be null */
+    void run(ThreadPool* threads);
+
+    int getRunCount() const { return m_runs; }
+    /* average stage times since the last reset, start/end relative to the
+       start of the run */
+    void printTimings(const char* title) const;
+    void resetTimings();
+
+private:
+    struct StageInfo {
+        std::string name;
+        std::function<void()> fn;
+        std::vector<Stage> after;
+        std::vector<Stage> successors;
+        // last run, in ms from the start of the run
+        double start, end;
+        int thread;
+        // sums since the last reset
+        double totalStart, totalTime;
+    };
+
+    static void runJob(void* data, int begin, int end);
+    void runStage(Stage stage);
+
+    std::vector<StageInfo> m_stages;
+    std::unique_ptr<std::atomic<int>[]> m_pending; // dependencies left, per stage
+
+    // current run
+    ThreadPool* m_threads;
+    ThreadPool::Counter m_running;
+    double m_runStart;
+
+    int m_runs;
+    double m_totalRunTime;
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include "threadPool.h"
+
+using namespace std;
+
+// pool and worker index of the current thread (workers only)
+static thread_local const ThreadPool* t_pool = nullptr;
+static thread_local int t_index = 0;
+
+void ThreadPool::JobQueue::push(const Job& job) {
+    lock_guard<mutex> lock(m_mutex);
+    if (m_size == m_jobs.size()) {
+        vector<Job> jobs(m_jobs.size() * 2);
+        for (size_t i = 0; i < m_size; ++i) {
+            jobs[i] = m_jobs[(m_head + i) % m_jobs.size()];
+        }
+        m_jobs.swap(jobs);
+        m_head = 0;
+    }
+    m_jobs[(m_head + m_size) % m_jobs.size()] = job;
+    m_size++;
+}
+
+bool ThreadPool::JobQueue::popBack(Job& job) {
+    lock_guard<mutex> lock(m_mutex);
+    if (m_size == 0) return false;
+    m_size--;
+    job = m_jobs[(m_head + m_size) % m_jobs.size()];
+    return true;
+}
+
+bool ThreadPool::JobQueue::popFront(Job& job) {
+    lock_guard<mutex> lock(m_mutex);
+    if (m_size == 0) return false;
+    job = m_jobs[m_head];
+    m_head = (m_head + 1) % m_jobs.size();
+    m_size--;
+    return true;
+}
+
+ThreadPool::ThreadPool(int threadCount)
+    : m_queued(0), m_sleeping(0), m_quit(false) {
+    if (threadCount <= 0) {
+        threadCount = max(1, (int)thread::hardware_concurrency());
+    }
+
+    // the calling thread works too; queues first so no worker sees a
+    // half-built list
+    for (int i = 0; i < threadCount; ++i) {
+        m_queues.push_back(unique_ptr<JobQueue>(new JobQueue()));
+    }
+    for (int i = 1; i < threadCount; ++i) {
+        m_workers.push_back(thread(&ThreadPool::workerLoop, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::getCurrentThread() const {
+    return t_pool == this ? t_index : 0;
+}
+
+ThreadPool::JobQueue& ThreadPool::localQueue() {
+    return t_pool == this ? *m_queues[t_index - 1] : *m_queues.back();
+}
+
+bool ThreadPool::findJob(Job& job) {
+    bool found = false;
+    if (t_pool == this) {
+        // newest own job first, its data is still in cache
+        found = m_queues[t_index - 1]->popBack(job) || m_queues.back()->popFront(job);
+    }
+    else {
+        found = m_queues.back()->popFront(job);
+    }
+
+    // steal the oldest job of another worker
+    int workers = (int)m_queues.size() - 1;
+    for (int i = 0; i < workers && !found; ++i) {
+        int victim = (t_index + i) % workers;
+        if (t_pool == this && victim == t_index - 1) continue;
+        found = m_queues[victim]->popFront(job);
+    }
+
+    if (found) {
+        m_queued--;
+    }
+    return found;
+}
+
+void ThreadPool::runJob(const Job& job) {
+    job.fn(job.data, job.begin, job.end);
+    // last touch, the waiter may return right after
+    job.counter->fetch_sub(1);
+}
+
+void ThreadPool::wakeWorkers(int jobs) {
+    int sleeping;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        sleeping = m_sleeping;
+    }
+    if (sleeping == 0) return;
+    if (jobs >= sleeping) {
+        m_wake.notify_all();
+    }
+    else {
+        for (int i = 0; i < jobs; ++i) {
+            m_wake.notify_one();
+        }
+    }
+}
+
+void ThreadPool::submit(JobFunction fn, void* data, int begin, int end, Counter& counter) {
+    counter++;
+    Job job = {fn, data, begin, end, &counter};
+    localQueue().push(job);
+    m_queued++;
+    wakeWorkers(1);
+}
+
+void ThreadPool::wait(Counter& counter) {
+    while (counter.load() > 0) {
+        Job job;
+        if (findJob(job)) {
+            runJob(job);
+        }
+        else {
+            // the rest is running elsewhere
+            this_thread::yield();
+        }
+    }
+}
+
+static void runRange(void* data, int begin, int end) {
+    (*(const function<void(int, int)>*)data)(begin, end);
+}
+
+void ThreadPool::parallelFor(int count, int minChunk,
+    const function<void(int, int)>& fn) {
+    if (count <= 0) return;
+    minChunk = max(1, minChunk);
+
+    // not worth waking anybody up
+    if (m_queues.size() == 1 || count <= minChunk) {
+        fn(0, count);
+        return;
+    }
+
+    // a few chunks per thread so uneven chunks balance out
+    int threads = getThreadCount();
+    int chunkSize = max(minChunk, (count + threads * 4 - 1) / (threads * 4));
+
+    // queue all chunks but the first, which runs here right away
+    Counter counter(0);
+    JobQueue& queue = localQueue();
+    int chunks = 0;
+    for (int begin = chunkSize; begin < count; begin += chunkSize) {
+        Job job = {runRange, (void*)&fn, begin, min(count, begin + chunkSize), &counter};
+        counter++;
+        queue.push(job);
+        chunks++;
+    }
+    m_queued += chunks;
+    wakeWorkers(chunks);
+
+    fn(0, min(count, chunkSize));
+    wait(counter);
+}
+
+void ThreadPool::workerLoop(int index) {
+    t_pool = this;
+    t_index = index;
+    for (;;) {
+        Job job;
+        if (findJob(job)) {
+            runJob(job);
+            continue;
+        }
+
+        unique_lock<mutex> lock(m_mutex);
+        m_sleeping++;
+        m_wake.wait(lock, [this] { return m_quit || m_queued.load() > 0; });
+        m_sleeping--;
+        if (m_quit) return;
+    }
+}
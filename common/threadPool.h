@@ -0,0 +1,93 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+* Work-stealing job system.
+*
+* Every worker owns a deque of jobs: it pushes and pops its own jobs at the
+* back and, when that runs dry, steals from the front of the others'. Threads
+* outside the pool queue their jobs in a shared injection queue. A job is a
+* plain function pointer with a data pointer and an index range, so queueing
+* does not allocate once the deques have grown.
+*
+* Jobs count down a Counter when they finish; wait() runs queued jobs (any,
+* not only those of the counter) until the counter reaches 0, so a job may
+* itself submit and wait without blocking a worker. parallelFor() is built on
+* that and can be called from any thread, also from inside a job.
+*/
+class ThreadPool {
+public:
+    /* unfinished jobs, see submit() and wait() */
+    typedef std::atomic<int> Counter;
+    typedef void (*JobFunction)(void* data, int begin, int end);
+
+    /* threadCount counts the caller too, 0 = one per hardware thread */
+    ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    int getThreadCount() const { return (int)m_queues.size(); }
+    /* 1.. for the workers, 0 for any other thread */
+    int getCurrentThread() const;
+
+    /* fn(begin, end) is called for disjoint ranges of at least minChunk items */
+    void parallelFor(int count, int minChunk,
+        const std::function<void(int, int)>& fn);
+
+    /* queues fn(data, begin, end); counter goes up now and down once it ran */
+    void submit(JobFunction fn, void* data, int begin, int end, Counter& counter);
+    /* runs queued jobs until counter is 0 */
+    void wait(Counter& counter);
+
+private:
+    struct Job {
+        JobFunction fn;
+        void* data;
+        int begin;
+        int end;
+        Counter* counter;
+    };
+
+    /* ring buffer, grows when full; the owner takes from the back, thieves
+       from the front */
+    class JobQueue {
+    public:
+        JobQueue() : m_head(0), m_size(0), m_jobs(64) {}
+        void push(const Job& job);
+        bool popBack(Job& job);
+        bool popFront(Job& job);
+
+    private:
+        std::mutex m_mutex;
+        size_t m_head;
+        size_t m_size;
+        std::vector<Job> m_jobs;
+    };
+
+    void workerLoop(int index);
+    /* queue of the calling thread */
+    JobQueue& localQueue();
+    /* own queue first, then the injection queue, then the other workers' */
+    bool findJob(Job& job);
+    void runJob(const Job& job);
+    void wakeWorkers(int jobs);
+
+    std::vector<std::thread> m_workers;
+    // one per worker, the last one is the injection queue
+    std::vector<std::unique_ptr<JobQueue> > m_queues;
+
+    std::atomic<int> m_queued;   // jobs in all queues
+    std::mutex m_mutex;          // sleeping workers
+    std::condition_variable m_wake;
+    int m_sleeping;              // guarded by m_mutex
+    bool m_quit;                 // guarded by m_mutex
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include "birdAnimation.h"
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <common/meshCache.h>
+#include <common/meshOptimizer.h>
+#include <common/model.h>
+
+using namespace glm;
+using namespace std;
+
+// arrays of a cache entry
+enum { COUNTS, UVS, INDICES, POSITIONS, NORMALS, ANIMATION_ARRAYS };
+
+void BirdAnimation::load(const vector<string>& paths, MeshCache* cache) {
+    string key = "gen:birdAnimation";
+    for (const string& path : paths) {
+        key += "|" + MeshCache::fileKey(path);
+    }
+
+    MeshCache::Entry entry;
+    if (cache && cache->read(key, entry) && entry.arrayCount() == ANIMATION_ARRAYS &&
+        entry.count<int>(COUNTS) == 2) {
+        const int* counts = entry.array<int>(COUNTS);
+        size_t values = (size_t)counts[0] * counts[1];
+        if (entry.count<vec2>(UVS) == (size_t)counts[0] &&
+            entry.count<vec3>(POSITIONS) == values && entry.count<vec3>(NORMALS) == values) {
+            vertexCount = counts[0];
+            frameCount = counts[1];
+            const vec2* u = entry.array<vec2>(UVS);
+            const unsigned int* i = entry.array<unsigned int>(INDICES);
+            const vec3* p = entry.array<vec3>(POSITIONS);
+            const vec3* n = entry.array<vec3>(NORMALS);
+            uvs.assign(u, u + vertexCount);
+            indices.assign(i, i + entry.count<unsigned int>(INDICES));
+            positions.assign(p, p + values);
+            normals.assign(n, n + values);
+            return;
+        }
+    }
+
+    vector<vector<vec3>> framePositions(paths.size()), frameNormals(paths.size());
+    vector<vec2> soupUVs;
+    for (size_t f = 0; f < paths.size(); ++f) {
+        vector<vec2> frameUVs;
+        loadMesh(paths[f], framePositions[f], frameUVs, frameNormals[f]);
+        if (f == 0) soupUVs.swap(frameUVs);
+    }
+    bake(framePositions, frameNormals, soupUVs);
+
+    if (cache) {
+        int counts[2] = {vertexCount, frameCount};
+        MeshCache::Array arrays[ANIMATION_ARRAYS] = {
+            {counts, sizeof(counts)},
+            {uvs.data(), uvs.size() * sizeof(vec2)},
+            {indices.data(), indices.size() * sizeof(unsigned int)},
+            {positions.data(), positions.size() * sizeof(vec3)},
+            {normals.data(), normals.size() * sizeof(vec3)}
+        };
+        cache->write(key, arrays, ANIMATION_ARRAYS);
+    }
+}
+
+void BirdAnimation::bake(const vector<vector<vec3>>& framePositions,
+    const vector<vector<vec3>>& frameNormals, const vector<vec2>& soupUVs) {
+    frameCount = (int)framePositions.size();
+    size_t corners = frameCount > 0 ? framePositions[0].size() : 0;
+    for (int f = 0; f < frameCount; ++f) {
+        if (framePositions[f].size() != corners ||
+            (!frameNormals[f].empty() && frameNormals[f].size() != corners)) {
+            throw runtime_error("Bird frames do not share their triangles");
+        }
+    }
+    bool hasUVs = soupUVs.size() == corners;
+
+    // corner attributes of every frame, a normal missing in the file is the
+    // face normal
+    auto normalOf = [&](int f, size_t c) {
+        if (!frameNormals[f].empty()) return frameNormals[f][c];
+        const vec3* t = &framePositions[f][c - c % 3];
+        return normalize(cross(t[1] - t[0], t[2] - t[0]));
+    };
+
+    // corners are the same vertex when they agree in every frame
+    vector<unsigned int> soupIndices(corners);
+    vector<size_t> firstCorner;
+    unordered_map<string, unsigned int> vertexOf;
+    string key;
+    for (size_t c = 0; c < corners; ++c) {
+        key.clear();
+        if (hasUVs) key.append((const char*)&soupUVs[c], sizeof(vec2));
+        for (int f = 0; f < frameCount; ++f) {
+            vec3 n = normalOf(f, c);
+            key.append((const char*)&framePositions[f][c], sizeof(vec3));
+            key.append((const char*)&n, sizeof(vec3));
+        }
+        auto inserted = vertexOf.insert(make_pair(key, (unsigned int)firstCorner.size()));
+        if (inserted.second) firstCorner.push_back(c);
+        soupIndices[c] = inserted.first->second;
+    }
+    vertexCount = (int)firstCorner.size();
+
+    // same ordering as indexVBO
+    optimizeVertexCache(soupIndices, vertexCount);
+    vector<unsigned int> remap = optimizeVertexFetch(soupIndices, vertexCount);
+    indices.swap(soupIndices);
+
+    uvs.assign(vertexCount, vec2(0.0f));
+    positions.resize((size_t)vertexCount * frameCount);
+    normals.resize((size_t)vertexCount * frameCount);
+    for (int v = 0; v < vertexCount; ++v) {
+        size_t c = firstCorner[v];
+        int out = (int)remap[v];
+        if (hasUVs) uvs[out] = soupUVs[c];
+        for (int f = 0; f < frameCount; ++f) {
+            positions[(size_t)f * vertexCount + out] = framePositions[f][c];
+            normals[(size_t)f * vertexCount + out] = normalOf(f, c);
+        }
+    }
+}
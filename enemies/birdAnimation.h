@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+class MeshCache;
+
+// The flap frames of the bird baked into one mesh: the frames are the same
+// triangles in the same order, only positions and normals move, so they
+// share uvs and indices and keep a position and a normal per vertex and
+// frame (frame * vertexCount + vertex). BirdRenderer puts those into the
+// animation texture. No GL calls, the bake runs on an AssetLoader worker.
+struct BirdAnimation {
+    int vertexCount = 0;
+    int frameCount = 0;
+    std::vector<glm::vec2> uvs;
+    std::vector<unsigned int> indices;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+
+    // loads the frame files (.obj / .vtp) and bakes them, through the cache
+    // when one is given; throws when the frames do not share their triangles
+    void load(const std::vector<std::string>& paths, MeshCache* cache = nullptr);
+
+    // frames as triangle soups (every corner of every triangle)
+    void bake(const std::vector<std::vector<glm::vec3>>& framePositions,
+        const std::vector<std::vector<glm::vec3>>& frameNormals,
+        const std::vector<glm::vec2>& soupUVs);
+};
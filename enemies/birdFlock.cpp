@@ -0,0 +1,279 @@
+#include "birdFlock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <common/profiler.h>
+#include <common/threadPool.h>
+
+using namespace glm;
+using namespace std;
+
+// orbit steering: horizontal and vertical speed per unit off the orbit
+static const float ORBIT_GAIN = 0.5f;
+static const float HEIGHT_GAIN = 1.0f;
+
+// below this many birds the kernels are not worth splitting
+static const int MIN_CHUNK = 256;
+
+static const float PI = 3.14159265f;
+static const float TWO_PI = 6.28318531f;
+
+BirdFlock::BirdFlock(const FlockParams& params)
+    : m_params(params), m_threads(nullptr), m_target(0.0f), m_bucketMask(0) {
+}
+
+void BirdFlock::reserve(size_t count) {
+    m_posX.reserve(count); m_posY.reserve(count); m_posZ.reserve(count);
+    m_velX.reserve(count); m_velY.reserve(count); m_velZ.reserve(count);
+    m_newVelX.reserve(count); m_newVelY.reserve(count); m_newVelZ.reserve(count);
+    m_orbitRadius.reserve(count);
+    m_heightOffset.reserve(count);
+    m_animTime.reserve(count);
+    m_prevAnimTime.reserve(count);
+    m_heading.reserve(count);
+    m_prevHeading.reserve(count);
+    m_prevPosition.reserve(count);
+}
+
+void BirdFlock::clear() {
+    m_posX.clear(); m_posY.clear(); m_posZ.clear();
+    m_velX.clear(); m_velY.clear(); m_velZ.clear();
+    m_newVelX.clear(); m_newVelY.clear(); m_newVelZ.clear();
+    m_orbitRadius.clear();
+    m_heightOffset.clear();
+    m_animTime.clear();
+    m_prevAnimTime.clear();
+    m_heading.clear();
+    m_prevHeading.clear();
+    m_prevPosition.clear();
+}
+
+int BirdFlock::add(const vec3& position, const vec3& velocity, float orbitRadius,
+    float heightOffset, float animPhase) {
+    float heading = atan2(velocity.x, velocity.z);
+
+    m_posX.push_back(position.x); m_posY.push_back(position.y); m_posZ.push_back(position.z);
+    m_velX.push_back(velocity.x); m_velY.push_back(velocity.y); m_velZ.push_back(velocity.z);
+    m_newVelX.push_back(velocity.x); m_newVelY.push_back(velocity.y); m_newVelZ.push_back(velocity.z);
+    m_orbitRadius.push_back(orbitRadius);
+    m_heightOffset.push_back(heightOffset);
+    m_animTime.push_back(animPhase);
+    m_prevAnimTime.push_back(animPhase);
+    m_heading.push_back(heading);
+    m_prevHeading.push_back(heading);
+    m_prevPosition.push_back(position);
+
+    return (int)m_posX.size() - 1;
+}
+
+void BirdFlock::storePreviousState() {
+    for (size_t i = 0; i < m_posX.size(); ++i) {
+        m_prevPosition[i] = vec3(m_posX[i], m_posY[i], m_posZ[i]);
+    }
+    m_prevHeading = m_heading;
+    m_prevAnimTime = m_animTime;
+}
+
+int BirdFlock::bucketOf(int cx, int cy, int cz) const {
+    unsigned int h = (unsigned int)cx * 73856093u ^ (unsigned int)cy * 19349663u ^
+        (unsigned int)cz * 83492791u;
+    return (int)(h & (unsigned int)m_bucketMask);
+}
+
+void BirdFlock::buildGrid() {
+    int count = (int)size();
+
+    // about two buckets per bird keeps unrelated cells apart
+    int buckets = 16;
+    while (buckets < 2 * count) buckets *= 2;
+    m_bucketMask = buckets - 1;
+
+    float inv = 1.0f / m_params.neighbourRadius;
+    m_bucket.resize(count);
+    m_bucketStart.assign(buckets + 1, 0);
+    for (int i = 0; i < count; ++i) {
+        int b = bucketOf((int)floor(m_posX[i] * inv), (int)floor(m_posY[i] * inv),
+            (int)floor(m_posZ[i] * inv));
+        m_bucket[i] = b;
+        m_bucketStart[b + 1]++;
+    }
+    for (int b = 0; b < buckets; ++b) {
+        m_bucketStart[b + 1] += m_bucketStart[b];
+    }
+
+    // stable scatter: a bucket lists its birds by increasing index
+    m_order.resize(count);
+    m_cursor.assign(m_bucketStart.begin(), m_bucketStart.end() - 1);
+    for (int i = 0; i < count; ++i) {
+        m_order[m_cursor[m_bucket[i]]++] = i;
+    }
+
+    m_sortedX.resize(count); m_sortedY.resize(count); m_sortedZ.resize(count);
+    m_sortedVX.resize(count); m_sortedVY.resize(count); m_sortedVZ.resize(count);
+    for (int s = 0; s < count; ++s) {
+        int i = m_order[s];
+        m_sortedX[s] = m_posX[i]; m_sortedY[s] = m_posY[i]; m_sortedZ[s] = m_posZ[i];
+        m_sortedVX[s] = m_velX[i]; m_sortedVY[s] = m_velY[i]; m_sortedVZ[s] = m_velZ[i];
+    }
+}
+
+// boids rules on the sorted copies, new velocity of bird m_order[s]
+void BirdFlock::steerRange(int begin, int end, float dt) {
+    const FlockParams& p = m_params;
+    const float* sx = m_sortedX.data();
+    const float* sy = m_sortedY.data();
+    const float* sz = m_sortedZ.data();
+    const float* svx = m_sortedVX.data();
+    const float* svy = m_sortedVY.data();
+    const float* svz = m_sortedVZ.data();
+    const int* start = m_bucketStart.data();
+
+    float inv = 1.0f / p.neighbourRadius;
+    float neighbourRadius2 = p.neighbourRadius * p.neighbourRadius;
+    float separationRadius2 = p.separationRadius * p.separationRadius;
+
+    for (int s = begin; s < end; ++s) {
+        int i = m_order[s];
+        vec3 pos(sx[s], sy[s], sz[s]);
+        vec3 vel(svx[s], svy[s], svz[s]);
+
+        // neighbours in the 27 cells around, a bucket shared by two of them
+        // (hash collision) is scanned once
+        vec3 separation(0.0f), velocitySum(0.0f), offsetSum(0.0f);
+        int neighbours = 0;
+        int seen[27];
+        int seenCount = 0;
+        int cx = (int)floor(pos.x * inv);
+        int cy = (int)floor(pos.y * inv);
+        int cz = (int)floor(pos.z * inv);
+        for (int dz = -1; dz <= 1 && neighbours < p.maxNeighbours; ++dz) {
+            for (int dy = -1; dy <= 1 && neighbours < p.maxNeighbours; ++dy) {
+                for (int dx = -1; dx <= 1 && neighbours < p.maxNeighbours; ++dx) {
+                    int b = bucketOf(cx + dx, cy + dy, cz + dz);
+                    if (find(seen, seen + seenCount, b) != seen + seenCount) continue;
+                    seen[seenCount++] = b;
+
+                    for (int k = start[b]; k < start[b + 1]; ++k) {
+                        if (k == s) continue;
+                        float ox = sx[k] - pos.x;
+                        float oy = sy[k] - pos.y;
+                        float oz = sz[k] - pos.z;
+                        float d2 = ox * ox + oy * oy + oz * oz;
+                        if (d2 > neighbourRadius2) continue;
+
+                        velocitySum += vec3(svx[k], svy[k], svz[k]);
+                        offsetSum += vec3(ox, oy, oz);
+                        // away from close birds, harder the closer they are
+                        if (d2 < separationRadius2 && d2 > 1e-6f) {
+                            separation -= vec3(ox, oy, oz) / d2;
+                        }
+                        if (++neighbours == p.maxNeighbours) break;
+                    }
+                }
+            }
+        }
+
+        vec3 acceleration(0.0f);
+        if (neighbours > 0) {
+            float invCount = 1.0f / neighbours;
+            acceleration += p.separationWeight * separation;
+            acceleration += p.alignmentWeight * (velocitySum * invCount - vel);
+            acceleration += p.cohesionWeight * (offsetSum * invCount);
+        }
+
+        // circle the target at the bird's own radius and height
+        vec3 desired;
+        vec3 offset = pos - m_target;
+        float rho = sqrt(offset.x * offset.x + offset.z * offset.z);
+        if (rho > 1e-3f) {
+            vec3 radial = vec3(offset.x, 0.0f, offset.z) / rho;
+            vec3 tangent = vec3(-radial.z, 0.0f, radial.x);
+            float pull = clamp((m_orbitRadius[i] - rho) * ORBIT_GAIN, -p.cruiseSpeed,
+                p.cruiseSpeed);
+            desired = tangent * p.cruiseSpeed + radial * pull;
+        }
+        else {
+            desired = vec3(p.cruiseSpeed, 0.0f, 0.0f);
+        }
+        float climb = (m_target.y + m_heightOffset[i] - pos.y) * HEIGHT_GAIN;
+        desired.y = clamp(climb, -0.5f * p.cruiseSpeed, 0.5f * p.cruiseSpeed);
+        acceleration += p.targetWeight * (desired - vel);
+
+        float a = length(acceleration);
+        if (a > p.maxAcceleration) {
+            acceleration *= p.maxAcceleration / a;
+        }
+
+        vec3 newVel = vel + acceleration * dt;
+        float speed = length(newVel);
+        if (speed > p.maxSpeed) {
+            newVel *= p.maxSpeed / speed;
+        }
+        else if (speed < p.minSpeed) {
+            newVel = speed > 1e-6f ? newVel * (p.minSpeed / speed) : desired;
+        }
+
+        m_newVelX[i] = newVel.x;
+        m_newVelY[i] = newVel.y;
+        m_newVelZ[i] = newVel.z;
+    }
+}
+
+void BirdFlock::integrateRange(int begin, int end, float dt) {
+    for (int i = begin; i < end; ++i) {
+        m_velX[i] = m_newVelX[i];
+        m_velY[i] = m_newVelY[i];
+        m_velZ[i] = m_newVelZ[i];
+        m_posX[i] += m_velX[i] * dt;
+        m_posY[i] += m_velY[i] * dt;
+        m_posZ[i] += m_velZ[i] * dt;
+        m_heading[i] = atan2(m_velX[i], m_velZ[i]);
+        m_animTime[i] += dt;
+    }
+}
+
+void BirdFlock::update(float dt) {
+    PROFILE_ZONE("BirdFlock::update");
+    if (empty()) return;
+
+    buildGrid();
+
+    int count = (int)size();
+    if (m_threads) {
+        m_threads->parallelFor(count, MIN_CHUNK, [this, dt](int begin, int end) {
+            steerRange(begin, end, dt);
+        });
+        m_threads->parallelFor(count, MIN_CHUNK, [this, dt](int begin, int end) {
+            integrateRange(begin, end, dt);
+        });
+    }
+    else {
+        steerRange(0, count, dt);
+        integrateRange(0, count, dt);
+    }
+}
+
+vec3 BirdFlock::getRenderPosition(int i, float alpha) const {
+    return mix(m_prevPosition[i], vec3(m_posX[i], m_posY[i], m_posZ[i]), alpha);
+}
+
+float BirdFlock::getRenderHeading(int i, float alpha) const {
+    // the heading wraps around at +-pi, interpolate along the shortest way
+    float delta = m_heading[i] - m_prevHeading[i];
+    if (delta > PI) delta -= TWO_PI;
+    else if (delta < -PI) delta += TWO_PI;
+    return m_prevHeading[i] + delta * alpha;
+}
+
+float BirdFlock::getRenderFrame(int i, float alpha) const {
+    return mix(m_prevAnimTime[i], m_animTime[i], alpha) * m_params.flapRate;
+}
+
+void BirdFlock::writeRenderStates(vector<BirdRenderState>& out, float alpha) const {
+    out.resize(size());
+    for (int i = 0; i < (int)size(); ++i) {
+        out[i].position = getRenderPosition(i, alpha);
+        out[i].heading = getRenderHeading(i, alpha);
+        out[i].frame = getRenderFrame(i, alpha);
+    }
+}
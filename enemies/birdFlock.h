@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+class ThreadPool;
+
+// a bird as BirdRenderer draws it
+struct BirdRenderState {
+    glm::vec3 position;
+    float heading;  // rotation about y
+    float frame;    // animation time in frames, not wrapped
+};
+
+// steering constants, the defaults are the game's birds
+struct FlockParams {
+    float neighbourRadius = 6.0f;   // alignment and cohesion range, grid cell size
+    float separationRadius = 2.5f;
+    int maxNeighbours = 16;         // scan stops after this many
+    float separationWeight = 30.0f;
+    float alignmentWeight = 1.0f;
+    float cohesionWeight = 0.4f;
+    float targetWeight = 2.0f;
+    float cruiseSpeed = 20.0f;
+    float minSpeed = 8.0f;
+    float maxSpeed = 30.0f;
+    float maxAcceleration = 40.0f;
+    float collisionRadius = 2.0f;
+    float scale = 1.5f;
+    float flapRate = 12.0f;         // animation frames per second
+};
+
+// All the enemy birds as one boids flock, in structure-of-arrays form.
+// Birds are addressed by index. Every step each bird steers by separation,
+// alignment and cohesion with its neighbours plus a pull towards the target
+// (the house's balloon cluster), around which it circles at its own radius
+// and height. Neighbours come from a uniform grid rebuilt every step with a
+// counting sort: the cells are hashed into a table of about two buckets per
+// bird, and positions / velocities are copied out in bucket order so a
+// neighbour scan reads contiguous memory. The steering kernel writes new
+// velocities into a separate array, so it can be split across a ThreadPool
+// and the result does not depend on the thread count.
+class BirdFlock {
+public:
+    BirdFlock(const FlockParams& params = FlockParams());
+
+    void reserve(size_t count);
+    void clear();
+
+    // new bird at position with velocity; it circles the target at
+    // orbitRadius, heightOffset above it. Returns its index.
+    int add(const glm::vec3& position, const glm::vec3& velocity, float orbitRadius,
+        float heightOffset, float animPhase = 0.0f);
+
+    size_t size() const { return m_posX.size(); }
+    bool empty() const { return m_posX.empty(); }
+
+    const FlockParams& getParams() const { return m_params; }
+    void setTarget(const glm::vec3& target) { m_target = target; }
+    glm::vec3 getTarget() const { return m_target; }
+
+    // split the steering kernel across this pool (null = single threaded)
+    void setThreadPool(ThreadPool* threads) { m_threads = threads; }
+
+    // snapshot before a fixed step, used for render interpolation
+    void storePreviousState();
+    // rebuild the grid, steer and move every bird
+    void update(float dt);
+
+    // per bird state (collisions)
+    glm::vec3 getPosition(int i) const { return glm::vec3(m_posX[i], m_posY[i], m_posZ[i]); }
+    glm::vec3 getVelocity(int i) const { return glm::vec3(m_velX[i], m_velY[i], m_velZ[i]); }
+    float getCollisionRadius(int) const { return m_params.collisionRadius; }
+
+    // render state between the last two steps (alpha 0 = previous, 1 = current)
+    glm::vec3 getRenderPosition(int i, float alpha) const;
+    // rotation about y that faces the direction of travel
+    float getRenderHeading(int i, float alpha) const;
+    // animation time in frames, not wrapped to the frame count
+    float getRenderFrame(int i, float alpha) const;
+    float getScale() const { return m_params.scale; }
+    // all of the above for every bird; out keeps its storage
+    void writeRenderStates(std::vector<BirdRenderState>& out, float alpha) const;
+
+private:
+    void buildGrid();
+    int bucketOf(int cx, int cy, int cz) const;
+    // kernels on [begin, end) of the grid order
+    void steerRange(int begin, int end, float dt);
+    void integrateRange(int begin, int end, float dt);
+
+    FlockParams m_params;
+    ThreadPool* m_threads;
+    glm::vec3 m_target;
+
+    // hot: one array per component
+    std::vector<float> m_posX, m_posY, m_posZ;
+    std::vector<float> m_velX, m_velY, m_velZ;
+    std::vector<float> m_newVelX, m_newVelY, m_newVelZ;
+
+    // per bird constants
+    std::vector<float> m_orbitRadius;
+    std::vector<float> m_heightOffset;
+
+    // animation and render interpolation
+    std::vector<float> m_animTime;
+    std::vector<float> m_prevAnimTime;
+    std::vector<float> m_heading;
+    std::vector<float> m_prevHeading;
+    std::vector<glm::vec3> m_prevPosition;
+
+    // grid: birds sorted by bucket, bucket b holds m_order[m_bucketStart[b]
+    // .. m_bucketStart[b + 1]), the sorted copies follow the same order
+    int m_bucketMask;
+    std::vector<int> m_bucketStart;
+    std::vector<int> m_bucket;  // per bird
+    std::vector<int> m_order;
+    std::vector<int> m_cursor;  // per bucket, scratch for the scatter
+    std::vector<float> m_sortedX, m_sortedY, m_sortedZ;
+    std::vector<float> m_sortedVX, m_sortedVY, m_sortedVZ;
+};
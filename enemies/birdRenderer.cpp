@@ -0,0 +1,161 @@
+#include "birdRenderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+using namespace glm;
+using namespace std;
+
+BirdRenderer::BirdRenderer()
+    : m_VAO(0), m_uvVBO(0), m_EBO(0), m_instanceVBO(0), m_texture(0), m_vertexCount(0),
+    m_frameCount(0), m_indexCount(0), m_indexType(GL_UNSIGNED_SHORT), m_capacity(64),
+    m_gpuBytes(0) {
+    glGenVertexArrays(1, &m_VAO);
+    glBindVertexArray(m_VAO);
+
+    glGenBuffers(1, &m_instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(Instance), NULL, GL_STREAM_DRAW);
+    glVertexAttribPointer(TRANSFORM_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+        (const void*)offsetof(Instance, transform));
+    glVertexAttribPointer(ANIMATION_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+        (const void*)offsetof(Instance, animation));
+    glEnableVertexAttribArray(TRANSFORM_LOCATION);
+    glEnableVertexAttribArray(ANIMATION_LOCATION);
+    glVertexAttribDivisor(TRANSFORM_LOCATION, 1);
+    glVertexAttribDivisor(ANIMATION_LOCATION, 1);
+
+    glBindVertexArray(0);
+}
+
+BirdRenderer::~BirdRenderer() {
+    glDeleteBuffers(1, &m_uvVBO);
+    glDeleteBuffers(1, &m_EBO);
+    glDeleteBuffers(1, &m_instanceVBO);
+    glDeleteVertexArrays(1, &m_VAO);
+    glDeleteTextures(1, &m_texture);
+}
+
+void BirdRenderer::upload(const BirdAnimation& animation) {
+    m_vertexCount = animation.vertexCount;
+    m_frameCount = animation.frameCount;
+    m_indexCount = (int)animation.indices.size();
+    m_gpuBytes = 0;
+
+    glBindVertexArray(m_VAO);
+
+    // the positions come from the texture, the uvs are the only vertex array
+    glDeleteBuffers(1, &m_uvVBO);
+    glGenBuffers(1, &m_uvVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_uvVBO);
+    glBufferData(GL_ARRAY_BUFFER, animation.uvs.size() * sizeof(vec2), animation.uvs.data(),
+        GL_STATIC_DRAW);
+    m_gpuBytes += animation.uvs.size() * sizeof(vec2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+    glEnableVertexAttribArray(2);
+
+    glDeleteBuffers(1, &m_EBO);
+    glGenBuffers(1, &m_EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    if (m_vertexCount <= 65536) {
+        vector<GLushort> indices(animation.indices.begin(), animation.indices.end());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort),
+            indices.data(), GL_STATIC_DRAW);
+        m_gpuBytes += indices.size() * sizeof(GLushort);
+        m_indexType = GL_UNSIGNED_SHORT;
+    }
+    else {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indexCount * sizeof(unsigned int),
+            animation.indices.data(), GL_STATIC_DRAW);
+        m_gpuBytes += m_indexCount * sizeof(unsigned int);
+        m_indexType = GL_UNSIGNED_INT;
+    }
+
+    glBindVertexArray(0);
+
+    // texel (frame * vertexCount + vertex) * 2: position, + 1: normal,
+    // row after row
+    int texels = m_vertexCount * m_frameCount * 2;
+    int rows = (texels + TEXTURE_WIDTH - 1) / TEXTURE_WIDTH;
+    vector<vec4> data((size_t)rows * TEXTURE_WIDTH, vec4(0.0f));
+    for (size_t v = 0; v < animation.positions.size(); ++v) {
+        data[v * 2] = vec4(animation.positions[v], 1.0f);
+        data[v * 2 + 1] = vec4(animation.normals[v], 0.0f);
+    }
+
+    glDeleteTextures(1, &m_texture);
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, TEXTURE_WIDTH, rows, 0, GL_RGBA, GL_FLOAT,
+        data.data());
+    m_gpuBytes += data.size() * 4 * sizeof(GLushort);
+    // texelFetch only
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    printf("Bird animation: %d vertices, %d frames, %.1f KB GPU\n", m_vertexCount,
+        m_frameCount, m_gpuBytes / 1024.0);
+}
+
+void BirdRenderer::attachProgram(GLuint program) {
+    glUseProgram(program);
+
+    ProgramUniforms uniforms;
+    uniforms.program = program;
+    uniforms.useBirdAnimation = glGetUniformLocation(program, "useBirdAnimation");
+    uniforms.layout = glGetUniformLocation(program, "birdAnimationLayout");
+    m_programs.push_back(uniforms);
+
+    glUniform1i(glGetUniformLocation(program, "birdAnimation"), ANIMATION_UNIT);
+    glUniform1i(uniforms.useBirdAnimation, 0);
+}
+
+void BirdRenderer::update(const vector<BirdRenderState>& birds, float scale) {
+    m_instances.resize(birds.size());
+    for (size_t i = 0; i < birds.size(); ++i) {
+        const BirdRenderState& bird = birds[i];
+        // the first frame of the pair is the one a bird used to show alone
+        float frame = std::max(0.0f, bird.frame);
+        float first = 0.0f, blend = 0.0f;
+        if (m_frameCount > 0) {
+            frame = fmod(frame, (float)m_frameCount);
+            first = floor(frame);
+            blend = frame - first;
+        }
+        float second = m_frameCount > 0 ? fmod(first + 1.0f, (float)m_frameCount) : 0.0f;
+
+        Instance& instance = m_instances[i];
+        instance.transform = vec4(bird.position, scale);
+        instance.animation = vec4(bird.heading, first, second, blend);
+    }
+    if (m_instances.empty()) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    while (m_capacity < m_instances.size()) m_capacity *= 2;
+    // orphan the old storage so the driver does not wait for last frame's draws
+    glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(Instance), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, m_instances.size() * sizeof(Instance),
+        &m_instances[0]);
+}
+
+void BirdRenderer::draw(GLuint program) {
+    const ProgramUniforms* uniforms = nullptr;
+    for (size_t i = 0; i < m_programs.size(); ++i) {
+        if (m_programs[i].program == program) uniforms = &m_programs[i];
+    }
+    if (!uniforms || m_indexCount == 0 || m_instances.empty()) return;
+
+    glUniform1i(uniforms->useBirdAnimation, 1);
+    glUniform2i(uniforms->layout, m_vertexCount, TEXTURE_WIDTH);
+    glActiveTexture(GL_TEXTURE0 + ANIMATION_UNIT);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+
+    glBindVertexArray(m_VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, m_indexCount, m_indexType, NULL,
+        (GLsizei)m_instances.size());
+    glBindVertexArray(0);
+
+    glUniform1i(uniforms->useBirdAnimation, 0);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "birdFlock.h"
+#include "birdAnimation.h"
+
+// Draws every bird with one instanced call.
+// The flap frames are a BirdAnimation: one index buffer and uv buffer shared
+// by all frames, the positions and normals of every frame in a half float
+// texture that the vertex shader reads with gl_VertexID. Every instance
+// carries its transform and animation phase (the two frames around it
+// and the blend between them), so the flap is smooth and the cost of a frame
+// does not grow with the flock.
+// The shaders take this path when useBirdAnimation is 1; the renderer sets
+// the flag and its other uniforms itself. Nothing is drawn before upload().
+class BirdRenderer {
+public:
+    // instance attribute locations (the balloon instance slots)
+    static const GLuint TRANSFORM_LOCATION = 3;
+    static const GLuint ANIMATION_LOCATION = 4;
+    // texture unit of the animation texture (after the terrain heightmap)
+    static const int ANIMATION_UNIT = 5;
+    // texels per row of the animation texture
+    static const int TEXTURE_WIDTH = 1024;
+
+    struct Instance {
+        glm::vec4 transform; // xyz: position, w: scale
+        glm::vec4 animation; // x: heading, y, z: frames, w: blend
+    };
+
+    BirdRenderer();
+    ~BirdRenderer();
+
+    BirdRenderer(const BirdRenderer&) = delete;
+    BirdRenderer& operator=(const BirdRenderer&) = delete;
+
+    // mesh and animation texture of the baked frames
+    void upload(const BirdAnimation& animation);
+
+    // looks up the bird uniforms of a program and sets the constant ones
+    // (changes the current program)
+    void attachProgram(GLuint program);
+
+    // rebuild and upload the instance buffer from BirdFlock::writeRenderStates,
+    // once per frame for both passes
+    void update(const std::vector<BirdRenderState>& birds, float scale);
+
+    // all birds; program must be current and attached, material set by the
+    // caller
+    void draw(GLuint program);
+
+    int getInstanceCount() const { return (int)m_instances.size(); }
+    size_t getGPUBytes() const { return m_gpuBytes; }
+
+private:
+    struct ProgramUniforms {
+        GLuint program;
+        GLint useBirdAnimation;
+        GLint layout;
+    };
+
+    std::vector<ProgramUniforms> m_programs;
+
+    GLuint m_VAO;
+    GLuint m_uvVBO;
+    GLuint m_EBO;
+    GLuint m_instanceVBO;
+    GLuint m_texture;
+    int m_vertexCount;
+    int m_frameCount;
+    int m_indexCount;
+    GLenum m_indexType;
+    size_t m_capacity;  // instances the GPU buffer can hold
+    size_t m_gpuBytes;  // mesh and texture
+
+    std::vector<Instance> m_instances;
+};
@@ -1,8 +1,9 @@
 #include "house.h"
-#include "balloons/balloon.h"
+#include "balloons/balloonPool.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/vector_angle.hpp>
 #include <iostream>
+#include <common/profiler.h>
 
 using namespace glm;
 
@@ -11,25 +12,22 @@ House::House(Drawable* mesh, const vec3& initialPosition)
     m_attachedBalloonCount(0), m_liftPerBalloon(15.0f),
     m_dragCoefficient(5.0f), m_takeoffTimer(0.0f), m_takeoffDelay(10.0f),
     m_isTakingOff(false), m_getTerrainHeight(nullptr), m_rotation(0.0f),
-    m_angularVelocity(0.0f), m_tiltAngle(0.0f), m_tiltAxis(1.0f, 0.0f, 0.0f) {
+    m_angularVelocity(0.0f), m_tiltAngle(0.0f), m_tiltAxis(1.0f, 0.0f, 0.0f),
+    m_prevRotation(0.0f), m_prevTiltAngle(0.0f), m_prevTiltAxis(1.0f, 0.0f, 0.0f) {
     m_body.position = initialPosition;
+    m_body.previousPosition = initialPosition;
     m_body.velocity = vec3(0.0f);
     m_body.mass = HOUSE_MASS;
     m_body.force = vec3(0.0f);
 }
 
-void House::applyForces(const std::vector<Balloon*>& balloons,
+void House::applyForces(const BalloonPool& balloons,
     WindSystem* windSystem) {
     // Reset force accumulator
     m_body.force = vec3(0.0f);
 
     // Count attached, non-popped balloons
-    m_attachedBalloonCount = 0;
-    for (const auto* balloon : balloons) {
-        if (balloon->isRopeAttached() && !balloon->isPopped()) {
-            m_attachedBalloonCount++;
-        }
-    }
+    m_attachedBalloonCount = balloons.countAttached();
 
     // 1. GRAVITY
     m_body.applyForce(Forces::gravity(m_body.mass));
@@ -105,6 +103,7 @@ void House::applyForces(const std::vector<Balloon*>& balloons,
 }
 
 void House::update(float dt) {
+    PROFILE_ZONE("House::update");
     if (m_isTakingOff) {
         m_takeoffTimer += dt;
     }
@@ -240,24 +239,40 @@ void House::updateRotation(float dt) {
     m_rotation.y += m_angularVelocity.y * dt * 0.1f; // Very subtle rotation
 }
 
-void House::draw(GLuint modelMatrixLocation) const {
+void House::storePreviousState() {
+    m_body.storeState();
+    m_prevRotation = m_rotation;
+    m_prevTiltAngle = m_tiltAngle;
+    m_prevTiltAxis = m_tiltAxis;
+}
+
+void House::draw(GLuint modelMatrixLocation, float alpha) const {
+    glm::mat4 M = getModelMatrix(alpha);
+    glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE, &M[0][0]);
+
+    m_mesh->bind();
+    m_mesh->draw();
+}
+
+glm::mat4 House::getModelMatrix(float alpha) const {
     glm::mat4 M(1.0f);
 
+    // Blend between the last two simulated states
+    float tiltAngle = glm::mix(m_prevTiltAngle, m_tiltAngle, alpha);
+    vec3 tiltAxis = glm::mix(m_prevTiltAxis, m_tiltAxis, alpha);
+    float yaw = glm::mix(m_prevRotation.y, m_rotation.y, alpha);
+
     // Translate to position
-    M = glm::translate(M, m_body.position);
+    M = glm::translate(M, getRenderPosition(alpha));
 
     // Apply tilt rotation
-    if (abs(m_tiltAngle) > 0.001f) {
-        M = glm::rotate(M, m_tiltAngle, m_tiltAxis);
+    if (abs(tiltAngle) > 0.001f && length(tiltAxis) > 0.001f) {
+        M = glm::rotate(M, tiltAngle, normalize(tiltAxis));
     }
 
     // Apply any Y-axis rotation (very subtle)
-    if (abs(m_rotation.y) > 0.001f) {
-        M = glm::rotate(M, m_rotation.y, vec3(0, 1, 0));
+    if (abs(yaw) > 0.001f) {
+        M = glm::rotate(M, yaw, vec3(0, 1, 0));
     }
-
-    glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE, &M[0][0]);
-
-    m_mesh->bind();
-    m_mesh->draw();
+    return M;
 }
\ No newline at end of file
@@ -7,7 +7,7 @@
 #include <physics/rigidBody.h>
 #include <vector>
 
-class Balloon;
+class BalloonPool;
 class WindSystem;
 
 class House {
@@ -15,17 +15,23 @@ public:
     House(Drawable* mesh, const glm::vec3& initialPosition);
 
     // Physics simulation
-    void applyForces(const std::vector<Balloon*>& balloons,
+    void applyForces(const BalloonPool& balloons,
         WindSystem* windSystem = nullptr);
     void update(float dt);
 
-    // Rendering
-    void draw(GLuint modelMatrixLocation) const;
+    // Snapshot before a fixed step, used for render interpolation
+    void storePreviousState();
+
+    // Rendering (alpha blends between the previous and the current step)
+    void draw(GLuint modelMatrixLocation, float alpha = 1.0f) const;
+    // position, tilt and yaw as draw() uses them
+    glm::mat4 getModelMatrix(float alpha = 1.0f) const;
 
     // Getters
     const glm::vec3& getPosition() const { return m_body.position; }
     const glm::vec3& getVelocity() const { return m_body.velocity; }
     const glm::vec3& getInitialPosition() const { return m_initialPosition; }
+    glm::vec3 getRenderPosition(float alpha) const { return m_body.interpolatedPosition(alpha); }
     bool isFlying() const { return m_isFlying; }
     int getAttachedBalloonCount() const { return m_attachedBalloonCount; }
 
@@ -83,6 +89,11 @@ private:
     float m_tiltAngle;           // Current tilt angle for rendering
     glm::vec3 m_tiltAxis;        // Tilt axis direction
 
+    // Rotation state at the start of the last fixed step
+    glm::vec3 m_prevRotation;
+    float m_prevTiltAngle;
+    glm::vec3 m_prevTiltAxis;
+
     // Tilt physics parameters
     static constexpr float TILT_RESPONSE = 0.30f; // Increased from 0.15f
     static constexpr float TILT_DAMPING = 3.0f;   // Angular damping
@@ -1,5 +1,6 @@
 // Include C++ headers
 #include <iostream>
+#include <memory>
 #include <string>
 
 // Include GLEW
@@ -19,27 +20,34 @@
 #include <common/shader.h>
 #include <common/texture.h>
 #include <common/util.h>
+#include <common/simClock.h>
+#include <common/profiler.h>
+#include <common/gpuTimer.h>
 
-#include <balloons/balloon.h>
+#include <sim/world.h>
+#include <sim/simThread.h>
+
+#include <balloons/balloonPool.h>
 #include <balloons/balloonMesh.h>
+#include <balloons/balloonRenderer.h>
 #include <balloons/balloonTypes.h>
 #include <balloons/rope.h>
+#include <balloons/ropeRenderer.h>
 #include <balloons/ropeInstance.h>
+#include <particles/particleRenderer.h>
+#include <terrain/heightfield.h>
 #include <terrain/river.h>
 #include <terrain/terrain.h>
+#include <terrain/terrainQuadtree.h>
+#include <terrain/terrainRenderer.h>
+#include <terrain/terrainStreamer.h>
+#include <common/frustum.h>
+#include <common/meshCache.h>
+#include <common/assetLoader.h>
+#include <enemies/birdRenderer.h>
 
-#include <house/house.h>
-#include <particles/particleSystem.h>
-#include <physics/collision.h>
-#include <physics/rigidBody.h>
-
-#include <beacon/beacon.h>
-// task 5
-#include "navigation/autopilot.h"
 // task 7
 #include "navigation/userNav.h"
-// task 6: bird enemies
-#include "enemies/bird.h"
 
 using namespace std;
 using namespace glm;
@@ -49,7 +57,6 @@ void initialize();
 void createContext();
 void mainLoop();
 void free();
-float getTerrainHeightAt(float x, float z);
 
 #define W_WIDTH 1920
 #define W_HEIGHT 1440
@@ -73,11 +80,29 @@ Light* light;
 GLuint shaderProgram, depthProgram;
 GLuint depthFBO, depthTexture;
 //
+// parsed / generated meshes kept on disk between runs (--no-cache to skip)
+const char* MESH_CACHE_DIRECTORY = "../cache";
+bool useMeshCache = true;
+MeshCache* meshCache = nullptr;
+// --compact-meshes / --release-mesh-data, see MeshFormat
+MeshFormat meshFormat = {false, false};
+// textures and meshes load on worker threads behind placeholders, the game
+// starts right away; --sync-assets waits for them before the first frame
+AssetLoader* assetLoader = nullptr;
+bool syncAssets = false;
+const int ASSET_UPLOADS_PER_FRAME = 2;
+double assetLoadStart;
 // task 1
 Drawable* house;
 GLuint houseDiffuseTexture, houseSpecularTexture;
-House* housePhysics;
-Drawable* mountainTerrain;
+// terrain: CDLOD chunks over the scene heightfield
+TerrainQuadtree* terrainTree = nullptr;
+TerrainRenderer* terrainRenderer = nullptr;
+// --stream-terrain: endless tiles generated around the house instead
+bool streamTerrain = false;
+TerrainStreamer* terrainStreamer = nullptr;
+// finished tiles turned into GL meshes per frame
+const int TERRAIN_UPLOADS_PER_FRAME = 2;
 Drawable* river;
 GLuint waterDiffuseTexture, waterSpecularTexture;
 GLuint waterDuDvTexture;
@@ -98,37 +123,44 @@ GLuint skyboxVPLocation, skyboxTextureSampler;
 GLuint skyboxTexture;
 Drawable* skyboxSphere = nullptr;
 
-// task 8
-// house crash
-bool houseCrashed = false;
-ParticleSystem* crashParticles = nullptr;
-//
+// particles: camera-facing quads, one instanced draw
+GLuint particleProgram;
+GLuint particleViewLocation, particleProjectionLocation;
+ParticleRenderer* particleRenderer = nullptr;
+
 // task2: balloons
-Drawable* balloon;
+Drawable* balloon;  // finest level of balloonLods
 BalloonMesh balloonMesh;
-Drawable* rope;
+std::vector<Drawable*> balloonLods;
+const int BALLOON_SHADOW_LOD = 2;
+BalloonRenderer* balloonRenderer = nullptr; // instanced draws per type and LOD
+RopeRenderer* ropeRenderer = nullptr; // every rope in one draw
 Drawable* bananaModel;
 
-vector<Balloon*> balloons;
-vector<RopeInstance*> ropeInstances;
-const int NUM_BALLOONS = 15;                                                        // AMOUNT OF BALLOONS
-
-vector<ParticleSystem*> popParticles;
 
 // task 6: bird enemies
 const int BIRD_FRAME_COUNT = 21;
-const int NUM_BIRDS = 10;                                                           // AMOUNT OF BIRDS
-Drawable* birdFrames[BIRD_FRAME_COUNT];
-std::vector<Bird*> birds;
+// the frames baked into one mesh + animation texture, all birds in one draw
+BirdRenderer* birdRenderer = nullptr;
 
-// task 5: autopilot to beacon
-Beacon* destinationBeacon = nullptr;
-Autopilot autopilot;
+// simulated scene (house, balloons, birds, beacon, particles), see sim/world.h
+WorldConfig worldConfig;
+World* world = nullptr;
 UserNav userNav; // task 7 User Nav
 
-// task 7: user navigation
-enum GameMode { SEARCH_MODE, NAV_MODE };
-GameMode currentMode = SEARCH_MODE; // Default to Autopilot/Search
+// fixed-timestep simulation: physics runs at simClock rate, the snapshot
+// drawn is interpolated between the last two steps
+SimClock simClock(120.0f, 8);
+// the world steps on its own thread while the previous frame's snapshot is
+// drawn; --serial-sim steps it on the main thread before drawing
+SimThread* simThread = nullptr;
+bool pipelineSim = true;
+const RenderSnapshot* snapshot = nullptr;  // drawn this frame
+
+#ifdef ENABLE_PROFILER
+// GL timer queries around the render passes, see common/profiler.h
+GpuTimer* gpuTimer = nullptr;
+#endif
 
 // locations for shaderProgram
 GLuint viewMatrixLocation;
@@ -146,12 +178,14 @@ GLuint lightVPLocation;
 
 GLuint timeLocation;
 GLuint isBeaconLocation; // task5
+GLuint useInstancingLocation;
 
 GLuint dudvSampler;
 
 // locations for depthProgram
 GLuint shadowViewProjectionLocation;
 GLuint shadowModelLocation;
+GLuint shadowUseInstancingLocation;
 
 
 // Terrain material
@@ -278,6 +312,43 @@ Drawable* generateSkySphere(int stacks, int slices, float radius) {
     return new Drawable(vertices, uvs, normals);
 }
 
+// GPU buffers and CPU copies of the static meshes, per asset
+void printMeshMemory() {
+    size_t totalGPU = 0, totalCPU = 0;
+    auto print = [&](const char* name, size_t gpu, size_t cpu) {
+        printf("  %-16s %10.1f KB GPU %10.1f KB CPU\n", name, gpu / 1024.0, cpu / 1024.0);
+        totalGPU += gpu;
+        totalCPU += cpu;
+    };
+    auto row = [&](const char* name, Drawable* const* meshes, int count) {
+        size_t gpu = 0, cpu = 0;
+        for (int i = 0; i < count; ++i) {
+            if (!meshes[i]) continue;
+            gpu += meshes[i]->getGPUBytes();
+            cpu += meshes[i]->getCPUBytes();
+        }
+        print(name, gpu, cpu);
+    };
+    printf("Mesh memory (%s layout%s):\n", meshFormat.compact ? "compact" : "float",
+        meshFormat.releaseCPU ? ", CPU copies released" : "");
+    row("house", &house, 1);
+    row("river", &river, 1);
+    row("banana", &bananaModel, 1);
+    row("cactus", &cactusModel, 1);
+    print("birds", birdRenderer->getGPUBytes(), 0);
+    row("balloon lods", balloonLods.data(), (int)balloonLods.size());
+    row("skybox", &skyboxSphere, 1);
+    printf("  %-16s %10.1f KB GPU %10.1f KB CPU\n", "total", totalGPU / 1024.0,
+        totalCPU / 1024.0);
+}
+
+void assetsLoaded() {
+    printf("Assets loaded in %.0f ms (cache: %d hits, %d misses)\n",
+        (glfwGetTime() - assetLoadStart) * 1000.0, meshCache->getHits(),
+        meshCache->getMisses());
+    printMeshMemory();
+}
+
 void createContext() {
     // Create and compile our GLSL program from the shader
     shaderProgram = loadShaders("../shaders/ShadowMapping.vertexshader",
@@ -325,6 +396,7 @@ void createContext() {
 
     // Task 1.4
     useTextureLocation = glGetUniformLocation(shaderProgram, "useTexture");
+    useInstancingLocation = glGetUniformLocation(shaderProgram, "useInstancing");
 
     // locations for shadow rendering
     depthMapSampler = glGetUniformLocation(shaderProgram, "shadowMapSampler");
@@ -333,6 +405,7 @@ void createContext() {
     // --- depthProgram ---
     shadowViewProjectionLocation = glGetUniformLocation(depthProgram, "VP");
     shadowModelLocation = glGetUniformLocation(depthProgram, "M");
+    shadowUseInstancingLocation = glGetUniformLocation(depthProgram, "useInstancing");
 
     // --- miniMapProgram ---
     //quadTextureSamplerLocation =
@@ -344,54 +417,66 @@ void createContext() {
     skyboxVPLocation = glGetUniformLocation(skyboxProgram, "VP");
     skyboxTextureSampler = glGetUniformLocation(skyboxProgram, "skyTexture");
 
+    // --- particleProgram ---
+    particleProgram = loadShaders("../shaders/Particle.vertexshader",
+        "../shaders/Particle.fragmentshader");
+    particleViewLocation = glGetUniformLocation(particleProgram, "V");
+    particleProjectionLocation = glGetUniformLocation(particleProgram, "P");
+
+    // files are read, decoded and indexed in the background, every texture
+    // and mesh below is a placeholder until mainLoop uploads it
+    assetLoadStart = glfwGetTime();
+    assetLoader = new AssetLoader(*meshCache);
+
+    // house
+    house = assetLoader->loadDrawable("../assets/models/houseUP.obj");
+
     // Load skybox texture and generate sky sphere
-    skyboxTexture = loadSOIL(
+    skyboxTexture = assetLoader->loadTexture(
         "../assets/desert_skybox_2/textures/Cartoon_Desert2_baseColor.bmp");
     skyboxSphere = generateSkySphere(32, 64, 90.0f);
-    printf("Skybox loaded\n");
 
     // Loading a model
     // loading a diffuse and a specular texture
-    houseDiffuseTexture = loadSOIL("../assets/textures/house_diffuse.bmp");
-    houseSpecularTexture = loadSOIL("../assets/textures/house_specular.bmp");
-
-    waterDiffuseTexture = loadSOIL("../terrain/water_diffuse.bmp");
-    waterSpecularTexture = loadSOIL("../terrain/water_specular.bmp");
+    houseDiffuseTexture = assetLoader->loadTexture("../assets/textures/house_diffuse.bmp");
+    houseSpecularTexture = assetLoader->loadTexture("../assets/textures/house_specular.bmp");
 
-    waterDuDvTexture = loadSOIL("../terrain/water_dudv.png");
+    waterDiffuseTexture = assetLoader->loadTexture("../terrain/water_diffuse.bmp");
+    waterSpecularTexture = assetLoader->loadTexture("../terrain/water_specular.bmp");
 
-    // house
-    house = new Drawable("../assets/models/houseUP.obj");
-
-    vec3 peak = Terrain::get_terrain_peak() + vec3(5.0f, 0.0f, 0.0f);
-    housePhysics = new House(house, peak);
-    housePhysics->setTerrainHeightFunction(getTerrainHeightAt);
+    waterDuDvTexture = assetLoader->loadTexture("../terrain/water_dudv.png");
 
     // terrain
-    float terrainSize = 100.0f;
-    float res = 200.0f;
-    float maxHeight = 15.0f;
-
-    mountainTerrain = Terrain::generate(terrainSize, res, maxHeight);
+    const Heightfield& terrain = getTerrainHeightfield();
+    int res = 200;
 
-    float waterLevel = -2.0f;
-    river = River::createFloodedCanyon(terrainSize, res, waterLevel, maxHeight);
-
-    // destination beacon
-    vec3 beaconPos =
-        Beacon::generateRandomBeaconPosition(terrainSize, maxHeight, peak);
-    destinationBeacon = new Beacon(beaconPos, 4.0f, 40.0f);
-    // debugging
-    printf("Beacon created at position: (%.2f, %.2f, %.2f)\n", beaconPos.x,
-        beaconPos.y, beaconPos.z);
+    float waterLevel = World::WATER_LEVEL;
+    if (streamTerrain) {
+        terrainStreamer = new TerrainStreamer(World::TERRAIN_SIZE,
+            World::TERRAIN_MAX_HEIGHT, waterLevel);
+    }
+    else {
+        terrainTree = new TerrainQuadtree(terrain);
+        terrainRenderer = new TerrainRenderer(terrain, *terrainTree);
+        terrainRenderer->attachProgram(shaderProgram);
+        terrainRenderer->attachProgram(depthProgram);
+
+        std::string riverKey = MeshCache::paramKey("river", {World::TERRAIN_SIZE,
+            (float)World::TERRAIN_RESOLUTION, World::TERRAIN_MAX_HEIGHT,
+            (float)res, waterLevel});
+        river = assetLoader->generateDrawable(riverKey, [&terrain, res, waterLevel](
+            vector<vec3>& vertices, vector<vec2>& uvs, vector<vec3>& normals) {
+            River::buildFloodedCanyon(terrain, res, waterLevel, vertices, uvs, normals);
+        });
+    }
 
     // banana obj for transparent balloon
-    bananaModel = new Drawable(std::string("../assets/models/banana.obj"));
+    bananaModel = assetLoader->loadDrawable("../assets/models/banana.obj");
 
     // Load cactus model and texture
-    cactusModel = new Drawable("../assets/models/cactus.obj");
-    cactusDiffuseTexture = loadSOIL("../assets/textures/cactus_Albedo.bmp");
-	cactusSpecularTexture = loadSOIL("../assets/textures/cactus_Rough.bmp");
+    cactusModel = assetLoader->loadDrawable("../assets/models/cactus.obj");
+    cactusDiffuseTexture = assetLoader->loadTexture("../assets/textures/cactus_Albedo.bmp");
+	cactusSpecularTexture = assetLoader->loadTexture("../assets/textures/cactus_Rough.bmp");
 
     // Left tepui spans x ~ [-40,-20], right tepui x ~ [16,44].
     // River canyon is at x ~ 0. So valid low-ground bands:
@@ -417,66 +502,49 @@ void createContext() {
             cactusScales[i]);
     }
 
-    //
-    // multiple balloons
-    vec3 chimneyOffset = vec3(-0.18f, 5.0f, -2.0f);
-    vec3 chimneyPos = peak + chimneyOffset;
-
-    balloon = new Drawable(balloonMesh.positions, balloonMesh.uvs);
-
-    // multiple balloons around the center of the chimney
-    for (int i = 0; i < NUM_BALLOONS; ++i) {
-        BalloonType type = getBalloonTypeByIndex(i);
-        // If transparent, add banana inside, else draw other type of balloon
-        Balloon* newBalloon = (type == BalloonType::TRANSPARENT)
-            ? new Balloon(balloon, type, bananaModel)
-            : new Balloon(balloon, type);
-
-        // put them in a circle
-        float angle = (float)i / NUM_BALLOONS * 2.0f * 3.14159f;
-        float radius = 0.01f; // radius around chimneyPos
-        vec3 offset = vec3(cos(angle) * radius, 0.0f, sin(angle) * radius);
-
-        newBalloon->setAnchor(chimneyPos + offset);
-        newBalloon->attach(Rope::DEFAULT_LENGTH);
-
-        balloons.push_back(newBalloon);
-
-        // create corresponding rope
-        RopeInstance* newRope = new RopeInstance(Rope::DEFAULT_LENGTH);
-        ropeInstances.push_back(newRope);
-        // debug info
-        printf("Created balloon %d: %s\n", i, getBalloonTypeName(type));
+    // balloon mesh shared by all balloons
+    // (levels of detail, already indexed; no normals, the balloon shaders
+    // use derivative normals)
+    for (const BalloonMesh::Level& level : balloonMesh.levels) {
+        balloonLods.push_back(new Drawable(level.positions, level.uvs,
+            VEC_VEC3_DEFAUTL_VALUE, level.indices));
     }
-
-    // Task 6: Load bird animation frames and spawn birds
-
+    balloon = balloonLods[0];
+    balloonRenderer = new BalloonRenderer(balloonMesh, balloonLods);
+
+    // tubes around the bezier / verlet rope points, rebuilt every frame
+    ropeRenderer = new RopeRenderer(8, Rope::DEFAULT_RADIUS);
+
+    // Task 6: Load bird animation frames, baked on a worker and uploaded as
+    // one mesh and animation texture
+    birdRenderer = new BirdRenderer();
+    birdRenderer->attachProgram(shaderProgram);
+    birdRenderer->attachProgram(depthProgram);
+    vector<string> birdPaths;
     char path[256];
     for (int i = 0; i < BIRD_FRAME_COUNT; ++i) {
         sprintf(path, "../assets/bird_anim/bird%02d.obj", i + 1);
-        birdFrames[i] = new Drawable(path);
-        printf("Loaded bird frame %d: %s\n", i + 1, path);
+        birdPaths.push_back(path);
     }
-
-    // Spawn birds in fixed orbits over the river area
-    vec3 riverCenter = vec3(0.0f, 0.0f, 0.0f); // approximate center
-    float flyHeight = peak.y + 15.0f;          // fly above the terrain peak
-    float orbitRadius = 25.0f;
-    float birdSpeed = 0.8f; // radians/sec
-
-
-    for (int i = 0; i < NUM_BIRDS; ++i) {
-        float startAngle = (float)i / NUM_BIRDS * 6.28318f;
-        float r = orbitRadius + (i % 3) * 5.0f;
-        float s = birdSpeed + (i % 2) * 0.3f;
-        float h = flyHeight + (i % 3) * 3.0f;
-
-        birds.push_back(new Bird(birdFrames, BIRD_FRAME_COUNT, riverCenter, r, s, h,
-            startAngle));
-        printf("Spawned bird %d at angle %.2f, radius %.1f, height %.1f\n", i,
-            startAngle, r, h);
+    auto birdAnimation = std::make_shared<BirdAnimation>();
+    assetLoader->run("bird animation", [birdAnimation, birdPaths] {
+        birdAnimation->load(birdPaths, meshCache);
+    }, [birdAnimation] {
+        birdRenderer->upload(*birdAnimation);
+    });
+    if (syncAssets) {
+        assetLoader->finish();
+        assetsLoaded();
     }
-    
+
+    // simulated objects: house, balloons + ropes, birds and the beacon
+    WorldMeshes meshes;
+    meshes.house = house;
+    world = new World(worldConfig, meshes);
+    particleRenderer = new ParticleRenderer(world->particles.capacity());
+    world->beacon->createMesh();
+    simThread = new SimThread(*world, pipelineSim);
+    snapshot = &simThread->getSnapshot();
 
     // ----------------------------------------------------------------------------
     // //
@@ -536,43 +604,77 @@ void createContext() {
         throw runtime_error("Frame buffer not initialized correctly");
     }
 
+#ifdef ENABLE_PROFILER
+    gpuTimer = new GpuTimer();
+#endif
+
     // Binding the default framebuffer
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     //*/
 }
 
 void free() {
-    // del balloons
-    for (auto* b : balloons) {
-        delete b;
+#ifdef ENABLE_PROFILER
+    // while the zone names (simulation stages) are still alive
+    Profiler::get().writeTrace();
+    if (gpuTimer) {
+        delete gpuTimer;
+        gpuTimer = nullptr;
     }
-    balloons.clear();
-    // del ropes
-    for (auto* r : ropeInstances) {
-        delete r;
+#endif
+
+    // drops what is still loading, before the placeholders go away
+    if (assetLoader) {
+        delete assetLoader;
+        assetLoader = nullptr;
     }
-    ropeInstances.clear();
-    // del house physics
-    if (housePhysics) {
-        delete housePhysics;
-        housePhysics = nullptr;
+
+    // stop stepping before the world goes away
+    if (simThread) {
+        delete simThread;
+        simThread = nullptr;
     }
-    // del beacon
-    if (destinationBeacon) {
-        delete destinationBeacon;
-        destinationBeacon = nullptr;
+
+    // del sim objects (house, balloons, ropes, birds, beacon, particles)
+    if (world) {
+        delete world;
+        world = nullptr;
     }
 
-    // del birds
-    for (auto* b : birds) {
-        delete b;
+    if (balloonRenderer) {
+        delete balloonRenderer;
+        balloonRenderer = nullptr;
     }
-    birds.clear();
-    for (int i = 0; i < BIRD_FRAME_COUNT; ++i) {
-        if (birdFrames[i]) {
-            delete birdFrames[i];
-            birdFrames[i] = nullptr;
-        }
+    for (auto* lod : balloonLods) {
+        delete lod;
+    }
+    balloonLods.clear();
+    balloon = nullptr;
+    if (ropeRenderer) {
+        delete ropeRenderer;
+        ropeRenderer = nullptr;
+    }
+    if (birdRenderer) {
+        delete birdRenderer;
+        birdRenderer = nullptr;
+    }
+
+    if (particleRenderer) {
+        delete particleRenderer;
+        particleRenderer = nullptr;
+    }
+
+    if (terrainRenderer) {
+        delete terrainRenderer;
+        terrainRenderer = nullptr;
+    }
+    if (terrainTree) {
+        delete terrainTree;
+        terrainTree = nullptr;
+    }
+    if (terrainStreamer) {
+        delete terrainStreamer;
+        terrainStreamer = nullptr;
     }
 
     // del cacti
@@ -581,10 +683,17 @@ void free() {
         cactusModel = nullptr;
     }
 
+    if (meshCache) {
+        setTerrainCache(nullptr);
+        delete meshCache;
+        meshCache = nullptr;
+    }
+
     // Delete Shader Programs
     glDeleteProgram(shaderProgram);
     glDeleteProgram(depthProgram);
     glDeleteProgram(skyboxProgram);
+    glDeleteProgram(particleProgram);
 
     // del skybox
     if (skyboxSphere) {
@@ -592,16 +701,12 @@ void free() {
         skyboxSphere = nullptr;
     }
 
-    // del crash particles
-    if (crashParticles) {
-        delete crashParticles;
-        crashParticles = nullptr;
-    }
-
     glfwTerminate();
 }
 
 void depth_pass(mat4 viewMatrix, mat4 projectionMatrix) {
+    PROFILE_ZONE("depth_pass");
+    PROFILE_GPU_ZONE(gpuTimer, "depth_pass");
 
     // Setting viewport to shadow map size
     glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
@@ -623,17 +728,23 @@ void depth_pass(mat4 viewMatrix, mat4 projectionMatrix) {
     // ---- rendering the scene ---- //
     // creating model matrix and sending to GPU
     // terrain
-    mat4 terrainModelMatrix = mat4(1.0f);
-    glUniformMatrix4fv(shadowModelLocation, 1, GL_FALSE,
-        &terrainModelMatrix[0][0]);
-    mountainTerrain->bind();
-    mountainTerrain->draw();
-
-    // river
-    mat4 riverModelMatrix = mat4(1.0f);
-    glUniformMatrix4fv(shadowModelLocation, 1, GL_FALSE, &riverModelMatrix[0][0]);
-    river->bind();
-    river->draw();
+    if (terrainStreamer) {
+        mat4 terrainModelMatrix = mat4(1.0f);
+        glUniformMatrix4fv(shadowModelLocation, 1, GL_FALSE, &terrainModelMatrix[0][0]);
+        Frustum lightFrustum(view_projection);
+        terrainStreamer->drawTerrain(lightFrustum);
+        terrainStreamer->drawWater(lightFrustum);
+    }
+    else {
+        // the camera picks the levels, so the shadows match what is seen
+        terrainRenderer->draw(depthProgram, camera->position, view_projection);
+
+        // river
+        mat4 riverModelMatrix = mat4(1.0f);
+        glUniformMatrix4fv(shadowModelLocation, 1, GL_FALSE, &riverModelMatrix[0][0]);
+        river->bind();
+        river->draw();
+    }
 
     // cacti (depth pass for shadows)
     for (int i = 0; i < NUM_CACTI; ++i) {
@@ -646,30 +757,23 @@ void depth_pass(mat4 viewMatrix, mat4 projectionMatrix) {
     }
 
     // house (skip if crashed)
-    if (!houseCrashed) {
+    if (!snapshot->houseCrashed) {
         mat4 houseModelMatrix = mat4(1.0f);
-        houseModelMatrix = translate(houseModelMatrix, housePhysics->getPosition());
+        houseModelMatrix = translate(houseModelMatrix, snapshot->housePosition);
         glUniformMatrix4fv(shadowModelLocation, 1, GL_FALSE,
             &houseModelMatrix[0][0]);
         house->bind();
         house->draw();
     }
 
-    // balloons
-    for (size_t i = 0; i < balloons.size(); ++i) {
-        if (balloons[i]->isPopped())
-            continue;
-        mat4 balloonM = translate(mat4(1.0f), balloons[i]->getPosition());
-        balloonM = scale(balloonM, vec3(balloons[i]->getRadius()));
-        glUniformMatrix4fv(shadowModelLocation, 1, GL_FALSE, &balloonM[0][0]);
-        balloon->bind();
-        balloon->draw();
-    }
+    // balloons: every type in a single instanced draw of a coarse level,
+    // the shadow map does not need the full mesh
+    glUniform1i(shadowUseInstancingLocation, 1);
+    balloonRenderer->drawAll(BALLOON_SHADOW_LOD);
+    glUniform1i(shadowUseInstancingLocation, 0);
 
-    // birds (depth pass for shadows)
-    for (auto* bird : birds) {
-        bird->draw(shadowModelLocation);
-    }
+    // birds (depth pass for shadows), one instanced draw
+    birdRenderer->draw(depthProgram);
 
     // binding the default framebuffer again
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -678,6 +782,8 @@ void depth_pass(mat4 viewMatrix, mat4 projectionMatrix) {
 }
 
 void lighting_pass(mat4 viewMatrix, mat4 projectionMatrix) {
+    PROFILE_ZONE("lighting_pass");
+    PROFILE_GPU_ZONE(gpuTimer, "lighting_pass");
     // Step 1: Binding a frame buffer
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glViewport(0, 0, W_WIDTH, W_HEIGHT);
@@ -753,12 +859,16 @@ void lighting_pass(mat4 viewMatrix, mat4 projectionMatrix) {
     glUniform1i(useTextureLocation, 0);
 
     // draw terrain under house
+    Frustum viewFrustum(projectionMatrix * viewMatrix);
     mat4 terrainModelMatrix = mat4(1.0f);
-    glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE,
-        &terrainModelMatrix[0][0]);
-
-    mountainTerrain->bind();
-    mountainTerrain->draw();
+    glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE, &terrainModelMatrix[0][0]);
+    if (terrainStreamer) {
+        terrainStreamer->drawTerrain(viewFrustum);
+    }
+    else {
+        terrainRenderer->draw(shaderProgram, camera->position,
+            projectionMatrix * viewMatrix);
+    }
 
     // draw river
     glDisable(GL_CULL_FACE);
@@ -780,8 +890,13 @@ void lighting_pass(mat4 viewMatrix, mat4 projectionMatrix) {
 
     glUniform1i(useTextureLocation, 2);
 
-    river->bind();
-    river->draw();
+    if (terrainStreamer) {
+        terrainStreamer->drawWater(viewFrustum);
+    }
+    else {
+        river->bind();
+        river->draw();
+    }
 
     glEnable(GL_CULL_FACE);
 
@@ -800,8 +915,10 @@ void lighting_pass(mat4 viewMatrix, mat4 projectionMatrix) {
 
     glUniform1i(useTextureLocation, 1);
 
-    if (!houseCrashed) {
-        housePhysics->draw(modelMatrixLocation);
+    if (!snapshot->houseCrashed) {
+        glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE, &snapshot->houseModel[0][0]);
+        house->bind();
+        house->draw();
     }
 
     // Draw cacti
@@ -824,19 +941,37 @@ void lighting_pass(mat4 viewMatrix, mat4 projectionMatrix) {
     uploadMaterial(ropeMaterial);
     glUniform1i(useTextureLocation, 0);
 
-    // draw all ropes
-    for (size_t i = 0; i < balloons.size(); ++i) {
-        if (balloons[i]->isPopped() && balloons[i]->getVerletRope()) {
-            balloons[i]->getVerletRope()->draw(modelMatrixLocation, rope);
-        }
-        else {
-            ropeInstances[i]->draw(modelMatrixLocation);
-        }
+    // draw all ropes: bezier curves of the balloons, verlet chains of the
+    // popped ones, streamed as tubes and drawn in one call
+    ropeRenderer->begin((int)snapshot->ropePoints.size());
+    int ropeStart = 0;
+    for (int size : snapshot->ropeSizes) {
+        ropeRenderer->addRope(&snapshot->ropePoints[ropeStart], size);
+        ropeStart += size;
+    }
+    ropeRenderer->end();
+    ropeRenderer->draw();
+
+    // draw inner obj of the transparent balloons before their (blended) shell
+    uploadMaterial(bananaSkinMaterial);
+    glUniform1i(useTextureLocation, 0);
+    for (const BalloonRenderState& balloon : snapshot->balloons) {
+        if (balloon.type != BalloonType::TRANSPARENT || !bananaModel) continue;
+        mat4 innerM = BalloonPool::getContentMatrix(balloon.position);
+        glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE, &innerM[0][0]);
+        bananaModel->bind();
+        bananaModel->draw();
     }
 
-    // draw all balloons
-    for (size_t i = 0; i < balloons.size(); ++i) {
-        BalloonType type = balloons[i]->getType();
+    // draw all balloons: instanced draws per type (and LOD), transparent ones last
+    static const BalloonType balloonDrawOrder[BalloonRenderer::TYPE_COUNT] = {
+        BalloonType::CLASSIC, BalloonType::GLITTER, BalloonType::METALLIC,
+        BalloonType::NEON, BalloonType::TEXTURED_3D, BalloonType::TRANSPARENT
+    };
+    glUniform1i(useInstancingLocation, 1);
+    for (BalloonType type : balloonDrawOrder) {
+        if (balloonRenderer->getInstanceCount(type) == 0)
+            continue;
 
         Material balloonMat = getBalloonMaterial(type);
         uploadMaterial(balloonMat);
@@ -852,24 +987,18 @@ void lighting_pass(mat4 viewMatrix, mat4 projectionMatrix) {
             glDepthMask(GL_FALSE);
         }
 
-        balloons[i]->draw(modelMatrixLocation);
+        balloonRenderer->drawType(type);
 
         // reset transparency settings
         if (type == BalloonType::TRANSPARENT) {
             glDepthMask(GL_TRUE);
             glDisable(GL_BLEND);
         }
-
-        // draw inner obj
-        if (type == BalloonType::TRANSPARENT) {
-            uploadMaterial(bananaSkinMaterial);
-            glUniform1i(useTextureLocation, 0);
-            balloons[i]->drawContent(modelMatrixLocation);
-        }
     }
+    glUniform1i(useInstancingLocation, 0);
 
     // beacon
-    if (destinationBeacon) {
+    if (snapshot->hasBeacon) {
         glUseProgram(shaderProgram);
         uploadMaterial(beaconMaterial);
 
@@ -882,7 +1011,7 @@ void lighting_pass(mat4 viewMatrix, mat4 projectionMatrix) {
         // Set beacon flag
         glUniform1i(isBeaconLocation, 1);
         // Draw beacon with time for animation
-        destinationBeacon->draw(modelMatrixLocation, timeLocation);
+        world->beacon->draw(modelMatrixLocation, timeLocation, snapshot->beaconTime);
         // Reset beacon flag
         glUniform1i(isBeaconLocation, 0);
         glDepthMask(GL_TRUE);
@@ -892,109 +1021,54 @@ void lighting_pass(mat4 viewMatrix, mat4 projectionMatrix) {
     uploadMaterial(birdMaterial);
     glUniform1i(useTextureLocation, 0);
 
-    for (auto* bird : birds) {
-        bird->draw(modelMatrixLocation);
-    }
-
-    // reset for particles
-    glUniform1i(useTextureLocation, 3);
-
-    // draw particles
-    if (!popParticles.empty()) {
-        glDepthMask(GL_FALSE);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-        for (auto* ps : popParticles) {
-            ps->draw(modelMatrixLocation, balloon);
-        }
+    birdRenderer->draw(shaderProgram);
 
-        glDepthMask(GL_TRUE);
-    }
+    // draw particles (pop bursts and crash sparks) in one instanced call
+    particleRenderer->update(snapshot->particles);
+    if (particleRenderer->getInstanceCount() > 0) {
+        glUseProgram(particleProgram);
+        glUniformMatrix4fv(particleViewLocation, 1, GL_FALSE, &viewMatrix[0][0]);
+        glUniformMatrix4fv(particleProjectionLocation, 1, GL_FALSE,
+            &projectionMatrix[0][0]);
 
-    // draw crash particles
-    if (crashParticles) {
         glDepthMask(GL_FALSE);
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        crashParticles->draw(modelMatrixLocation, balloon);
+        particleRenderer->draw();
 
         glDepthMask(GL_TRUE);
+        glDisable(GL_BLEND);
     }
 }
 
 
-// collision detection: BALLOONS
-void handleBalloonCollisions() {
-    for (size_t i = 0; i < balloons.size(); ++i) {
-        if (balloons[i]->isPopped())
-            continue;
-
-        for (size_t j = i + 1; j < balloons.size(); ++j) {
-            if (balloons[j]->isPopped())
-                continue;
-
-            // sphere structs
-            Sphere s1, s2;
-            s1.x = balloons[i]->getPosition();
-            s1.r = balloons[i]->getRadius();
-
-            s2.x = balloons[j]->getPosition();
-            s2.r = balloons[j]->getRadius();
-
-            // check for collision
-            if (checkSphereSphereCollision(s1, s2)) {
-                RigidBody& rb1 = balloons[i]->getRigidBody();
-                RigidBody& rb2 = balloons[j]->getRigidBody();
-
-                // collsiion handling
-                handleSphereSphereCollision(s1, s2, rb1.velocity, rb2.velocity,
-                    rb1.mass, rb2.mass);
-
-                // update positions
-                rb1.position = s1.x;
-                rb2.position = s2.x;
-            }
-        }
-    }
-}
-
-float getTerrainHeightAt(float x, float z) {
-    const float terrainSize = 100.0f;
-    const float terrainMaxHeight = 15.0f;
-    return Terrain::sampleHeight(x, z, terrainSize, terrainMaxHeight);
-}
-
 void mainLoop() {
-    static float lastTime = 0.0f;
-
-    light->update();
-    mat4 light_proj = light->projectionMatrix;
-    mat4 light_view = light->viewMatrix;
-
-    // Task 3.3
-    // Create the depth buffer
-    depth_pass(light_view, light_proj);
+    PROFILE_THREAD("main");
+    double lastTime = glfwGetTime();
 
     do {
         light->update();
         mat4 light_proj = light->projectionMatrix;
         mat4 light_view = light->viewMatrix;
 
-        // Task 3.5
-        // Create the depth buffer
-        depth_pass(light_view, light_proj);
-
         // Getting camera information
         camera->update();
         mat4 projectionMatrix = camera->projectionMatrix;
         mat4 viewMatrix = camera->viewMatrix;
 
-        // Balloon Functions
-        float dt = glfwGetTime() - lastTime;
-        lastTime = glfwGetTime();
-        
+        // wall-clock frame time, fed to the fixed-step clock
+        double currentTime = glfwGetTime();
+        double frameTime = currentTime - lastTime;
+        lastTime = currentTime;
+        float dt = (float)frameTime;
+
+        // the batch started last frame is done; its snapshot is what the
+        // player sees, and what this frame's input reacts to
+        simThread->finish();
+        const RenderSnapshot& last = simThread->getSnapshot();
+        SimInput input;
+
         // static vars to store key-pressed values
         static bool keyV_wasPressed = false;
         static bool keyN_wasPressed = false;
@@ -1002,110 +1076,22 @@ void mainLoop() {
         // release (V key)
         bool keyV_isPressed = (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS);
         if (keyV_isPressed && !keyV_wasPressed) {
-            // first available balloon to be released
-            for (size_t i = 0; i < balloons.size(); ++i) {
-                if (balloons[i]->isRopeAttached() && !balloons[i]->isPopped()) {
-                    balloons[i]->release();
-                    printf("Balloon %zu was RELEASED!\n", i);
-                    break;
-                }
-            }
+            input.releaseBalloon = true;
         }
         keyV_wasPressed = keyV_isPressed; // save state
 
         // pop ALL (N key)
         bool keyN_isPressed = (glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS);
         if (keyN_isPressed && !keyN_wasPressed) {
-            // pop ALL attached balloons at once and spawn particles for each
-            for (size_t i = 0; i < balloons.size(); ++i) {
-                if (!balloons[i]->isPopped() && balloons[i]->isRopeAttached()) {
-                    balloons[i]->pop();
-                    popParticles.push_back(new ParticleSystem(balloons[i]->getPosition(),
-                        balloons[i]->getColor()));
-                    printf("Balloon %zu POPPED!\n", i);
-                }
-            }
+            input.popAll = true;
         }
         keyN_wasPressed = keyN_isPressed; // save state
 
-        for (int i = (int)popParticles.size() - 1; i >= 0; --i) {
-            popParticles[i]->update(dt);
-            if (!popParticles[i]->isAlive()) {
-                delete popParticles[i];
-                popParticles.erase(popParticles.begin() + i);
-            }
-        }
-
-        // update crash particles (persistent, never deleted)
-        if (crashParticles) {
-            crashParticles->update(dt);
-        }
-
-        // update all balloons
-        vec3 peak = Terrain::get_terrain_peak() + vec3(5.0f, 0.0f, 0.0f);
-
-        for (size_t i = 0; i < balloons.size(); ++i) {
-            balloons[i]->applyForces();
-            balloons[i]->update(dt);
-        }
-
-        // Task 6: Update birds and check bird-balloon collisions
-        for (auto* bird : birds) {
-            bird->update(dt);
-
-            // Check collision with each balloon
-            for (size_t i = 0; i < balloons.size(); ++i) {
-                if (balloons[i]->isPopped())
-                    continue;
-
-                Sphere birdSphere;
-                birdSphere.x = bird->getPosition();
-                birdSphere.r = bird->getCollisionRadius();
-
-                Sphere balloonSphere;
-                balloonSphere.x = balloons[i]->getPosition();
-                balloonSphere.r = balloons[i]->getRadius();
-
-                if (checkSphereSphereCollision(birdSphere, balloonSphere)) {
-                    balloons[i]->pop();
-                    // Spawn pop particles
-                    popParticles.push_back(new ParticleSystem(balloons[i]->getPosition(),
-                        balloons[i]->getColor()));
-                    printf("Bird popped balloon %zu!\n", i);
-                    break; // One pop per bird per frame
-                }
-            }
-        }
-
-        // --- PHYSICS STEP START ---
-        // Track velocity before physics update for crash detection
-        vec3 preUpdateVelocity = housePhysics->getVelocity();
-
-        // 1. Apply House Internal Forces (Gravity, Lift, Drag)
-        // IMPORTANT: This resets m_body.force to 0 and applies internal forces, so
-        // it MUST be called first!
-        if (!houseCrashed) {
-            housePhysics->applyForces(balloons, nullptr);
-        }
-        vec3 houseMin = peak + vec3(-10.0f, 0.0f, -10.0f);
-        vec3 houseMax = peak + vec3(10.0f, 10.0f, 10.0f);
-
         // Task 7: Game Mode Toggle
         static bool tabWasPressed = false;
         if (glfwGetKey(window, GLFW_KEY_TAB) == GLFW_PRESS) {
             if (!tabWasPressed) {
-                currentMode = (currentMode == SEARCH_MODE) ? NAV_MODE : SEARCH_MODE;
-
-                if (currentMode == NAV_MODE) {
-                    // Switch to User Nav: Disable Autopilot, House Physics ON
-                    autopilot.setEnabled(false);
-                    printf("Switched to USER NAVIGATION MODE\n");
-                }
-                else {
-                    // Switch to Autopilot: Enable Autopilot
-                    autopilot.setEnabled(true);
-                    printf("Switched to AUTOPILOT SEARCH MODE\n");
-                }
+                input.toggleMode = true;
                 tabWasPressed = true;
             }
         }
@@ -1113,109 +1099,53 @@ void mainLoop() {
             tabWasPressed = false;
         }
 
-        // Camera & Movement Logic based on Mode
-        if (currentMode == SEARCH_MODE) {
-            // --- AUTOPILOT MODE ---
-            // 1. Free Camera (WASD moves camera)
-            camera->update();
+        // WASD steers the house in NAV mode, the force is held for all the
+        // steps of this frame
+        if (last.mode == NAV_MODE) {
+            input.steer = true;
+            input.controlForce = userNav.handleInput(last.attachedBalloons, camera, window);
+        }
 
-            // 2. Autopilot controls the house
-            if (destinationBeacon) {
-                autopilot.update(housePhysics, destinationBeacon, balloons, dt);
-            }
+        // --- FIXED-STEP SIMULATION ---
+        // a slow frame runs more steps (up to the substep cap) instead of
+        // feeding one huge dt to the spring-dampers; they run on the
+        // simulation thread while this frame draws the previous batch
+        int steps = simClock.advance(frameTime);
+        snapshot = &simThread->start(input, steps, simClock.getStep(), simClock.getAlpha());
 
-            // Physics Update (Autopilot mode)
-            if (!houseCrashed) { housePhysics->update(dt); }
+        // Camera logic based on Mode
+        if (snapshot->mode == SEARCH_MODE) {
+            // Free Camera (WASD moves camera)
+            camera->update();
         }
         else {
-            // --- USER NAVIGATION MODE ---
-            // 1. Input (Forces)
-            if (!houseCrashed) { userNav.handleInput(housePhysics, camera, dt, window); }
-
-            // 2. Physics Update (Move House based on forces)
-            if (!houseCrashed) { housePhysics->update(dt); }
-
-            // 3. Update Camera (Snap to NEW House Position)
-            userNav.updateCamera(housePhysics, camera, dt);
+            // Snap camera to the (interpolated) house position
+            userNav.updateCamera(snapshot->housePosition, camera, dt);
         }
 
-        // --- CRASH DETECTION ---
-        if (!houseCrashed && preUpdateVelocity.y < -8.0f) {
-            // Check if house is now on/in the ground
-            float terrainH = getTerrainHeightAt(housePhysics->getPosition().x,
-                housePhysics->getPosition().z);
-            if (housePhysics->getPosition().y <= terrainH + 1.0f) {
-                houseCrashed = true;
-                crashParticles = ParticleSystem::createCrashExplosion(
-                    housePhysics->getPosition(), 200);
-                printf("HOUSE CRASHED! Velocity was %.2f\n", preUpdateVelocity.y);
-                // Release all remaining balloons
-                for (size_t i = 0; i < balloons.size(); ++i) {
-                    if (!balloons[i]->isPopped() && balloons[i]->isRopeAttached()) {
-                        balloons[i]->release();
-                    }
-                }
-            }
+        // finished textures / meshes replace their placeholders, a few per
+        // frame
+        if (assetLoader->getPendingCount() > 0 &&
+            assetLoader->uploadReady(ASSET_UPLOADS_PER_FRAME) > 0 &&
+            assetLoader->getPendingCount() == 0) {
+            assetsLoaded();
         }
 
-        if (destinationBeacon)
-            destinationBeacon->update(dt);
-
-        // housePhysics->update(dt); // MOVED INSIDE IF/ELSE to handle ordering
-        if (destinationBeacon)
-            destinationBeacon->update(dt);
-
-        // Final Physics Update is handled inside the if/else blocks above for
-        // specific modes to ensure correct ordering with camera updates.
-
-        /*/
-        //debugging
-        printf("House Y: %.2f, Balloons: %d, Flying: %d\n",
-                        housePhysics->getPosition().y,
-                        housePhysics->getAttachedBalloonCount(),
-                        housePhysics->isFlying());
-        /*/
-
-        // update ropes
-        for (size_t i = 0; i < balloons.size(); ++i) {
-            if (!balloons[i]->isPopped()) {
-                float angle = (float)i / balloons.size() * 2.0f *
-                    3.14159f; // use size() to be safe
-                float radius = 0.1f;
-                vec3 offset = vec3(cos(angle) * radius, 0.0f, sin(angle) * radius);
-                vec3 chimneyPosLocal = vec3(-0.18f, 5.0f, -2.0f) + offset;
-
-                // Apply House Tilt and Rotation
-                // Must match House::draw transform order
-                mat4 R(1.0f);
-                float tiltAngle = housePhysics->getTiltAngle();
-                vec3 tiltAxis = housePhysics->getTiltAxis();
-                if (abs(tiltAngle) > 0.001f && length(tiltAxis) > 0.001f) {
-                    R = glm::rotate(R, tiltAngle, tiltAxis);
-                }
-
-                float yaw = housePhysics->getRotation().y;
-                if (abs(yaw) > 0.001f) {
-                    R = glm::rotate(R, yaw, vec3(0, 1, 0));
-                }
-
-                vec3 rotatedOffset = vec3(R * vec4(chimneyPosLocal, 1.0f));
-                vec3 anchorPos = housePhysics->getPosition() + rotatedOffset;
-
-                if (balloons[i]->isRopeAttached()) {
-                    balloons[i]->updateAnchor(anchorPos);
-                }
-
-                ropeInstances[i]->updateBezier(anchorPos, balloons[i]->getPosition(),
-                    false, dt);
-            }
-
-            ropeInstances[i]->update(balloons[i]->getRopeStart(),
-                balloons[i]->getPosition());
+        // streamed terrain: ask for the tiles ahead of the house, upload a
+        // few finished ones
+        if (terrainStreamer) {
+            terrainStreamer->update(snapshot->housePosition, snapshot->houseVelocity);
+            terrainStreamer->uploadReady(TERRAIN_UPLOADS_PER_FRAME);
         }
 
-        // collision detection: BALLOONS
-        handleBalloonCollisions();
+        // balloon instances (and their level of detail) for both passes
+        balloonRenderer->update(snapshot->balloons, camera->position,
+            radians(camera->FoV), (float)W_HEIGHT);
+        birdRenderer->update(snapshot->birds, snapshot->birdScale);
+
+        // Task 3.5
+        // Create the depth buffer
+        depth_pass(light_view, light_proj);
 
         // Task 1.5
         // Rendering the scene from light's perspective when F1 is pressed
@@ -1229,11 +1159,21 @@ void mainLoop() {
         }
         //*/
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            PROFILE_ZONE("swapBuffers");
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        PROFILE_GPU_FRAME(gpuTimer);
+        PROFILE_FRAME();
+
+        static bool firstFrame = true;
+        if (firstFrame) {
+            printf("First frame %.0f ms after start\n", glfwGetTime() * 1000.0);
+            firstFrame = false;
+        }
 
-    } // End of balloon loop if you had one, but logic flows better without
-      // wrapping it
+    }
     while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
         glfwWindowShouldClose(window) == 0);
 }
@@ -1302,10 +1242,13 @@ void initialize() {
     // Log
     logGLParameters();
 
-    // initalize terrain
-    mountainTerrain = Terrain::generate(100.0f, 50, 15.0f);
+    // meshes and terrain heights are kept on disk, before the first bake
+    meshCache = new MeshCache(useMeshCache ? MESH_CACHE_DIRECTORY : "");
+    setTerrainCache(meshCache);
+
     // get terrain peak
-    vec3 peak = Terrain::get_terrain_peak() + vec3(5.0f, 0.0f, 0.0f);
+    vec3 peak = Terrain::findPeak(getTerrainHeightfield(), 50) +
+        vec3(5.0f, 0.0f, 0.0f);
 
     // Create camera
     camera = new Camera(window);
@@ -1325,8 +1268,91 @@ void initialize() {
     );
 }
 
-int main(void) {
+// command line: --sim-hz <rate> --max-substeps <n> --time-warp <factor>
+//               --seed <n> (fixed beacon position)
+//               --threads <n> (simulation threads, 0 = all cores)
+//               --birds <n> (size of the bird flock)
+//               --stage-times <n> (simulation stage timings every n steps)
+//               --serial-sim (step the world on the main thread, no overlap)
+//               --profile-every <n> (zone summary every n frames, 0 = off)
+//               --profile-trace <file> (Chrome trace written on exit)
+//               --stream-terrain (endless terrain generated around the house)
+//               --no-cache (parse / generate every mesh, ignore ../cache)
+//               --compact-meshes (interleaved, quantized vertices)
+//               --sync-assets (load every asset before the first frame)
+//               --release-mesh-data (free the CPU copies after upload)
+void parseArguments(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--sim-hz" && hasValue) {
+            simClock.setStepRate((float)atof(argv[++i]));
+        }
+        else if (arg == "--max-substeps" && hasValue) {
+            simClock.setMaxSubsteps(atoi(argv[++i]));
+        }
+        else if (arg == "--time-warp" && hasValue) {
+            simClock.setTimeWarp((float)atof(argv[++i]));
+        }
+        else if (arg == "--seed" && hasValue) {
+            worldConfig.seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--threads" && hasValue) {
+            worldConfig.threads = atoi(argv[++i]);
+        }
+        else if (arg == "--birds" && hasValue) {
+            worldConfig.numBirds = atoi(argv[++i]);
+        }
+        else if (arg == "--stage-times" && hasValue) {
+            worldConfig.stageTimesEvery = atoi(argv[++i]);
+        }
+        else if (arg == "--profile-every" && hasValue) {
+            int frames = atoi(argv[++i]);
+#ifdef ENABLE_PROFILER
+            Profiler::get().setSummaryEvery(frames);
+#else
+            (void)frames;
+            printf("--profile-every: built without the profiler (-DPROFILER=ON)\n");
+#endif
+        }
+        else if (arg == "--profile-trace" && hasValue) {
+            string path = argv[++i];
+#ifdef ENABLE_PROFILER
+            Profiler::get().setTracePath(path);
+#else
+            printf("--profile-trace: built without the profiler (-DPROFILER=ON)\n");
+#endif
+        }
+        else if (arg == "--serial-sim") {
+            pipelineSim = false;
+        }
+        else if (arg == "--stream-terrain") {
+            streamTerrain = true;
+        }
+        else if (arg == "--no-cache") {
+            useMeshCache = false;
+        }
+        else if (arg == "--sync-assets") {
+            syncAssets = true;
+        }
+        else if (arg == "--compact-meshes") {
+            meshFormat.compact = true;
+        }
+        else if (arg == "--release-mesh-data") {
+            meshFormat.releaseCPU = true;
+        }
+        else {
+            printf("Unknown argument: %s\n", arg.c_str());
+        }
+    }
+    printf("Simulation: %.1f Hz, max %d substeps, time warp x%.2f\n",
+        simClock.getStepRate(), simClock.getMaxSubsteps(), simClock.getTimeWarp());
+    setMeshFormat(meshFormat);
+}
+
+int main(int argc, char** argv) {
     try {
+        parseArguments(argc, argv);
         initialize();
         createContext();
         mainLoop();
@@ -1,5 +1,4 @@
 #include "autopilot.h"
-#include "balloons/balloon.h"
 #include <glm/gtx/vector_angle.hpp>
 #include <iostream>
 
@@ -14,7 +13,7 @@ Autopilot::Autopilot()
 
 Autopilot::~Autopilot() {}
 
-void Autopilot::update(House* house, const Beacon* beacon, const std::vector<Balloon*>& balloons, float dt) {
+void Autopilot::update(House* house, const Beacon* beacon, BalloonPool& balloons, float dt) {
     if (!m_enabled || !house || !beacon)
         return;
 
@@ -43,9 +42,9 @@ void Autopilot::update(House* house, const Beacon* beacon, const std::vector<Bal
                 // Release ONLY if we are NOT falling (Velocity > -0.1f implies hovering
                 // or rising)
                 if (m_releaseTimer > 3.0f && house->getVelocity().y > -0.1f) {
-                    for (auto* b : balloons) {
-                        if (b->isRopeAttached()) {
-                            b->release();
+                    for (size_t i = 0; i < balloons.size(); ++i) {
+                        if (balloons.isRopeAttached((int)i)) {
+                            balloons.release((int)i);
                             printf("Autopilot: CENTERED! Releasing balloon for precision "
                                 "landing! Dist: %.2f\n",
                                 dist);
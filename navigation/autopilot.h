@@ -1,20 +1,18 @@
 #pragma once
 
-#include <balloons/balloon.h>
+#include <balloons/balloonPool.h>
 #include <beacon/beacon.h>
 #include <glm/glm.hpp>
 #include <house/house.h>
 #include <vector>
 
-class Balloon;
-
 class Autopilot {
 public:
     Autopilot();
     ~Autopilot();
 
     // Main update function to guide the house
-    void update(House* house, const Beacon* beacon, const std::vector<Balloon*>& balloons, float dt);
+    void update(House* house, const Beacon* beacon, BalloonPool& balloons, float dt);
 
     // Navigation control
     void setEnabled(bool enabled) { m_enabled = enabled; }
@@ -14,8 +14,7 @@ UserNav::UserNav()
 
 UserNav::~UserNav() {}
 
-void UserNav::handleInput(House* house, Camera* camera, float dt,
-    GLFWwindow* window) {
+vec3 UserNav::handleInput(int attachedBalloons, Camera* camera, GLFWwindow* window) {
     // 1. User Controls House (WASD moves House relative to Camera View)
 
     // Need to get camera direction for controls, even if we don't move camera yet
@@ -44,18 +43,19 @@ void UserNav::handleInput(House* house, Camera* camera, float dt,
     if (length(userForce) > 0.001f) {
         // Task: Less balloons = Less control
         // Scale force by ratio of current balloons to threshold (e.g. 8)
-        float balloonFactor = (float)house->getAttachedBalloonCount() /
+        float balloonFactor = (float)attachedBalloons /
             (float)House::BALLOON_THRESHOLD;
 
         // Clamp min to 0.1 (so you aren't totally helpless with 1 balloon) and max
         // to 1.5 (diminishing returns)
         balloonFactor = glm::clamp(balloonFactor, 0.1f, 1.5f);
 
-        house->applyExternalForce(userForce * balloonFactor);
+        userForce *= balloonFactor;
     }
+    return userForce;
 }
 
-void UserNav::updateCamera(House* house, Camera* camera, float dt) {
+void UserNav::updateCamera(const vec3& housePosition, Camera* camera, float dt) {
     // 2. Update Camera (3rd Person View)
 
     // Hack: We want to use the Camera class to handle "Mouse Look" (updating
@@ -69,8 +69,9 @@ void UserNav::updateCamera(House* house, Camera* camera, float dt) {
     camera->speed =
         oldSpeed; // Restore speed for when we switch back to Autopilot
 
-    // Calculate Camera Position relative to House
-    vec3 housePos = house->getPosition();
+    // Calculate Camera Position relative to House (interpolated, so the camera
+    // moves as smoothly as the rendered house)
+    vec3 housePos = housePosition;
 
     // Get camera viewing direction from its internal angles
     vec3 camDir(cos(camera->verticalAngle) * sin(camera->horizontalAngle),
@@ -5,7 +5,6 @@
 #include <vector>
 
 // Forward declarations
-class House;
 class Camera;
 struct GLFWwindow;
 
@@ -15,8 +14,11 @@ public:
 	~UserNav();
 
 	// Split update into two phases to allow Physics Update in between
-	void handleInput(House* house, Camera* camera, float dt, GLFWwindow* window);
-	void updateCamera(House* house, Camera* camera, float dt);
+	// returns the force the house gets on every fixed step of this frame,
+	// scaled by the balloons still attached
+	glm::vec3 handleInput(int attachedBalloons, Camera* camera, GLFWwindow* window);
+	// housePosition: where the house is drawn this frame (interpolated)
+	void updateCamera(const glm::vec3& housePosition, Camera* camera, float dt);
 
 private:
 	float m_distBehind;
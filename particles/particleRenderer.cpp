@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <cstddef>
+#include "particleRenderer.h"
+
+using namespace glm;
+
+ParticleRenderer::ParticleRenderer(int capacity)
+    : m_capacity(capacity), m_count(0), m_VAO(0), m_quadVBO(0), m_instanceVBO(0) {
+    glGenVertexArrays(1, &m_VAO);
+    glBindVertexArray(m_VAO);
+
+    // triangle strip quad
+    const GLfloat corners[] = {
+        -1.0f, -1.0f,
+         1.0f, -1.0f,
+        -1.0f,  1.0f,
+         1.0f,  1.0f
+    };
+    glGenBuffers(1, &m_quadVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+    glEnableVertexAttribArray(0);
+
+    glGenBuffers(1, &m_instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Instance), NULL, GL_STREAM_DRAW);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+        (void*)offsetof(Instance, positionSize));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+        (void*)offsetof(Instance, color));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    glBindVertexArray(0);
+}
+
+ParticleRenderer::~ParticleRenderer() {
+    glDeleteBuffers(1, &m_quadVBO);
+    glDeleteBuffers(1, &m_instanceVBO);
+    glDeleteVertexArrays(1, &m_VAO);
+}
+
+void ParticleRenderer::update(const std::vector<ParticleRenderState>& particles) {
+    m_count = std::min((int)particles.size(), m_capacity);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    // orphan, last frame's draw may still be reading the old storage
+    glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(Instance), NULL, GL_STREAM_DRAW);
+    if (m_count > 0) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, m_count * sizeof(Instance), &particles[0]);
+    }
+}
+
+void ParticleRenderer::draw() const {
+    if (m_count == 0)
+        return;
+    glBindVertexArray(m_VAO);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, m_count);
+}
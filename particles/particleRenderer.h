@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "particleSystem.h"
+
+// Draws every live particle of a ParticleSystem as a camera-facing quad in a
+// single instanced call (shaders/Particle.*). The instance buffer is sized for
+// the pool capacity up front, so drawing does not allocate.
+class ParticleRenderer {
+public:
+    // uploaded as is
+    typedef ParticleRenderState Instance;
+
+    ParticleRenderer(int capacity = ParticleSystem::DEFAULT_CAPACITY);
+    ~ParticleRenderer();
+
+    ParticleRenderer(const ParticleRenderer&) = delete;
+    ParticleRenderer& operator=(const ParticleRenderer&) = delete;
+
+    // the live particles (ParticleSystem::writeRenderStates) into the
+    // instance buffer
+    void update(const std::vector<ParticleRenderState>& particles);
+
+    // particle program in use with V / P set, blending is up to the caller
+    void draw() const;
+
+    int getInstanceCount() const { return m_count; }
+
+private:
+    int m_capacity;
+    int m_count;
+    GLuint m_VAO;
+    GLuint m_quadVBO;
+    GLuint m_instanceVBO;
+};
@@ -1,77 +1,154 @@
 #include "particleSystem.h"
 #include <cmath>
 #include <cstdlib>
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
+#include <common/profiler.h>
+#include <common/threadPool.h>
 
 using namespace glm;
 
+static const float GRAVITY = -9.8f;
+
+// particles per chunk when the update is split across threads
+static const int UPDATE_CHUNK = 4096;
+
 static vec3 randomDir() {
     float theta = ((float)rand() / RAND_MAX) * 2.0f * 3.14159265f;
     float phi = ((float)rand() / RAND_MAX) * 3.14159265f;
     return vec3(sin(phi) * cos(theta), sin(phi) * sin(theta), cos(phi));
 }
 
-ParticleSystem::ParticleSystem(const vec3& origin, vec3& color)
-    : m_color(color), m_persistent(false) {
-    const int COUNT = 100;
+ParticleSystem::ParticleSystem(int capacity)
+    : m_capacity(capacity), m_highWater(0), m_aliveCount(0), m_threads(nullptr) {
+    m_posX.resize(capacity);
+    m_posY.resize(capacity);
+    m_posZ.resize(capacity);
+    m_velX.resize(capacity);
+    m_velY.resize(capacity);
+    m_velZ.resize(capacity);
+    m_life.resize(capacity);
+    m_alive.resize(capacity, 0);
+    m_persistent.resize(capacity, 0);
+    m_initialLife.resize(capacity);
+    m_size.resize(capacity);
+    m_color.resize(capacity);
+    m_free.reserve(capacity);
+}
+
+void ParticleSystem::clear() {
+    for (int i = 0; i < m_highWater; ++i) {
+        m_alive[i] = 0;
+    }
+    m_free.clear();
+    m_highWater = 0;
+    m_aliveCount = 0;
+}
+
+int ParticleSystem::emit(const vec3& position, const vec3& velocity,
+    const vec3& color, float life, float size) {
+    int i;
+    if (!m_free.empty()) {
+        i = m_free.back();
+        m_free.pop_back();
+    }
+    else if (m_highWater < m_capacity) {
+        i = m_highWater++;
+    }
+    else {
+        return -1;
+    }
+
+    m_posX[i] = position.x;
+    m_posY[i] = position.y;
+    m_posZ[i] = position.z;
+    m_velX[i] = velocity.x;
+    m_velY[i] = velocity.y;
+    m_velZ[i] = velocity.z;
+    m_persistent[i] = life <= 0.0f ? 1 : 0;
+    m_life[i] = life;
+    m_initialLife[i] = life;
+    m_size[i] = size;
+    m_color[i] = color;
+    m_alive[i] = 1;
+    m_aliveCount++;
+    return i;
+}
+
+void ParticleSystem::emitPop(const vec3& origin, const vec3& color, int count) {
     const float SPEED = 6.0f;
-    for (int i = 0; i < COUNT; ++i) {
+    const float LIFE = 0.8f;
+    const float SIZE = 0.02f;
+    for (int i = 0; i < count; ++i) {
         vec3 vel = randomDir() * SPEED;
-        m_particles.emplace_back(origin, vel, color);
+        emit(origin, vel, color, LIFE, SIZE);
     }
 }
 
-ParticleSystem* ParticleSystem::createCrashExplosion(const vec3& origin,
-    int count) {
-    ParticleSystem* ps = new ParticleSystem();
-    ps->m_persistent = true;
-    ps->m_color = vec3(1.0f, 0.85f, 0.2f);
+void ParticleSystem::emitCrashExplosion(const vec3& origin, int count) {
     const float SPEED = 10.0f;
+    const float SIZE = 0.08f;
     for (int i = 0; i < count; ++i) {
         vec3 vel = randomDir() * SPEED * (0.5f + (float)rand() / RAND_MAX);
         vel.y = glm::abs(vel.y) * 1.5f;
         vec3 color = vec3(0.9f + 0.1f * (float)rand() / RAND_MAX,
             0.7f + 0.2f * (float)rand() / RAND_MAX,
             0.05f + 0.15f * (float)rand() / RAND_MAX);
-        ps->m_particles.emplace_back(origin, vel, color, true);
+        emit(origin, vel, color, 0.0f, SIZE);
     }
-    return ps;
 }
 
-void ParticleSystem::update(float dt) {
-    for (auto& p : m_particles) {
-        if (!p.persistent && p.life <= 0.0f)
+void ParticleSystem::updateRange(int begin, int end, float dt) {
+    for (int i = begin; i < end; ++i) {
+        if (!m_alive[i])
             continue;
-        p.velocity += vec3(0, -9.8f, 0) * dt;
-        p.position += p.velocity * dt;
-        if (!p.persistent) {
-            p.life -= dt;
+        m_velY[i] += GRAVITY * dt;
+        m_posX[i] += m_velX[i] * dt;
+        m_posY[i] += m_velY[i] * dt;
+        m_posZ[i] += m_velZ[i] * dt;
+        if (!m_persistent[i]) {
+            m_life[i] -= dt;
         }
     }
 }
 
-bool ParticleSystem::isAlive() const {
-    for (const auto& p : m_particles) {
-        if (p.persistent || p.life > 0.0f)
-            return true;
+void ParticleSystem::update(float dt) {
+    PROFILE_ZONE("ParticleSystem::update");
+    if (m_aliveCount == 0)
+        return;
+
+    if (m_threads) {
+        m_threads->parallelFor(m_highWater, UPDATE_CHUNK, [this, dt](int begin, int end) {
+            updateRange(begin, end, dt);
+        });
+    }
+    else {
+        updateRange(0, m_highWater, dt);
+    }
+
+    // recycle the slots that ran out of life
+    for (int i = 0; i < m_highWater; ++i) {
+        if (m_alive[i] && !m_persistent[i] && m_life[i] <= 0.0f) {
+            m_alive[i] = 0;
+            m_free.push_back(i);
+            m_aliveCount--;
+        }
     }
-    return false;
 }
 
-void ParticleSystem::draw(GLuint modelMatrixLocation, Drawable* mesh) const {
-    if (!mesh)
-        return;
-    mesh->bind();
-    for (const auto& p : m_particles) {
-        if (!p.persistent && p.life <= 0.0f)
+float ParticleSystem::getAlpha(int i) const {
+    if (m_persistent[i])
+        return 1.0f;
+    return glm::max(0.0f, m_life[i] / m_initialLife[i]);
+}
+
+void ParticleSystem::writeRenderStates(std::vector<ParticleRenderState>& out) const {
+    out.resize(m_aliveCount);
+    int count = 0;
+    for (int i = 0; i < m_highWater && count < m_aliveCount; ++i) {
+        if (!m_alive[i])
             continue;
-        float alpha = p.persistent ? 1.0f : (p.life / p.initialLife);
-        mat4 M(1.0f);
-        M = translate(M, p.position);
-        float sz = p.persistent ? 0.08f : 0.02f;
-        M = scale(M, vec3(sz));
-        glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE, &M[0][0]);
-        mesh->draw();
+        ParticleRenderState& state = out[count++];
+        state.positionSize = glm::vec4(getPosition(i), m_size[i]);
+        state.color = glm::vec4(m_color[i], getAlpha(i));
     }
-}
\ No newline at end of file
+    out.resize(count);
+}
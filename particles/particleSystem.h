@@ -1,31 +1,82 @@
 #pragma once
-#include "particle.h"
-#include <GL/glew.h>
-#include <common/model.h>
 #include <glm/glm.hpp>
 #include <vector>
 
+class ThreadPool;
 
-using namespace glm;
+// a live particle as ParticleRenderer draws it
+struct ParticleRenderState {
+    glm::vec4 positionSize; // xyz: world position, w: half size
+    glm::vec4 color;        // rgb: colour, a: alpha
+};
 
+// One pool for all the particles of the scene (balloon pops, crash explosion).
+// Structure-of-arrays with a fixed capacity: the arrays are allocated once in
+// the constructor and dead slots are recycled through a free list, so
+// emitting, updating and drawing never allocate. When the pool is full new
+// particles are dropped.
 class ParticleSystem {
 public:
-    ParticleSystem(const vec3& origin, vec3& color);
+    static const int DEFAULT_CAPACITY = 100000;
+
+    ParticleSystem(int capacity = DEFAULT_CAPACITY);
+
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
 
-    // Factory for crash explosion (persistent particles)
-    static ParticleSystem* createCrashExplosion(const vec3& origin, int count = 200);
+    // emitters
+    // balloon pop: short lived burst in the balloon colour
+    void emitPop(const glm::vec3& origin, const glm::vec3& color, int count = 100);
+    // house crash: persistent sparks that never die
+    void emitCrashExplosion(const glm::vec3& origin, int count = 200);
+
+    // one particle, returns its slot or -1 when the pool is full.
+    // life <= 0 makes it persistent
+    int emit(const glm::vec3& position, const glm::vec3& velocity,
+        const glm::vec3& color, float life, float size);
 
-    void spawnExplosion(const vec3& pos, int count);
     void update(float dt);
-    void draw(GLuint modelMatrixLocation, Drawable* mesh) const;
+    void clear();
+
+    // split the update across this pool (null = single threaded)
+    void setThreadPool(ThreadPool* threads) { m_threads = threads; }
+
+    int capacity() const { return m_capacity; }
+    int aliveCount() const { return m_aliveCount; }
+    bool empty() const { return m_aliveCount == 0; }
 
-    bool isAlive() const;
+    // slots [0, highWater) may be alive, the rest was never used
+    int highWater() const { return m_highWater; }
+    bool isAlive(int i) const { return m_alive[i] != 0; }
+    glm::vec3 getPosition(int i) const { return glm::vec3(m_posX[i], m_posY[i], m_posZ[i]); }
+    glm::vec3 getColor(int i) const { return m_color[i]; }
+    float getSize(int i) const { return m_size[i]; }
+    // 1 when emitted, fades to 0 (persistent particles stay at 1)
+    float getAlpha(int i) const;
+
+    // every live particle; out keeps its storage, so this only allocates
+    // while the pool fills up
+    void writeRenderStates(std::vector<ParticleRenderState>& out) const;
 
 private:
-    ParticleSystem()
-        : m_color(vec3(0)), m_persistent(false) {
-    } // private default ctor
-    std::vector<Particle> m_particles;
-    vec3 m_color; // store the color
-    bool m_persistent = false;
+    void updateRange(int begin, int end, float dt);
+
+    int m_capacity;
+    int m_highWater;
+    int m_aliveCount;
+    ThreadPool* m_threads;
+
+    // hot
+    std::vector<float> m_posX, m_posY, m_posZ;
+    std::vector<float> m_velX, m_velY, m_velZ;
+    std::vector<float> m_life;          // seconds remaining
+    std::vector<unsigned char> m_alive;
+    std::vector<unsigned char> m_persistent;
+
+    // cold
+    std::vector<float> m_initialLife;
+    std::vector<float> m_size;
+    std::vector<glm::vec3> m_color;
+
+    std::vector<int> m_free;            // dead slots below m_highWater
 };
@@ -6,10 +6,21 @@ struct RigidBody {
     glm::vec3 velocity;
     glm::vec3 force;
 
+    // position at the start of the last fixed step (render interpolation)
+    glm::vec3 previousPosition;
+
     float mass;
 
     RigidBody()
-        : position(0), velocity(0), force(0), mass(1.0f) {
+        : position(0), velocity(0), force(0), previousPosition(0), mass(1.0f) {
+    }
+
+    void storeState() {
+        previousPosition = position;
+    }
+
+    glm::vec3 interpolatedPosition(float alpha) const {
+        return glm::mix(previousPosition, position, alpha);
     }
 
     void applyForce(const glm::vec3& f) {
@@ -0,0 +1,145 @@
+#include "spatialHash.h"
+#include "collision.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace glm;
+using namespace std;
+
+SpatialHash::SpatialHash(float cellSize)
+    : m_cellSize(1.0f), m_invCellSize(1.0f), m_count(0),
+    m_dirty(true), m_bucketMask(0), m_maxRadius(0.0f) {
+    setCellSize(cellSize);
+}
+
+void SpatialHash::clear() {
+    fill(m_present.begin(), m_present.end(), 0);
+    m_count = 0;
+    m_dirty = true;
+}
+
+void SpatialHash::setCellSize(float cellSize) {
+    if (cellSize <= 0.0f) return;
+
+    m_cellSize = cellSize;
+    m_invCellSize = 1.0f / cellSize;
+    // re-bucket whatever is already in the grid
+    m_dirty = true;
+}
+
+ivec3 SpatialHash::cellOf(const vec3& p) const {
+    return ivec3((int)floor(p.x * m_invCellSize),
+        (int)floor(p.y * m_invCellSize),
+        (int)floor(p.z * m_invCellSize));
+}
+
+int SpatialHash::bucketOf(const ivec3& cell) const {
+    unsigned int h = (unsigned int)cell.x * 73856093u ^ (unsigned int)cell.y * 19349663u ^
+        (unsigned int)cell.z * 83492791u;
+    return (int)(h & (unsigned int)m_bucketMask);
+}
+
+void SpatialHash::rebuild() const {
+    m_dirty = false;
+
+    // about two buckets per object keeps unrelated cells apart
+    int buckets = 16;
+    while (buckets < 2 * m_count) buckets *= 2;
+    m_bucketMask = buckets - 1;
+
+    int ids = (int)m_present.size();
+    m_maxRadius = 0.0f;
+    m_bucket.resize(ids);
+    m_bucketStart.assign(buckets + 1, 0);
+    for (int id = 0; id < ids; ++id) {
+        if (!m_present[id]) continue;
+        int b = bucketOf(cellOf(m_spheres[id].x));
+        m_bucket[id] = b;
+        m_bucketStart[b + 1]++;
+        m_maxRadius = std::max(m_maxRadius, m_spheres[id].r);
+    }
+    for (int b = 0; b < buckets; ++b) {
+        m_bucketStart[b + 1] += m_bucketStart[b];
+    }
+
+    // stable scatter: a bucket lists its objects by increasing id
+    m_order.resize(m_count);
+    m_cursor.assign(m_bucketStart.begin(), m_bucketStart.end() - 1);
+    for (int id = 0; id < ids; ++id) {
+        if (m_present[id]) m_order[m_cursor[m_bucket[id]]++] = id;
+    }
+}
+
+void SpatialHash::update(int id, const Sphere& sphere) {
+    if (id < 0) return;
+
+    if ((size_t)id >= m_present.size()) {
+        m_spheres.resize(id + 1);
+        m_present.resize(id + 1, 0);
+    }
+    if (!m_present[id]) {
+        m_present[id] = 1;
+        m_count++;
+    }
+    m_spheres[id] = sphere;
+    m_dirty = true;
+}
+
+void SpatialHash::remove(int id) {
+    if (!contains(id)) return;
+
+    // stays in its bucket, the queries skip it
+    m_present[id] = 0;
+    m_count--;
+}
+
+bool SpatialHash::contains(int id) const {
+    return id >= 0 && (size_t)id < m_present.size() && m_present[id];
+}
+
+void SpatialHash::gather(const Sphere& sphere, int skipUpTo, vector<int>& out) const {
+    if (m_dirty) rebuild();
+    size_t first = out.size();
+
+    // any object whose center is within r + maxRadius can overlap
+    float reach = sphere.r + m_maxRadius;
+    ivec3 minCell = cellOf(sphere.x - vec3(reach));
+    ivec3 maxCell = cellOf(sphere.x + vec3(reach));
+
+    for (int x = minCell.x; x <= maxCell.x; ++x) {
+        for (int y = minCell.y; y <= maxCell.y; ++y) {
+            for (int z = minCell.z; z <= maxCell.z; ++z) {
+                int b = bucketOf(ivec3(x, y, z));
+                for (int k = m_bucketStart[b]; k < m_bucketStart[b + 1]; ++k) {
+                    int id = m_order[k];
+                    if (id <= skipUpTo || !m_present[id]) continue;
+                    if (checkSphereSphereCollision(sphere, m_spheres[id])) {
+                        out.push_back(id);
+                    }
+                }
+            }
+        }
+    }
+
+    // by id; a bucket shared by two of the cells (hash collision) was
+    // scanned twice
+    sort(out.begin() + first, out.end());
+    out.erase(unique(out.begin() + first, out.end()), out.end());
+}
+
+void SpatialHash::query(const Sphere& sphere, vector<int>& out) const {
+    gather(sphere, -1, out);
+}
+
+void SpatialHash::findPairs(vector<pair<int, int> >& out) const {
+    for (size_t a = 0; a < m_present.size(); ++a) {
+        if (!m_present[a]) continue;
+
+        m_hits.clear();
+        gather(m_spheres[a], (int)a, m_hits);
+        for (size_t i = 0; i < m_hits.size(); ++i) {
+            out.push_back(make_pair((int)a, m_hits[i]));
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <glm/glm.hpp>
+#include "collisionShapes.h"
+
+// Uniform grid broadphase for sphere colliders.
+// Every object lives in the cell of its center; the cell size should be about
+// the diameter of a typical object so a query only touches the neighbouring
+// cells. Objects are addressed by a small integer id (e.g. the balloon index).
+// The cells hash into a fixed table of buckets rebuilt with a counting sort
+// by the first query after an update(), into flat arrays that keep their
+// storage, so re-syncing the grid every step does not allocate. Queries are
+// not thread safe (the rebuild, the findPairs scratch).
+class SpatialHash {
+public:
+    SpatialHash(float cellSize = 1.0f);
+
+    // drops all objects (the arrays are kept allocated)
+    void clear();
+    void setCellSize(float cellSize);
+    float getCellSize() const { return m_cellSize; }
+
+    // insert or move object id
+    void update(int id, const Sphere& sphere);
+    void remove(int id);
+    bool contains(int id) const;
+    int size() const { return m_count; }
+
+    // ids of the objects overlapping the sphere (checkSphereSphereCollision),
+    // sorted by id. Results are appended to out.
+    void query(const Sphere& sphere, std::vector<int>& out) const;
+
+    // every overlapping pair (a < b), sorted by a then b, appended to out
+    void findPairs(std::vector<std::pair<int, int> >& out) const;
+
+private:
+    glm::ivec3 cellOf(const glm::vec3& p) const;
+    int bucketOf(const glm::ivec3& cell) const;
+
+    // buckets from the current spheres, when an update() moved them
+    void rebuild() const;
+
+    // overlapping objects with id > skipUpTo
+    void gather(const Sphere& sphere, int skipUpTo, std::vector<int>& out) const;
+
+    float m_cellSize;
+    float m_invCellSize;
+
+    // per-object data, indexed by id
+    std::vector<Sphere> m_spheres;
+    std::vector<char> m_present;
+    int m_count;
+
+    // buckets, rebuilt from the above: bucket b holds the ids
+    // m_order[m_bucketStart[b] .. m_bucketStart[b + 1]), removed ones
+    // are skipped until the next rebuild
+    mutable bool m_dirty;
+    mutable int m_bucketMask;
+    mutable float m_maxRadius; // largest radius present, widens the query range
+    mutable std::vector<int> m_bucketStart;
+    mutable std::vector<int> m_bucket; // per id
+    mutable std::vector<int> m_order;
+    mutable std::vector<int> m_cursor; // per bucket, scratch for the scatter
+
+    mutable std::vector<int> m_hits; // findPairs scratch
+};
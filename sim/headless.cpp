@@ -0,0 +1,167 @@
+// Headless simulation: builds the same world as the game (house, balloons,
+// ropes, birds, beacon) without a window or GL context and steps it a fixed
+// number of frames, printing the time spent in every step.
+//
+// usage: sim_headless [--frames N] [--dt seconds] [--balloons N] [--birds N]
+//                     [--seed N] [--threads N] [--every K] [--nav]
+//                     [--stage-times K] [--profile-every K] [--profile-trace file]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <algorithm>
+
+#include "world.h"
+#include <common/profiler.h>
+
+using namespace std;
+using namespace glm;
+
+struct HeadlessOptions {
+    int frames = 1000;
+    float dt = 1.0f / 120.0f;   // same step as the game's SimClock
+    int printEvery = 1;         // per-frame line every K frames (0 = off)
+    bool navMode = false;       // start in user navigation (no autopilot)
+    WorldConfig world;
+};
+
+static bool parseArguments(int argc, char** argv, HeadlessOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--frames" && hasValue) {
+            options.frames = atoi(argv[++i]);
+        }
+        else if (arg == "--dt" && hasValue) {
+            options.dt = (float)atof(argv[++i]);
+        }
+        else if (arg == "--balloons" && hasValue) {
+            options.world.numBalloons = atoi(argv[++i]);
+        }
+        else if (arg == "--birds" && hasValue) {
+            options.world.numBirds = atoi(argv[++i]);
+        }
+        else if (arg == "--seed" && hasValue) {
+            options.world.seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--threads" && hasValue) {
+            options.world.threads = atoi(argv[++i]);
+        }
+        else if (arg == "--every" && hasValue) {
+            options.printEvery = atoi(argv[++i]);
+        }
+        else if (arg == "--stage-times" && hasValue) {
+            options.world.stageTimesEvery = atoi(argv[++i]);
+        }
+        else if (arg == "--profile-every" && hasValue) {
+            int frames = atoi(argv[++i]);
+#ifdef ENABLE_PROFILER
+            Profiler::get().setSummaryEvery(frames);
+#else
+            (void)frames;
+            printf("--profile-every: built without the profiler (-DPROFILER=ON)\n");
+#endif
+        }
+        else if (arg == "--profile-trace" && hasValue) {
+            string path = argv[++i];
+#ifdef ENABLE_PROFILER
+            Profiler::get().setTracePath(path);
+#else
+            printf("--profile-trace: built without the profiler (-DPROFILER=ON)\n");
+#endif
+        }
+        else if (arg == "--nav") {
+            options.navMode = true;
+        }
+        else if (arg == "--headless") {
+            // accepted for symmetry with the game's command line
+        }
+        else {
+            printf("Unknown argument: %s\n", arg.c_str());
+            printf("usage: %s [--frames N] [--dt seconds] [--balloons N] "
+                "[--birds N] [--seed N] [--threads N] [--every K] [--nav] "
+                "[--stage-times K] [--profile-every K] [--profile-trace file]\n", argv[0]);
+            return false;
+        }
+    }
+    if (options.frames < 0 || options.dt <= 0.0f) {
+        printf("--frames must be >= 0 and --dt > 0\n");
+        return false;
+    }
+    return true;
+}
+
+static void printState(const World& world) {
+    const House* house = world.house;
+    vec3 p = house->getPosition();
+    vec3 v = house->getVelocity();
+
+    int attached = world.balloons.countAttached();
+
+    printf("house position: (%.3f, %.3f, %.3f)\n", p.x, p.y, p.z);
+    printf("house velocity: (%.3f, %.3f, %.3f)\n", v.x, v.y, v.z);
+    printf("house flying: %d, crashed: %d\n", house->isFlying() ? 1 : 0,
+        world.houseCrashed ? 1 : 0);
+    printf("balloons: %zu total, %d attached, %d popped\n",
+        world.balloons.size(), attached, world.countPoppedBalloons());
+    printf("particles alive: %d\n", world.particles.aliveCount());
+    if (world.beacon) {
+        vec3 b = world.beacon->getPosition();
+        printf("beacon: (%.3f, %.3f, %.3f), distance %.3f\n", b.x, b.y, b.z,
+            length(b - p));
+    }
+}
+
+int main(int argc, char** argv) {
+    HeadlessOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        return 1;
+    }
+
+    typedef chrono::high_resolution_clock Clock;
+
+    Clock::time_point setupStart = Clock::now();
+    World world(options.world);
+    if (options.navMode) {
+        world.toggleMode();
+    }
+    double setupMs = chrono::duration<double, milli>(Clock::now() - setupStart).count();
+    printf("world setup: %.3f ms\n", setupMs);
+
+    PROFILE_THREAD("main");
+    double totalMs = 0.0, minMs = 1e30, maxMs = 0.0;
+    for (int frame = 0; frame < options.frames; ++frame) {
+        Clock::time_point start = Clock::now();
+        world.step(options.dt);
+        double ms = chrono::duration<double, milli>(Clock::now() - start).count();
+        PROFILE_FRAME();
+
+        totalMs += ms;
+        minMs = std::min(minMs, ms);
+        maxMs = std::max(maxMs, ms);
+
+        if (options.printEvery > 0 && frame % options.printEvery == 0) {
+            printf("frame %d: %.4f ms (house y %.3f)\n", frame, ms,
+                world.house->getPosition().y);
+        }
+    }
+
+    printf("---\n");
+    if (options.frames > 0) {
+        double avgMs = totalMs / options.frames;
+        printf("%d frames of %.5f s (%.3f s simulated)\n", options.frames,
+            options.dt, options.frames * options.dt);
+        printf("step time: avg %.4f ms, min %.4f ms, max %.4f ms, total %.3f ms\n",
+            avgMs, minMs, maxMs, totalMs);
+        if (totalMs > 0.0) {
+            printf("steps per second: %.1f\n", 1000.0 * options.frames / totalMs);
+        }
+    }
+    printState(world);
+#ifdef ENABLE_PROFILER
+    Profiler::get().writeTrace();
+#endif
+
+    return 0;
+}
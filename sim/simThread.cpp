@@ -0,0 +1,103 @@
+#include "simThread.h"
+
+#include <common/profiler.h>
+
+using namespace std;
+
+SimThread::SimThread(World& world, bool pipelined)
+    : m_world(world), m_pipelined(pipelined), m_front(0),
+    m_steps(0), m_dt(0.0f), m_alpha(1.0f),
+    m_started(0), m_finished(0), m_quit(false) {
+    // something to draw before the first batch
+    m_world.writeSnapshot(m_snapshots[0], 1.0f);
+
+    if (m_pipelined) {
+        m_thread = thread(&SimThread::threadLoop, this);
+    }
+}
+
+SimThread::~SimThread() {
+    if (!m_thread.joinable()) return;
+    finish();
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+const RenderSnapshot& SimThread::start(const SimInput& input, int steps, float dt, float alpha) {
+    // one batch in flight at a time
+    finish();
+    const RenderSnapshot& previous = getSnapshot();
+
+    m_input = input;
+    m_steps = steps;
+    m_dt = dt;
+    m_alpha = alpha;
+
+    if (!m_pipelined) {
+        runBatch();
+        return getSnapshot();
+    }
+
+    {
+        // publishes the parameters above to the simulation thread
+        lock_guard<mutex> lock(m_mutex);
+        m_started++;
+    }
+    m_wake.notify_one();
+    return previous;
+}
+
+void SimThread::finish() {
+    // the usual case when the simulation is faster than the rendering
+    if (m_finished.load(memory_order_acquire) == m_started.load(memory_order_relaxed)) return;
+
+    PROFILE_ZONE("SimThread::finish");
+    unique_lock<mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_finished.load(memory_order_acquire) == m_started.load(); });
+}
+
+void SimThread::threadLoop() {
+    PROFILE_THREAD("simulation");
+    unsigned done = 0;
+    for (;;) {
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_quit || m_started.load() != done; });
+            if (m_quit) return;
+        }
+
+        runBatch();
+
+        done++;
+        m_finished.store(done, memory_order_release);
+        {
+            // finish() may be between its check and its wait
+            lock_guard<mutex> lock(m_mutex);
+        }
+        m_done.notify_one();
+    }
+}
+
+void SimThread::runBatch() {
+    PROFILE_ZONE("SimThread::batch");
+    if (m_input.toggleMode) m_world.toggleMode();
+    if (m_input.releaseBalloon) m_world.releaseNextBalloon();
+    if (m_input.popAll) m_world.popAllBalloons();
+    // the mode the input was made for may be a frame old
+    if (m_input.steer && m_world.mode == NAV_MODE) {
+        m_world.setControlForce(m_input.controlForce);
+    }
+
+    for (int i = 0; i < m_steps; ++i) {
+        m_world.step(m_dt);
+    }
+
+    // the main thread reads the front one until it starts the next batch
+    int back = 1 - m_front.load(memory_order_relaxed);
+    m_world.writeSnapshot(m_snapshots[back], m_alpha);
+    m_front.store(back, memory_order_release);
+}
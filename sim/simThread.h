@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <glm/glm.hpp>
+
+#include "world.h"
+
+// Player actions of one frame, applied before the frame's steps.
+struct SimInput {
+    bool releaseBalloon = false;
+    bool popAll = false;
+    bool toggleMode = false;
+    // NAV_MODE steering, held for all steps of the frame
+    bool steer = false;
+    glm::vec3 controlForce = glm::vec3(0.0f);
+};
+
+// Steps the World on its own thread, one batch of fixed steps per frame, so
+// that the next frame is simulated while the main thread draws this one.
+//
+// Every batch ends by writing a RenderSnapshot into the back one of two
+// buffers and publishing it by flipping an atomic index. The main thread only
+// reads the front one and the simulation only writes the other, so neither
+// side locks for the snapshot; starting a batch and waiting for it (once per
+// frame) are the only places that touch a mutex, to let the threads sleep.
+// The frame drawn is the one simulated during the previous frame: one frame
+// of latency for a frame time of max(sim, render) instead of their sum.
+//
+// While a batch runs nobody else may touch the World.
+class SimThread {
+public:
+    // pipelined = false runs every batch right inside start(), no thread
+    SimThread(World& world, bool pipelined = true);
+    ~SimThread();
+
+    SimThread(const SimThread&) = delete;
+    SimThread& operator=(const SimThread&) = delete;
+
+    // applies input, runs steps fixed steps of dt and snapshots the world at
+    // alpha; returns the snapshot to draw this frame, the previous batch's
+    // (this batch's when not pipelined), valid until the next finish()
+    const RenderSnapshot& start(const SimInput& input, int steps, float dt, float alpha);
+    // waits for the batch in flight
+    void finish();
+
+    // newest finished snapshot; call after finish()
+    const RenderSnapshot& getSnapshot() const { return m_snapshots[m_front.load(std::memory_order_acquire)]; }
+    bool isPipelined() const { return m_pipelined; }
+
+private:
+    void threadLoop();
+    void runBatch();
+
+    World& m_world;
+    bool m_pipelined;
+
+    RenderSnapshot m_snapshots[2];
+    std::atomic<int> m_front;           // the one the main thread may read
+
+    // batch parameters, written by start() before the batch is released
+    SimInput m_input;
+    int m_steps;
+    float m_dt;
+    float m_alpha;
+
+    std::atomic<unsigned> m_started;    // batches released
+    std::atomic<unsigned> m_finished;   // batches done
+    std::mutex m_mutex;                 // sleeping only
+    std::condition_variable m_wake;     // simulation thread: a batch to run
+    std::condition_variable m_done;     // main thread: the batch is done
+    bool m_quit;                        // guarded by m_mutex
+    std::thread m_thread;
+};
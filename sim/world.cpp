@@ -0,0 +1,498 @@
+#include "world.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <balloons/balloonTypes.h>
+#include <balloons/rope.h>
+#include <common/profiler.h>
+#include <common/taskGraph.h>
+#include <common/threadPool.h>
+#include <physics/collision.h>
+#include <terrain/heightfield.h>
+#include <terrain/terrain.h>
+
+using namespace glm;
+using namespace std;
+
+constexpr float World::TERRAIN_SIZE;
+constexpr float World::TERRAIN_MAX_HEIGHT;
+constexpr float World::WATER_LEVEL;
+
+static MeshCache* terrainCache = nullptr;
+
+void setTerrainCache(MeshCache* cache) {
+    terrainCache = cache;
+}
+
+static Heightfield bakeTerrainHeightfield() {
+    Heightfield field;
+    if (terrainCache) {
+        field.bake(World::TERRAIN_SIZE, World::TERRAIN_RESOLUTION,
+            World::TERRAIN_MAX_HEIGHT, *terrainCache);
+    }
+    else {
+        field.bake(World::TERRAIN_SIZE, World::TERRAIN_RESOLUTION,
+            World::TERRAIN_MAX_HEIGHT);
+    }
+    return field;
+}
+
+const Heightfield& getTerrainHeightfield() {
+    static const Heightfield field = bakeTerrainHeightfield();
+    return field;
+}
+
+float getTerrainHeightAt(float x, float z) {
+    const Heightfield& field = getTerrainHeightfield();
+    if (field.contains(x, z)) {
+        return field.height(x, z);
+    }
+    // off the baked square (streamed terrain), same function as the tiles
+    return Terrain::sampleHeight(x, z, World::TERRAIN_SIZE, World::TERRAIN_MAX_HEIGHT);
+}
+
+World::World(const WorldConfig& config, const WorldMeshes& meshes)
+    : house(nullptr), beacon(nullptr),
+    houseCrashed(false), mode(SEARCH_MODE),
+    m_threads(nullptr),
+    m_dt(0.0f), m_steps(0), m_preUpdateVelocity(0.0f), m_stageTimesEvery(config.stageTimesEvery),
+    m_controlForce(0.0f),
+    m_balloonGrid(2.0f), m_balloonMin(0.0f), m_balloonMax(0.0f) {
+    if (config.threads != 1) {
+        m_threads = new ThreadPool(config.threads);
+        balloons.setThreadPool(m_threads);
+        particles.setThreadPool(m_threads);
+        birds.setThreadPool(m_threads);
+        printf("Simulation on %d threads\n", m_threads->getThreadCount());
+    }
+
+    if (config.seed != 0) {
+        srand(config.seed);
+    }
+
+    // the house sits next to the terrain peak (coarse grid, as the game does)
+    const Heightfield& terrain = getTerrainHeightfield();
+    m_peak = Terrain::findPeak(terrain, 50, m_threads) + vec3(5.0f, 0.0f, 0.0f);
+    house = new House(meshes.house, m_peak);
+    house->setTerrainHeightFunction(getTerrainHeightAt);
+
+    // destination beacon
+    vec3 beaconPos = Beacon::generateRandomBeaconPosition(terrain, m_peak, config.seed);
+    beacon = new Beacon(beaconPos, 4.0f, 40.0f);
+    // debugging
+    printf("Beacon created at position: (%.2f, %.2f, %.2f)\n", beaconPos.x,
+        beaconPos.y, beaconPos.z);
+
+    spawnBalloons(config);
+    spawnBirds(config);
+
+    // one balloon diameter per cell
+    if (!balloons.empty()) {
+        m_balloonGrid.setCellSize(2.0f * balloons.getRadius(0));
+    }
+
+    buildStepGraph();
+}
+
+World::~World() {
+    balloons.clear();
+    for (auto* r : ropeInstances) {
+        delete r;
+    }
+    ropeInstances.clear();
+    birds.clear();
+    delete beacon;
+    delete house;
+    delete m_threads;
+}
+
+void World::spawnBalloons(const WorldConfig& config) {
+    // multiple balloons around the center of the chimney
+    vec3 chimneyOffset = vec3(-0.18f, 5.0f, -2.0f);
+    vec3 chimneyPos = m_peak + chimneyOffset;
+
+    balloons.reserve(config.numBalloons);
+    ropeInstances.reserve(config.numBalloons);
+
+    for (int i = 0; i < config.numBalloons; ++i) {
+        // transparent ones get the banana inside (see BalloonPool::getContentMatrix)
+        BalloonType type = getBalloonTypeByIndex(i);
+
+        // put them in a circle
+        float angle = (float)i / config.numBalloons * 2.0f * 3.14159f;
+        float radius = 0.01f; // radius around chimneyPos
+        vec3 offset = vec3(cos(angle) * radius, 0.0f, sin(angle) * radius);
+
+        balloons.add(type, chimneyPos + offset, Rope::DEFAULT_LENGTH);
+
+        // create corresponding rope
+        RopeInstance* newRope = new RopeInstance(Rope::DEFAULT_LENGTH);
+        ropeInstances.push_back(newRope);
+    }
+    printf("Created %d balloons\n", config.numBalloons);
+}
+
+void World::spawnBirds(const WorldConfig& config) {
+    // every bird circles the balloons at its own radius and height, some
+    // close enough to reach them; they start on their orbits, flying along
+    vec3 target = findBirdTarget();
+    float speed = birds.getParams().cruiseSpeed;
+    birds.setTarget(target);
+    birds.reserve(config.numBirds);
+
+    for (int i = 0; i < config.numBirds; ++i) {
+        float angle = (float)i / config.numBirds * 6.28318f;
+        float r = 3.0f + (i % 7) * 4.5f;
+        float h = (i % 5) * 2.0f - 2.0f;
+        vec3 radial = vec3(cos(angle), 0.0f, sin(angle));
+        vec3 tangent = vec3(-radial.z, 0.0f, radial.x);
+        // out of step so the flock does not flap in unison
+        float phase = (i % 13) * 0.13f;
+
+        birds.add(target + radial * r + vec3(0.0f, h, 0.0f), tangent * speed, r, h, phase);
+    }
+    printf("Spawned %d birds\n", config.numBirds);
+}
+
+void World::releaseNextBalloon() {
+    // first available balloon to be released
+    for (int i = 0; i < (int)balloons.size(); ++i) {
+        if (balloons.isRopeAttached(i) && !balloons.isPopped(i)) {
+            balloons.release(i);
+            printf("Balloon %d was RELEASED!\n", i);
+            break;
+        }
+    }
+}
+
+void World::popAllBalloons() {
+    // pop ALL attached balloons at once and spawn particles for each
+    for (int i = 0; i < (int)balloons.size(); ++i) {
+        if (!balloons.isPopped(i) && balloons.isRopeAttached(i)) {
+            balloons.pop(i);
+            m_balloonGrid.remove(i);
+            particles.emitPop(balloons.getPosition(i), balloons.getColor(i));
+            printf("Balloon %d POPPED!\n", i);
+        }
+    }
+}
+
+void World::toggleMode() {
+    mode = (mode == SEARCH_MODE) ? NAV_MODE : SEARCH_MODE;
+
+    if (mode == NAV_MODE) {
+        // Switch to User Nav: Disable Autopilot, House Physics ON
+        autopilot.setEnabled(false);
+        printf("Switched to USER NAVIGATION MODE\n");
+    }
+    else {
+        // Switch to Autopilot: Enable Autopilot
+        autopilot.setEnabled(true);
+        m_controlForce = vec3(0.0f);
+        printf("Switched to AUTOPILOT SEARCH MODE\n");
+    }
+}
+
+void World::writeSnapshot(RenderSnapshot& out, float alpha) const {
+    PROFILE_ZONE("World::writeSnapshot");
+    out.steps = m_steps;
+    out.mode = mode;
+    out.houseCrashed = houseCrashed;
+    out.houseModel = house->getModelMatrix(alpha);
+    out.housePosition = house->getRenderPosition(alpha);
+    out.houseVelocity = house->getVelocity();
+    out.attachedBalloons = house->getAttachedBalloonCount();
+
+    balloons.writeRenderStates(out.balloons, alpha);
+
+    // bezier curves of the balloons, verlet chains of the popped ones
+    const RopeWorld& verletRopes = balloons.getRopes();
+    int bezierPoints = RopeInstance::SEGMENTS + 1;
+    out.ropePoints.clear();
+    out.ropeSizes.clear();
+    for (int i = 0; i < (int)balloons.size(); ++i) {
+        int r = balloons.getVerletRope(i);
+        size_t at = out.ropePoints.size();
+        if (balloons.isPopped(i) && r >= 0) {
+            int first = verletRopes.getOffset(r);
+            int count = verletRopes.getPointCount(r);
+            out.ropePoints.resize(at + count);
+            for (int p = 0; p < count; ++p) {
+                out.ropePoints[at + p] = verletRopes.getRenderPoint(first + p, alpha);
+            }
+            out.ropeSizes.push_back(count);
+        }
+        else {
+            out.ropePoints.resize(at + bezierPoints);
+            ropeInstances[i]->getRenderPoints(alpha, &out.ropePoints[at]);
+            out.ropeSizes.push_back(bezierPoints);
+        }
+    }
+
+    birds.writeRenderStates(out.birds, alpha);
+    out.birdScale = birds.getScale();
+    particles.writeRenderStates(out.particles);
+
+    out.hasBeacon = beacon != nullptr;
+    out.beaconTime = beacon ? beacon->getAnimationTime() : 0.0f;
+}
+
+int World::countPoppedBalloons() const {
+    return balloons.countPopped();
+}
+
+void World::step(float dt) {
+    PROFILE_ZONE("World::step");
+    // snapshot the state at the start of the step for render interpolation
+    house->storePreviousState();
+    balloons.storePreviousState();
+    for (auto* rope : ropeInstances) {
+        rope->storePreviousState();
+    }
+    birds.storePreviousState();
+
+    // the flock chases the balloons where they are at the start of the step,
+    // so it can move while they do
+    birds.setTarget(findBirdTarget());
+
+    m_dt = dt;
+    m_stepGraph.run(m_threads);
+    m_steps++;
+
+    if (m_stageTimesEvery > 0 && m_stepGraph.getRunCount() >= m_stageTimesEvery) {
+        m_stepGraph.printTimings("World::step stages");
+        m_stepGraph.resetTimings();
+    }
+}
+
+// The stages of step(), in the order they used to run. The first five only
+// touch their own objects; everything from the pops on reads and writes the
+// balloons and runs in a chain.
+void World::buildStepGraph() {
+    typedef TaskGraph::Stage Stage;
+    TaskGraph& graph = m_stepGraph;
+
+    // pop bursts die off, crash sparks are persistent
+    Stage particleStage = graph.add("particles", [this] { particles.update(m_dt); });
+    // update all balloons (batched forces + integration)
+    Stage balloonStage = graph.add("balloons", [this] {
+        balloons.updateBodies(m_dt);
+        syncBalloonGrid();
+    });
+    // the falling ropes of the popped balloons
+    Stage ropeStage = graph.add("verlet ropes", [this] { balloons.updateRopes(m_dt); });
+    Stage birdStage = graph.add("birds", [this] { birds.update(m_dt); });
+    graph.add("beacon", [this] {
+        // (twice per step, as the original loop did)
+        if (beacon) {
+            beacon->update(m_dt);
+            beacon->update(m_dt);
+        }
+    });
+
+    // Task 6: check bird-balloon collisions, pops add verlet ropes and particles
+    Stage popStage = graph.add("bird collisions", [this] { handleBirdCollisions(); },
+        {particleStage, balloonStage, ropeStage, birdStage});
+
+    // --- PHYSICS STEP START ---
+    Stage forceStage = graph.add("house forces", [this] {
+        // Track velocity before physics update for crash detection
+        m_preUpdateVelocity = house->getVelocity();
+
+        // 1. Apply House Internal Forces (Gravity, Lift, Drag)
+        // IMPORTANT: This resets m_body.force to 0 and applies internal forces, so
+        // it MUST be called first!
+        if (!houseCrashed) {
+            house->applyForces(balloons, nullptr);
+        }
+    }, {popStage});
+
+    // Movement Logic based on Mode
+    Stage steerStage = graph.add("autopilot", [this] {
+        if (mode == SEARCH_MODE) {
+            // --- AUTOPILOT MODE ---
+            if (beacon) {
+                autopilot.update(house, beacon, balloons, m_dt);
+            }
+        }
+        else if (!houseCrashed) {
+            // --- USER NAVIGATION MODE ---
+            house->applyExternalForce(m_controlForce);
+        }
+    }, {forceStage});
+
+    Stage houseStage = graph.add("house integrate", [this] { integrateHouse(m_dt); },
+        {steerStage});
+    Stage anchorStage = graph.add("rope anchors", [this] { updateRopes(m_dt); },
+        {houseStage});
+
+    // collision detection: BALLOONS
+    graph.add("balloon collisions", [this] {
+        syncBalloonGrid();
+        handleBalloonCollisions();
+    }, {anchorStage});
+}
+
+void World::integrateHouse(float dt) {
+    // Physics Update (Move House based on forces)
+    if (!houseCrashed) { house->update(dt); }
+
+    // --- CRASH DETECTION ---
+    if (!houseCrashed && m_preUpdateVelocity.y < -8.0f) {
+        // Check if house is now on/in the ground
+        float terrainH = getTerrainHeightAt(house->getPosition().x,
+            house->getPosition().z);
+        if (house->getPosition().y <= terrainH + 1.0f) {
+            houseCrashed = true;
+            particles.emitCrashExplosion(house->getPosition(), 200);
+            printf("HOUSE CRASHED! Velocity was %.2f\n", m_preUpdateVelocity.y);
+            // Release all remaining balloons
+            for (int i = 0; i < (int)balloons.size(); ++i) {
+                if (!balloons.isPopped(i) && balloons.isRopeAttached(i)) {
+                    balloons.release(i);
+                }
+            }
+        }
+    }
+}
+
+void World::syncBalloonGrid() {
+    m_balloonMin = vec3(1e30f);
+    m_balloonMax = vec3(-1e30f);
+    for (int i = 0; i < (int)balloons.size(); ++i) {
+        if (balloons.isPopped(i)) {
+            m_balloonGrid.remove(i);
+            continue;
+        }
+
+        Sphere s;
+        s.x = balloons.getPosition(i);
+        s.r = balloons.getRadius(i);
+        m_balloonGrid.update(i, s);
+        m_balloonMin = glm::min(m_balloonMin, s.x - s.r);
+        m_balloonMax = glm::max(m_balloonMax, s.x + s.r);
+    }
+}
+
+vec3 World::findBirdTarget() const {
+    vec3 sum(0.0f);
+    int count = 0;
+    for (int i = 0; i < (int)balloons.size(); ++i) {
+        if (balloons.isRopeAttached(i) && !balloons.isPopped(i)) {
+            sum += balloons.getPosition(i);
+            count++;
+        }
+    }
+    vec3 target = count > 0 ? sum / (float)count : house->getPosition() + vec3(0.0f, 8.0f, 0.0f);
+    // stay clear of the terrain
+    target.y = std::max(target.y, m_peak.y + 5.0f);
+    return target;
+}
+
+void World::handleBirdCollisions() {
+    PROFILE_ZONE("handleBirdCollisions");
+    for (int b = 0; b < (int)birds.size(); ++b) {
+        Sphere birdSphere;
+        birdSphere.x = birds.getPosition(b);
+        birdSphere.r = birds.getCollisionRadius(b);
+
+        // nowhere near the balloons
+        if (any(lessThan(birdSphere.x + birdSphere.r, m_balloonMin)) ||
+            any(greaterThan(birdSphere.x - birdSphere.r, m_balloonMax)))
+            continue;
+
+        // balloons touching the bird, lowest index first
+        m_hits.clear();
+        m_balloonGrid.query(birdSphere, m_hits);
+        if (m_hits.empty())
+            continue;
+
+        int i = m_hits[0];
+        balloons.pop(i);
+        m_balloonGrid.remove(i);
+        // Spawn pop particles
+        particles.emitPop(balloons.getPosition(i), balloons.getColor(i));
+        printf("Bird popped balloon %d!\n", i);
+        // One pop per bird per frame
+    }
+}
+
+void World::updateRopes(float dt) {
+    for (int i = 0; i < (int)balloons.size(); ++i) {
+        if (!balloons.isPopped(i)) {
+            float angle = (float)i / balloons.size() * 2.0f *
+                3.14159f; // use size() to be safe
+            float radius = 0.1f;
+            vec3 offset = vec3(cos(angle) * radius, 0.0f, sin(angle) * radius);
+            vec3 chimneyPosLocal = vec3(-0.18f, 5.0f, -2.0f) + offset;
+
+            // Apply House Tilt and Rotation
+            // Must match House::draw transform order
+            mat4 R(1.0f);
+            float tiltAngle = house->getTiltAngle();
+            vec3 tiltAxis = house->getTiltAxis();
+            if (abs(tiltAngle) > 0.001f && length(tiltAxis) > 0.001f) {
+                R = glm::rotate(R, tiltAngle, tiltAxis);
+            }
+
+            float yaw = house->getRotation().y;
+            if (abs(yaw) > 0.001f) {
+                R = glm::rotate(R, yaw, vec3(0, 1, 0));
+            }
+
+            vec3 rotatedOffset = vec3(R * vec4(chimneyPosLocal, 1.0f));
+            vec3 anchorPos = house->getPosition() + rotatedOffset;
+
+            if (balloons.isRopeAttached(i)) {
+                balloons.updateAnchor(i, anchorPos);
+            }
+
+            ropeInstances[i]->updateBezier(anchorPos, balloons.getPosition(i),
+                false, dt);
+        }
+
+        ropeInstances[i]->update(balloons.getRopeStart(i),
+            balloons.getPosition(i));
+    }
+}
+
+// collision detection: BALLOONS
+// candidate pairs come from the grid (same i < j order as the old all-pairs
+// loop), the exact test uses the current positions since earlier pairs may
+// already have pushed a balloon
+void World::handleBalloonCollisions() {
+    PROFILE_ZONE("handleBalloonCollisions");
+    m_pairs.clear();
+    m_balloonGrid.findPairs(m_pairs);
+
+    for (size_t p = 0; p < m_pairs.size(); ++p) {
+        int i = m_pairs[p].first;
+        int j = m_pairs[p].second;
+
+        // sphere structs
+        Sphere s1, s2;
+        s1.x = balloons.getPosition(i);
+        s1.r = balloons.getRadius(i);
+
+        s2.x = balloons.getPosition(j);
+        s2.r = balloons.getRadius(j);
+
+        // check for collision
+        if (checkSphereSphereCollision(s1, s2)) {
+            vec3 vel1 = balloons.getVelocity(i);
+            vec3 vel2 = balloons.getVelocity(j);
+
+            // collsiion handling
+            handleSphereSphereCollision(s1, s2, vel1, vel2,
+                balloons.getMass(i), balloons.getMass(j));
+
+            // update positions
+            balloons.setVelocity(i, vel1);
+            balloons.setVelocity(j, vel2);
+            balloons.setPosition(i, s1.x);
+            balloons.setPosition(j, s2.x);
+        }
+    }
+}
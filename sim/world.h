@@ -0,0 +1,157 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include <balloons/balloonPool.h>
+#include <balloons/ropeInstance.h>
+#include <beacon/beacon.h>
+#include <common/taskGraph.h>
+#include <enemies/birdFlock.h>
+#include <house/house.h>
+#include <navigation/autopilot.h>
+#include <particles/particleSystem.h>
+#include <physics/spatialHash.h>
+
+class Drawable;
+class Heightfield;
+class MeshCache;
+class ThreadPool;
+
+// task 7: user navigation
+enum GameMode { SEARCH_MODE, NAV_MODE };
+
+// world parameters (the defaults are the game's scene)
+struct WorldConfig {
+    int numBalloons = 15;       // AMOUNT OF BALLOONS
+    int numBirds = 10;          // AMOUNT OF BIRDS
+    unsigned int seed = 0;      // 0 -> random beacon position every run
+    int threads = 1;            // simulation threads, 0 = all cores
+    int stageTimesEvery = 0;    // steps between stage timing dumps, 0 = never
+};
+
+// render resources shared by the sim objects, all null when running headless
+struct WorldMeshes {
+    Drawable* house = nullptr;
+};
+
+// Everything the renderer reads of the world, interpolated for one frame.
+// The renderer draws from a snapshot and never touches the World, so the
+// next steps can run meanwhile (see SimThread).
+struct RenderSnapshot {
+    int steps = 0;                  // fixed steps simulated so far
+    GameMode mode = SEARCH_MODE;
+    bool houseCrashed = false;
+    glm::mat4 houseModel = glm::mat4(1.0f);     // House::getModelMatrix
+    glm::vec3 housePosition = glm::vec3(0.0f);  // interpolated
+    glm::vec3 houseVelocity = glm::vec3(0.0f);
+    int attachedBalloons = 0;       // user navigation scales by it
+
+    std::vector<BalloonRenderState> balloons;   // not popped
+    // the rope of every balloon (bezier, or verlet chain once popped) as
+    // polylines back to back, ropeSizes[r] points each
+    std::vector<glm::vec3> ropePoints;
+    std::vector<int> ropeSizes;
+    std::vector<BirdRenderState> birds;
+    float birdScale = 1.0f;
+    std::vector<ParticleRenderState> particles;
+
+    bool hasBeacon = false;
+    float beaconTime = 0.0f;
+};
+
+// The simulated scene: house, balloons and their ropes, bird flock, beacon and
+// particles. It never touches OpenGL, so it can be stepped without a window.
+class World {
+public:
+    static constexpr float TERRAIN_SIZE = 100.0f;
+    static constexpr float TERRAIN_MAX_HEIGHT = 15.0f;
+    static constexpr float WATER_LEVEL = -2.0f;
+    // grid of the baked terrain heightfield (0.25 units per cell)
+    static const int TERRAIN_RESOLUTION = 400;
+
+    World(const WorldConfig& config = WorldConfig(),
+        const WorldMeshes& meshes = WorldMeshes());
+    ~World();
+
+    // advances the whole simulation by one fixed step of dt seconds
+    void step(float dt);
+
+    // player actions
+    void releaseNextBalloon();
+    void popAllBalloons();
+    void toggleMode();
+
+    // force applied to the house every step while in NAV_MODE
+    void setControlForce(const glm::vec3& force) { m_controlForce = force; }
+
+    // render state between the last two steps (alpha 0 = previous, 1 =
+    // current); out keeps its storage from frame to frame
+    void writeSnapshot(RenderSnapshot& out, float alpha) const;
+    int getStepCount() const { return m_steps; }
+
+    // stats
+    int countPoppedBalloons() const;
+    glm::vec3 getPeak() const { return m_peak; }
+
+public:
+    House* house;
+    BalloonPool balloons;
+    std::vector<RopeInstance*> ropeInstances;
+    BirdFlock birds;
+    Beacon* beacon;
+
+    // task 8: house crash
+    bool houseCrashed;
+
+    // pop bursts and crash sparks, one pool for the whole scene
+    ParticleSystem particles;
+
+    // task 5: autopilot to beacon
+    Autopilot autopilot;
+    GameMode mode;
+
+private:
+    void spawnBalloons(const WorldConfig& config);
+    void spawnBirds(const WorldConfig& config);
+
+    void handleBalloonCollisions();
+    // the stages of step() and their order
+    void buildStepGraph();
+
+    void handleBirdCollisions();
+    // house physics and crash detection
+    void integrateHouse(float dt);
+    void updateRopes(float dt);
+
+    // moves the live balloons in the broadphase grid, drops popped ones
+    void syncBalloonGrid();
+    // where the flock goes: the attached balloons, or over the house
+    glm::vec3 findBirdTarget() const;
+
+    ThreadPool* m_threads;
+    TaskGraph m_stepGraph;
+    float m_dt;                     // of the step being run
+    int m_steps;
+    glm::vec3 m_preUpdateVelocity;  // house, before this step's forces
+    int m_stageTimesEvery;
+
+    glm::vec3 m_peak;
+    glm::vec3 m_controlForce;
+
+    // broadphase for balloon-balloon and bird-balloon tests (id = balloon index)
+    SpatialHash m_balloonGrid;
+    std::vector<std::pair<int, int> > m_pairs;
+    std::vector<int> m_hits;
+    // bounds of the live balloons, birds outside skip the grid query
+    glm::vec3 m_balloonMin, m_balloonMax;
+};
+
+// terrain of the scene, baked on first use and shared by the simulation and
+// the renderer
+const Heightfield& getTerrainHeightfield();
+// the first getTerrainHeightfield() bakes through this cache (null = always bake)
+void setTerrainCache(MeshCache* cache);
+
+// terrain height of the scene, used for house and crash collisions
+float getTerrainHeightAt(float x, float z);
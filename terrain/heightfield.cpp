@@ -0,0 +1,132 @@
+#include "heightfield.h"
+#include "terrain.h"
+#include <algorithm>
+#include <common/meshCache.h>
+
+using namespace glm;
+
+Heightfield::Heightfield()
+    : m_size(0.0f), m_resolution(0), m_maxHeight(0.0f), m_step(0.0f),
+    m_originX(0.0f), m_originZ(0.0f) {
+}
+
+Heightfield::Heightfield(float size, int resolution, float maxHeight)
+    : Heightfield() {
+    bake(size, resolution, maxHeight);
+}
+
+void Heightfield::bake(float size, int resolution, float maxHeight) {
+    bake(-size / 2.0f, -size / 2.0f, size, resolution, size, maxHeight);
+}
+
+void Heightfield::setGrid(float originX, float originZ, float size, int resolution,
+    float maxHeight) {
+    m_size = size;
+    m_resolution = resolution;
+    m_maxHeight = maxHeight;
+    m_step = size / (float)resolution;
+    m_originX = originX;
+    m_originZ = originZ;
+}
+
+void Heightfield::bake(float originX, float originZ, float size, int resolution,
+    float terrainSize, float maxHeight) {
+    setGrid(originX, originZ, size, resolution, maxHeight);
+
+    // one row at a time through the batched height function
+    int n = resolution + 1;
+    m_heights.resize(n * n);
+    std::vector<float> rowX(n), rowZ(n);
+    for (int i = 0; i < n; ++i) {
+        rowX[i] = i * m_step + m_originX;
+    }
+    for (int j = 0; j < n; ++j) {
+        std::fill(rowZ.begin(), rowZ.end(), j * m_step + m_originZ);
+        Terrain::sampleHeights(rowX.data(), rowZ.data(), &m_heights[j * n], n,
+            terrainSize, maxHeight);
+    }
+}
+
+void Heightfield::bake(float size, int resolution, float maxHeight, MeshCache& cache) {
+    std::string key = MeshCache::paramKey("heightfield",
+        {size, (float)resolution, maxHeight});
+    size_t count = (resolution + 1) * (resolution + 1);
+
+    MeshCache::Entry entry;
+    if (cache.read(key, entry) && entry.arrayCount() == 1 &&
+        entry.count<float>(0) == count) {
+        setGrid(-size / 2.0f, -size / 2.0f, size, resolution, maxHeight);
+        const float* heights = entry.array<float>(0);
+        m_heights.assign(heights, heights + count);
+        return;
+    }
+
+    bake(size, resolution, maxHeight);
+    MeshCache::Array array = {m_heights.data(), m_heights.size() * sizeof(float)};
+    cache.write(key, &array, 1);
+}
+
+bool Heightfield::contains(float x, float z) const {
+    return x >= m_originX && x <= m_originX + m_size &&
+        z >= m_originZ && z <= m_originZ + m_size;
+}
+
+void Heightfield::locate(float x, float z, int& i, int& j, float& u, float& v) const {
+    float gx = clamp((x - m_originX) / m_step, 0.0f, (float)m_resolution);
+    float gz = clamp((z - m_originZ) / m_step, 0.0f, (float)m_resolution);
+
+    // the last vertex belongs to the last cell
+    i = glm::min((int)gx, m_resolution - 1);
+    j = glm::min((int)gz, m_resolution - 1);
+    u = gx - i;
+    v = gz - j;
+}
+
+float Heightfield::height(float x, float z) const {
+    int i, j;
+    float u, v;
+    locate(x, z, i, j, u, v);
+
+    float h00 = vertexHeight(i, j);
+    float h10 = vertexHeight(i + 1, j);
+    float h01 = vertexHeight(i, j + 1);
+    float h11 = vertexHeight(i + 1, j + 1);
+
+    float h0 = h00 + (h10 - h00) * u;
+    float h1 = h01 + (h11 - h01) * u;
+    return h0 + (h1 - h0) * v;
+}
+
+vec2 Heightfield::gradient(float x, float z) const {
+    int i, j;
+    float u, v;
+    locate(x, z, i, j, u, v);
+
+    float h00 = vertexHeight(i, j);
+    float h10 = vertexHeight(i + 1, j);
+    float h01 = vertexHeight(i, j + 1);
+    float h11 = vertexHeight(i + 1, j + 1);
+
+    // derivative of the bilinear patch, per grid unit -> per world unit
+    float dx = (h10 - h00) + (h11 - h01 - h10 + h00) * v;
+    float dz = (h01 - h00) + (h11 - h01 - h10 + h00) * u;
+    return vec2(dx, dz) / m_step;
+}
+
+vec3 Heightfield::normal(float x, float z) const {
+    vec2 g = gradient(x, z);
+    return normalize(vec3(-g.x, 1.0f, -g.y));
+}
+
+float Heightfield::slope(float x, float z) const {
+    return length(gradient(x, z));
+}
+
+float Heightfield::gridHeight(int i, int j, int resolution) const {
+    if (resolution > 0 && m_resolution % resolution == 0) {
+        int stride = m_resolution / resolution;
+        return vertexHeight(i * stride, j * stride);
+    }
+    float step = m_size / (float)resolution;
+    return height(i * step + m_originX, j * step + m_originZ);
+}
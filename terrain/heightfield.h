@@ -0,0 +1,70 @@
+#ifndef HEIGHTFIELD_H
+#define HEIGHTFIELD_H
+
+#include <vector>
+#include <glm/glm.hpp>
+
+class MeshCache;
+
+// The terrain surface baked once into a (resolution + 1)^2 grid of heights over
+// a square of side size, vertex (i, j) at x = originX + i * step,
+// z = originZ + j * step. The whole scene is centred on 0 (origin -size/2),
+// streamed tiles cover a part of the endless terrain.
+// Queries interpolate the grid bilinearly, the gradient and normal are the
+// exact derivatives of that interpolation, so the mesh, the river and all the
+// collision code see the same surface. Outside the square the border is
+// clamped.
+class Heightfield {
+public:
+    Heightfield();
+    // bakes Terrain::sampleHeight (the analytic function) at every vertex
+    Heightfield(float size, int resolution, float maxHeight);
+
+    void bake(float size, int resolution, float maxHeight);
+    // square [origin, origin + size]^2 of the terrain function scaled for a
+    // scene of terrainSize (the size the analytic function is defined with)
+    void bake(float originX, float originZ, float size, int resolution,
+        float terrainSize, float maxHeight);
+    // bake() of the centred square through the cache: the heights are read
+    // back when the same parameters were baked before
+    void bake(float size, int resolution, float maxHeight, MeshCache& cache);
+
+    // bilinear height at world (x, z)
+    float height(float x, float z) const;
+    // (dh/dx, dh/dz) at world (x, z)
+    glm::vec2 gradient(float x, float z) const;
+    // unit surface normal at world (x, z)
+    glm::vec3 normal(float x, float z) const;
+    // tan of the steepest angle, |gradient|
+    float slope(float x, float z) const;
+
+    // height of vertex (i, j) of the baked grid
+    float vertexHeight(int i, int j) const { return m_heights[j * (m_resolution + 1) + i]; }
+    // height at corner (i, j) of a coarser grid of the given resolution over
+    // the same square; exact (no interpolation) when it divides getResolution()
+    float gridHeight(int i, int j, int resolution) const;
+
+    float getSize() const { return m_size; }
+    float getOriginX() const { return m_originX; }
+    float getOriginZ() const { return m_originZ; }
+    // (x, z) inside the baked square
+    bool contains(float x, float z) const;
+    int getResolution() const { return m_resolution; }
+    float getMaxHeight() const { return m_maxHeight; }
+    float getStep() const { return m_step; }
+    bool empty() const { return m_heights.empty(); }
+
+private:
+    void setGrid(float originX, float originZ, float size, int resolution, float maxHeight);
+    // cell (i, j) containing (x, z) and the position (u, v) inside it, clamped
+    void locate(float x, float z, int& i, int& j, float& u, float& v) const;
+
+    float m_size;
+    int m_resolution;
+    float m_maxHeight;
+    float m_step;
+    float m_originX, m_originZ;  // world position of vertex (0, 0)
+    std::vector<float> m_heights; // row major, z rows of x samples
+};
+
+#endif
@@ -1,30 +1,37 @@
 #include "river.h"
-#include "terrain.h"
+#include "heightfield.h"
 
 using namespace glm;
 using namespace std;
 
-Drawable* River::createFloodedCanyon(float size, int resolution, float waterLevel, float maxHeight) {
-
+Drawable* River::createFloodedCanyon(const Heightfield& field, int resolution, float waterLevel) {
 	vector<vec3> vertices;
 	vector<vec2> uvs;
 	vector<vec3> normals;
+	buildFloodedCanyon(field, resolution, waterLevel, vertices, uvs, normals);
+
+    return new Drawable(vertices, uvs, normals);
+}
 
-	float step = size / resolution;
-	float offset = size / 2.0f;
+void River::buildFloodedCanyon(const Heightfield& field, int resolution, float waterLevel,
+    vector<vec3>& vertices, vector<vec2>& uvs, vector<vec3>& normals) {
+
+	float step = field.getSize() / resolution;
+	float x0 = field.getOriginX();
+	float z0 = field.getOriginZ();
 
     for (int i = 0; i < resolution; i++) {
         for (int j = 0; j < resolution; j++) {
 
-            float x1 = i * step - offset;
-            float z1 = j * step - offset;
-            float x2 = (i + 1) * step - offset;
-            float z2 = (j + 1) * step - offset;
+            float x1 = i * step + x0;
+            float z1 = j * step + z0;
+            float x2 = (i + 1) * step + x0;
+            float z2 = (j + 1) * step + z0;
 
-            float h11 = Terrain::sampleHeight(x1, z1, size, maxHeight);
-            float h12 = Terrain::sampleHeight(x1, z2, size, maxHeight);
-            float h21 = Terrain::sampleHeight(x2, z1, size, maxHeight);
-            float h22 = Terrain::sampleHeight(x2, z2, size, maxHeight);
+            float h11 = field.gridHeight(i, j, resolution);
+            float h12 = field.gridHeight(i, j + 1, resolution);
+            float h21 = field.gridHeight(i + 1, j, resolution);
+            float h22 = field.gridHeight(i + 1, j + 1, resolution);
 
             // if over the waterLevel -> no fill
             if (h11 > waterLevel && h12 > waterLevel &&
@@ -57,6 +64,4 @@ Drawable* River::createFloodedCanyon(float size, int resolution, float waterLeve
                 normals.push_back(vec3(0, 1, 0));
         }
     }
-
-    return new Drawable(vertices, uvs, normals);
 }
\ No newline at end of file
@@ -5,10 +5,17 @@
 #include <glm/glm.hpp>
 #include <common/model.h> // for Drawable
 
+class Heightfield;
+
 class River {
 public:
     // Creates a river mesh from a path (center line)
-    static Drawable* createFloodedCanyon(float size, int resolution, float waterLevel, float maxHeight);
+    static Drawable* createFloodedCanyon(const Heightfield& field, int resolution, float waterLevel);
+
+    // the triangles of createFloodedCanyon(), no GL needed
+    static void buildFloodedCanyon(const Heightfield& field, int resolution, float waterLevel,
+        std::vector<glm::vec3>& vertices, std::vector<glm::vec2>& uvs,
+        std::vector<glm::vec3>& normals);
 };
 
 #endif
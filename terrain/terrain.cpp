@@ -1,11 +1,14 @@
 #include "terrain.h"
+#include "heightfield.h"
 #include <cmath>
+#include <functional>
+#include <common/threadPool.h>
 
 using namespace glm;
 using namespace std;
 
-// initialize the static var for the peak
-glm::vec3 Terrain::peakPos = glm::vec3(0.0f);
+// grid rows per chunk when the build is split across threads
+static const int ROW_CHUNK = 16;
 
 float plateau(float x, float center, float topWidth, float cliffWidth) {
     float d = abs(x - center);
@@ -54,71 +57,107 @@ float Terrain::getHeight(float x, float z, float size, float maxHeight) {
 }
 
 
-glm::vec3 Terrain::get_terrain_peak() {
-    return peakPos;
+// highest vertex of a grid of rows (one row = fixed i, j along z), reduced
+// row by row so the first vertex in (i, j) order wins ties, as a plain
+// double loop would (the tepui tops are exactly flat)
+static vec3 reducePeak(const vector<vec3>& rowPeaks) {
+    vec3 peak = rowPeaks[0];
+    for (size_t i = 1; i < rowPeaks.size(); ++i) {
+        if (rowPeaks[i].y > peak.y) peak = rowPeaks[i];
+    }
+    return peak;
 }
 
-Drawable* Terrain::generate(float size, int resolution, float maxHeight) {
-    vector<vec3> vertices;
-    vector<vec2> uvs;
-    vector<vec3> normals;
-
-    float step = size / (float)resolution;
-    float offset = size / 2.0f;
-    //reset for new gen
-    float currentMaxY = -1e9f;
-
-    for (int i = 0; i < resolution; ++i) {
-        for (int j = 0; j < resolution; ++j) {
-
-            // def 4 corners
-            float x1 = i * step - offset;
-            float z1 = j * step - offset;
-            float x2 = (i + 1) * step - offset;
-            float z2 = (j + 1) * step - offset;
-
-            // get heights
-            float h11 = getHeight(x1, z1, size, maxHeight);
-            float h12 = getHeight(x1, z2, size, maxHeight);
-            float h21 = getHeight(x2, z1, size, maxHeight);
-            float h22 = getHeight(x2, z2, size, maxHeight);
-
-            // lists thata store heights and according positions
-            float heights[] = { h11, h12, h21, h22 };
-            vec3 positions[] = { {x1, h11, z1}, {x1, h12, z2}, {x2, h21, z1}, {x2, h22, z2} };
-            
-            // terrain peak calculation
-            for (int k = 0; k < 4; ++k) {
-                if (heights[k] > currentMaxY) {
-                    currentMaxY = heights[k];
-                    peakPos = positions[k];
-                }
-            }
-
-            // triangles for the quad
-            vec3 v1{ x1, h11, z1 }, v2{ x1, h12, z2 }, v3{ x2, h21, z1 }, v4{ x2, h22, z2 };
+static void runRows(int rows, ThreadPool* threads, const std::function<void(int, int)>& fn) {
+    if (threads) {
+        threads->parallelFor(rows, ROW_CHUNK, fn);
+    }
+    else {
+        fn(0, rows);
+    }
+}
 
-            // triangle 1
-            vertices.push_back(v1); vertices.push_back(v2); vertices.push_back(v3);
-            // triangle 2
-            vertices.push_back(v2); vertices.push_back(v4); vertices.push_back(v3);
+glm::vec3 Terrain::findPeak(const Heightfield& field, int resolution, ThreadPool* threads) {
+    float step = field.getSize() / (float)resolution;
+    float x0 = field.getOriginX();
+    float z0 = field.getOriginZ();
+    int n = resolution + 1;
+
+    // buildGrid() visits every grid corner, so checking them once is enough
+    vector<vec3> rowPeaks(n);
+    runRows(n, threads, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            vec3 best(0.0f, -1e9f, 0.0f);
+            for (int j = 0; j < n; ++j) {
+                float h = field.gridHeight(i, j, resolution);
+                if (h > best.y) best = vec3(i * step + x0, h, j * step + z0);
+            }
+            rowPeaks[i] = best;
+        }
+    });
 
-            // UV mapping
-            uvs.push_back(vec2(0, 0)); uvs.push_back(vec2(0, 1)); uvs.push_back(vec2(1, 0));
-            uvs.push_back(vec2(0, 1)); uvs.push_back(vec2(1, 1)); uvs.push_back(vec2(1, 0));
+    return reducePeak(rowPeaks);
+}
 
-            // normals
-            vec3 n1 = normalize(cross(v2 - v1, v3 - v1));
-            for (int k = 0; k < 6; k++) normals.push_back(n1);
+void Terrain::buildGrid(const Heightfield& field, int resolution, TerrainGrid& grid,
+    ThreadPool* threads) {
+    float step = field.getSize() / (float)resolution;
+    float x0 = field.getOriginX();
+    float z0 = field.getOriginZ();
+    int n = resolution + 1;
+
+    // vertex (i, j) is at i * n + j
+    grid.resolution = resolution;
+    grid.positions.resize(n * n);
+    grid.uvs.resize(n * n);
+    grid.normals.resize(n * n);
+    grid.indices.resize(resolution * resolution * 6);
+
+    // heights and peak
+    vector<vec3> rowPeaks(n);
+    runRows(n, threads, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            vec3 best(0.0f, -1e9f, 0.0f);
+            for (int j = 0; j < n; ++j) {
+                vec3 p(i * step + x0, field.gridHeight(i, j, resolution), j * step + z0);
+                grid.positions[i * n + j] = p;
+                // one texture repeat per cell
+                grid.uvs[i * n + j] = vec2((float)i, (float)j);
+                if (p.y > best.y) best = p;
+            }
+            rowPeaks[i] = best;
         }
-    }
+    });
+    grid.peak = reducePeak(rowPeaks);
+
+    // normals from central differences (one sided on the border) and the
+    // two triangles of every cell, needs the neighbour rows done
+    const vec3* pos = grid.positions.data();
+    runRows(n, threads, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            int i0 = glm::max(i - 1, 0), i1 = glm::min(i + 1, resolution);
+            for (int j = 0; j < n; ++j) {
+                int j0 = glm::max(j - 1, 0), j1 = glm::min(j + 1, resolution);
+                float dx = (pos[i1 * n + j].y - pos[i0 * n + j].y) / ((i1 - i0) * step);
+                float dz = (pos[i * n + j1].y - pos[i * n + j0].y) / ((j1 - j0) * step);
+                grid.normals[i * n + j] = normalize(vec3(-dx, 1.0f, -dz));
+            }
 
-    return new Drawable(vertices, uvs, normals);
+            if (i == resolution) continue;
+            unsigned int* quad = &grid.indices[i * resolution * 6];
+            for (int j = 0; j < resolution; ++j, quad += 6) {
+                unsigned int v1 = i * n + j;  // (x1, z1)
+                unsigned int v2 = v1 + 1;     // (x1, z2)
+                unsigned int v3 = v1 + n;     // (x2, z1)
+                unsigned int v4 = v3 + 1;     // (x2, z2)
+                quad[0] = v1; quad[1] = v2; quad[2] = v3;
+                quad[3] = v2; quad[4] = v4; quad[5] = v3;
+            }
+        }
+    });
 }
 
-// river
-
-// helper function to read the terrain
+// analytic height, baked into the Heightfield
 float Terrain::sampleHeight(float x, float z, float size, float maxHeight) {
     return getHeight(x, z, size, maxHeight);
 }
@@ -1,26 +1,46 @@
 #ifndef TERRAIN_H
 #define TERRAIN_H
 
+#include <cstddef>
 #include <vector>
 #include <glm/glm.hpp>
-#include <common/model.h> // for Drawable
+
+class Heightfield;
+class ThreadPool;
+
+// indexed (resolution + 1)^2 grid, vertex (i, j) at i * (resolution + 1) + j
+struct TerrainGrid {
+    int resolution = 0;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;     // smooth, central differences
+    std::vector<unsigned int> indices;  // two triangles per cell
+    glm::vec3 peak;
+};
 
 class Terrain {
 public:
-    // Parameters: width/depth size, resolution (grid density) and mountain height
-    static Drawable* generate(float size, int resolution, float maxHeight);
+    // mesh data of the baked heightfield, resolution = grid density of the
+    // mesh. threads (optional) split the grid rows
+    static void buildGrid(const Heightfield& field, int resolution, TerrainGrid& grid,
+        ThreadPool* threads = nullptr);
 
-    // calculate the peak position
-    static glm::vec3 get_terrain_peak();
+    // same peak as buildGrid() finds, without building the grid
+    static glm::vec3 findPeak(const Heightfield& field, int resolution, ThreadPool* threads = nullptr);
 
-    // generate river (basically we just fill the canyon up to a certain height)
+    // the analytic terrain function, expensive: only used to bake the
+    // Heightfield, everything else reads from the heightfield
     static float sampleHeight(float x, float z, float size, float maxHeight);
 
+    // sampleHeight() of n points at once, vectorized with fast sin / exp
+    // (within 2.5e-4 of sampleHeight near the scene, see terrainSimd.cpp)
+    static void sampleHeights(const float* x, const float* z, float* out, size_t n,
+        float size, float maxHeight);
+    // instruction set sampleHeights() was built for
+    static const char* simdPath();
 
 private:
     static float getHeight(float x, float z, float size, float maxHeight);
-    // static var to store the peak pos
-    static glm::vec3 peakPos;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "terrainQuadtree.h"
+#include "heightfield.h"
+#include <cmath>
+#include <common/frustum.h>
+
+using namespace glm;
+using namespace std;
+
+// smallest range of a level in node sizes. The ranges of two levels have to
+// differ by more than the node diagonal, so that neighbouring nodes are never
+// more than one level apart
+static const float MIN_RANGE_FACTOR = 3.0f;
+// share of a level's range spent morphing into the next level
+static const float MORPH_START = 0.66f;
+
+TerrainQuadtree::TerrainQuadtree(const Heightfield& field, int gridSize, float leafSize,
+    int levelCount, float leafRange)
+    : m_gridSize(gridSize), m_levelCount(glm::clamp(levelCount, 1, (int)MAX_LEVELS)) {
+    float size = field.getSize();
+    float rootSize = leafSize * (float)(1 << (m_levelCount - 1));
+    m_rootsPerSide = glm::max(1, (int)floor(size / rootSize + 0.5f));
+    rootSize = size / m_rootsPerSide;
+    m_leafSize = rootSize / (float)(1 << (m_levelCount - 1));
+
+    leafRange = glm::max(leafRange, MIN_RANGE_FACTOR * m_leafSize);
+    float previous = 0.0f;
+    for (int l = 0; l < m_levelCount; ++l) {
+        m_range[l] = leafRange * (float)(1 << l);
+        m_morphStart[l] = previous + (m_range[l] - previous) * MORPH_START;
+        previous = m_range[l];
+    }
+
+    for (int i = 0; i < m_rootsPerSide; ++i) {
+        for (int j = 0; j < m_rootsPerSide; ++j) {
+            m_roots.push_back((int)m_nodes.size());
+            m_nodes.push_back(Node());
+            build(m_roots.back(), field, field.getOriginX() + i * rootSize, field.getOriginZ() + j * rootSize,
+                rootSize, m_levelCount - 1);
+        }
+    }
+}
+
+void TerrainQuadtree::build(int index, const Heightfield& field, float x, float z, float size,
+    int level) {
+    Node node;
+    node.x = x;
+    node.z = z;
+    node.size = size;
+    node.level = level;
+    node.child = -1;
+
+    float minY = 1e9f, maxY = -1e9f;
+    if (level == 0) {
+        // heightfield vertices covering the node, the bilinear surface
+        // between them stays inside their range
+        float step = field.getStep();
+        float gx = (x - field.getOriginX()) / step;
+        float gz = (z - field.getOriginZ()) / step;
+        int cells = (int)ceil(size / step);
+        int res = field.getResolution();
+        int i0 = glm::clamp((int)floor(gx), 0, res);
+        int i1 = glm::clamp((int)ceil(gx) + cells, 0, res);
+        int j0 = glm::clamp((int)floor(gz), 0, res);
+        int j1 = glm::clamp((int)ceil(gz) + cells, 0, res);
+        for (int j = j0; j <= j1; ++j) {
+            for (int i = i0; i <= i1; ++i) {
+                float h = field.vertexHeight(i, j);
+                minY = glm::min(minY, h);
+                maxY = glm::max(maxY, h);
+            }
+        }
+    }
+    else {
+        // the 4 children are next to each other
+        float half = size / 2.0f;
+        node.child = (int)m_nodes.size();
+        m_nodes.resize(m_nodes.size() + 4);
+        build(node.child, field, x, z, half, level - 1);
+        build(node.child + 1, field, x, z + half, half, level - 1);
+        build(node.child + 2, field, x + half, z, half, level - 1);
+        build(node.child + 3, field, x + half, z + half, half, level - 1);
+        for (int c = 0; c < 4; ++c) {
+            minY = glm::min(minY, m_nodes[node.child + c].min.y);
+            maxY = glm::max(maxY, m_nodes[node.child + c].max.y);
+        }
+    }
+
+    node.min = vec3(x, minY, z);
+    node.max = vec3(x + size, maxY, z + size);
+    m_nodes[index] = node;
+}
+
+// does the box touch the sphere around the eye
+static bool inRange(const vec3& min, const vec3& max, const vec3& eye, float range) {
+    vec3 d = glm::max(glm::max(min - eye, eye - max), vec3(0.0f));
+    return dot(d, d) <= range * range;
+}
+
+bool TerrainQuadtree::select(int index, const vec3& eye, const Frustum& frustum,
+    vector<Selection>& out) const {
+    const Node& node = m_nodes[index];
+
+    // too far for this level, the parent covers it
+    if (!inRange(node.min, node.max, eye, m_range[node.level])) return false;
+    // culled, nothing to draw but the area is handled
+    if (!frustum.intersects(node.min, node.max)) return true;
+
+    Selection s;
+    s.node = vec4(node.x, node.z, node.size, (float)node.level);
+    if (node.level == 0 || !inRange(node.min, node.max, eye, m_range[node.level - 1])) {
+        s.part = WHOLE;
+        out.push_back(s);
+        return true;
+    }
+
+    // children close enough take over, the rest is drawn as quarters of
+    // this node
+    for (int c = 0; c < 4; ++c) {
+        if (!select(node.child + c, eye, frustum, out)) {
+            s.part = QUARTER + c;
+            out.push_back(s);
+        }
+    }
+    return true;
+}
+
+void TerrainQuadtree::select(const vec3& eye, const Frustum& frustum,
+    vector<Selection>& out) const {
+    out.clear();
+    for (size_t r = 0; r < m_roots.size(); ++r) {
+        select(m_roots[r], eye, frustum, out);
+    }
+}
+
+int TerrainQuadtree::triangleCount(const vector<Selection>& selection, int gridSize) {
+    int whole = 2 * gridSize * gridSize;
+    int count = 0;
+    for (size_t i = 0; i < selection.size(); ++i) {
+        count += selection[i].part == WHOLE ? whole : whole / 4;
+    }
+    return count;
+}
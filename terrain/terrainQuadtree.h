@@ -0,0 +1,81 @@
+#ifndef TERRAIN_QUADTREE_H
+#define TERRAIN_QUADTREE_H
+
+#include <vector>
+#include <glm/glm.hpp>
+
+class Frustum;
+class Heightfield;
+
+// Continuous distance-based LOD (CDLOD) over a Heightfield.
+// https://github.com/fstrugar/CDLOD/blob/master/cdlod_paper_latest.pdf
+//
+// The terrain square is tiled by root nodes, each the top of a quadtree of
+// levelCount levels; level 0 are the leaves. Every node is drawn with the
+// same gridSize^2 patch, so a node of level l has cells 2^l times bigger than
+// a leaf. Level l is used up to getRange(l) from the eye; over the last part
+// of that range (getMorphStart(l) .. getRange(l)) the vertices slide onto the
+// grid of level l + 1, so neighbouring levels meet without cracks.
+// Ranges grow with the node size, so the number of selected nodes (and
+// triangles) per frame does not depend on the size of the map. Nodes further
+// than the range of the top level are not drawn at all.
+// No GL here, TerrainRenderer draws the selection.
+class TerrainQuadtree {
+public:
+    static const int MAX_LEVELS = 8;
+    // part of a selected node: the whole patch or one of its quarters
+    // (x-major, QUARTER + 2 * qx + qz)
+    enum Part { WHOLE = 0, QUARTER = 1, PART_COUNT = 5 };
+
+    struct Selection {
+        glm::vec4 node; // x, z of the min corner, size, level
+        int part;
+    };
+
+    // leafSize is rounded so the roots tile the heightfield exactly.
+    // leafRange: distance up to which the leaves are used (the detail), each
+    // level above doubles it. Raised to the minimum that keeps neighbours
+    // within one level
+    TerrainQuadtree(const Heightfield& field, int gridSize = 32, float leafSize = 12.5f,
+        int levelCount = 4, float leafRange = 60.0f);
+
+    // nodes to draw for this eye, culled against the frustum; the eye picks
+    // the levels, so a shadow pass passes the camera eye with the light frustum
+    void select(const glm::vec3& eye, const Frustum& frustum, std::vector<Selection>& out) const;
+
+    int getGridSize() const { return m_gridSize; }
+    int getLevelCount() const { return m_levelCount; }
+    int getRootCount() const { return m_rootsPerSide * m_rootsPerSide; }
+    int getNodeCount() const { return (int)m_nodes.size(); }
+    float getLeafSize() const { return m_leafSize; }
+    float getRange(int level) const { return m_range[level]; }
+    float getMorphStart(int level) const { return m_morphStart[level]; }
+
+    // triangles of a selection
+    static int triangleCount(const std::vector<Selection>& selection, int gridSize);
+
+private:
+    struct Node {
+        glm::vec3 min, max;
+        float x, z, size;
+        int level;
+        int child; // first of 4 (x-major), -1 for leaves
+    };
+
+    // fills node index and allocates its subtree
+    void build(int index, const Heightfield& field, float x, float z, float size, int level);
+    bool select(int node, const glm::vec3& eye, const Frustum& frustum,
+        std::vector<Selection>& out) const;
+
+    int m_gridSize;
+    int m_levelCount;
+    int m_rootsPerSide;
+    float m_leafSize;
+    float m_range[MAX_LEVELS];
+    float m_morphStart[MAX_LEVELS];
+
+    std::vector<Node> m_nodes;
+    std::vector<int> m_roots;
+};
+
+#endif
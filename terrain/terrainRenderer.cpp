@@ -0,0 +1,199 @@
+#include "terrainRenderer.h"
+#include "heightfield.h"
+#include <common/frustum.h>
+
+using namespace glm;
+using namespace std;
+
+typedef TerrainQuadtree::Selection Selection;
+
+TerrainRenderer::TerrainRenderer(const Heightfield& field, const TerrainQuadtree& tree)
+    : m_tree(tree), m_VAO(0), m_VBO(0), m_EBO(0), m_instanceVBO(0), m_heightmap(0),
+    m_mapOrigin(0.0f), m_mapStep(1.0f), m_mapTexels(1), m_capacity(64) {
+    for (int p = 0; p < TerrainQuadtree::PART_COUNT; ++p) {
+        m_first[p] = 0;
+        m_count[p] = 0;
+    }
+    createPatch();
+    createHeightmap(field);
+}
+
+TerrainRenderer::~TerrainRenderer() {
+    glDeleteBuffers(1, &m_VBO);
+    glDeleteBuffers(1, &m_EBO);
+    glDeleteBuffers(1, &m_instanceVBO);
+    glDeleteVertexArrays(1, &m_VAO);
+    glDeleteTextures(1, &m_heightmap);
+}
+
+// (g + 1)^2 grid positions in [0, 1] on xz. The indices are ordered quarter
+// by quarter, so each quarter is a contiguous range and the whole patch is
+// all of them
+void TerrainRenderer::createPatch() {
+    int g = m_tree.getGridSize();
+    int n = g + 1;
+    int half = g / 2;
+
+    vector<vec3> positions(n * n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            positions[i * n + j] = vec3((float)i / g, 0.0f, (float)j / g);
+        }
+    }
+
+    vector<GLushort> indices;
+    indices.reserve(g * g * 6);
+    for (int qx = 0; qx < 2; ++qx) {
+        for (int qz = 0; qz < 2; ++qz) {
+            int part = TerrainQuadtree::QUARTER + 2 * qx + qz;
+            m_partFirst[part] = (int)indices.size();
+            for (int i = qx * half; i < (qx + 1) * half; ++i) {
+                for (int j = qz * half; j < (qz + 1) * half; ++j) {
+                    // same winding as Terrain::buildGrid
+                    GLushort v1 = (GLushort)(i * n + j);
+                    GLushort v2 = v1 + 1;
+                    GLushort v3 = (GLushort)(v1 + n);
+                    GLushort v4 = v3 + 1;
+                    indices.insert(indices.end(), { v1, v2, v3, v2, v4, v3 });
+                }
+            }
+            m_partCount[part] = (int)indices.size() - m_partFirst[part];
+        }
+    }
+    m_partFirst[TerrainQuadtree::WHOLE] = 0;
+    m_partCount[TerrainQuadtree::WHOLE] = (int)indices.size();
+
+    glGenVertexArrays(1, &m_VAO);
+    glBindVertexArray(m_VAO);
+
+    glGenBuffers(1, &m_VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(vec3), &positions[0], GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
+    glEnableVertexAttribArray(0);
+
+    glGenBuffers(1, &m_EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), &indices[0],
+        GL_STATIC_DRAW);
+
+    glGenBuffers(1, &m_instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(vec4), NULL, GL_STREAM_DRAW);
+    glVertexAttribPointer(NODE_LOCATION, 4, GL_FLOAT, GL_FALSE, 0, NULL);
+    glEnableVertexAttribArray(NODE_LOCATION);
+    glVertexAttribDivisor(NODE_LOCATION, 1);
+
+    glBindVertexArray(0);
+}
+
+void TerrainRenderer::createHeightmap(const Heightfield& field) {
+    int n = field.getResolution() + 1;
+    vector<float> heights(n * n);
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < n; ++i) {
+            heights[j * n + i] = field.vertexHeight(i, j);
+        }
+    }
+
+    glGenTextures(1, &m_heightmap);
+    glBindTexture(GL_TEXTURE_2D, m_heightmap);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // texel (i, j) = vertex (i, j): s along x, t along z
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, n, n, 0, GL_RED, GL_FLOAT, &heights[0]);
+    // hardware bilinear = Heightfield::height
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_mapOrigin = vec2(field.getOriginX(), field.getOriginZ());
+    m_mapStep = field.getStep();
+    m_mapTexels = n;
+}
+
+void TerrainRenderer::attachProgram(GLuint program) {
+    glUseProgram(program);
+
+    ProgramUniforms uniforms;
+    uniforms.program = program;
+    uniforms.useTerrainLOD = glGetUniformLocation(program, "useTerrainLOD");
+    uniforms.eye = glGetUniformLocation(program, "terrainEye");
+    m_programs.push_back(uniforms);
+
+    glUniform1i(glGetUniformLocation(program, "terrainHeightmap"), HEIGHTMAP_UNIT);
+    glUniform4f(glGetUniformLocation(program, "terrainMap"), m_mapOrigin.x, m_mapOrigin.y,
+        m_mapStep, (float)m_mapTexels);
+    glUniform1f(glGetUniformLocation(program, "terrainGridSize"), (float)m_tree.getGridSize());
+
+    // (start, end) per level, the top level never morphs
+    vec2 morph[TerrainQuadtree::MAX_LEVELS];
+    for (int l = 0; l < TerrainQuadtree::MAX_LEVELS; ++l) {
+        morph[l] = vec2(1e9f, 2e9f);
+    }
+    for (int l = 0; l < m_tree.getLevelCount() - 1; ++l) {
+        morph[l] = vec2(m_tree.getMorphStart(l), m_tree.getRange(l));
+    }
+    glUniform2fv(glGetUniformLocation(program, "terrainMorph"), TerrainQuadtree::MAX_LEVELS,
+        &morph[0][0]);
+    glUniform1i(uniforms.useTerrainLOD, 0);
+}
+
+void TerrainRenderer::draw(GLuint program, const vec3& eye, const mat4& viewProjection) {
+    const ProgramUniforms* uniforms = nullptr;
+    for (size_t i = 0; i < m_programs.size(); ++i) {
+        if (m_programs[i].program == program) uniforms = &m_programs[i];
+    }
+    if (!uniforms) return;
+
+    m_tree.select(eye, Frustum(viewProjection), m_selection);
+
+    // counting sort by part
+    int counts[TerrainQuadtree::PART_COUNT] = { 0 };
+    for (size_t i = 0; i < m_selection.size(); ++i) {
+        counts[m_selection[i].part]++;
+    }
+    int total = 0;
+    for (int p = 0; p < TerrainQuadtree::PART_COUNT; ++p) {
+        m_first[p] = total;
+        m_count[p] = 0;
+        total += counts[p];
+    }
+    m_instances.resize(total);
+    for (size_t i = 0; i < m_selection.size(); ++i) {
+        int p = m_selection[i].part;
+        m_instances[m_first[p] + m_count[p]++] = m_selection[i].node;
+    }
+    if (total == 0) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    while (m_capacity < (size_t)total) m_capacity *= 2;
+    // orphan the old storage, the other pass may still be drawing from it
+    glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(vec4), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, total * sizeof(vec4), &m_instances[0]);
+
+    glUniform1i(uniforms->useTerrainLOD, 1);
+    glUniform3fv(uniforms->eye, 1, &eye[0]);
+    glActiveTexture(GL_TEXTURE0 + HEIGHTMAP_UNIT);
+    glBindTexture(GL_TEXTURE_2D, m_heightmap);
+
+    glBindVertexArray(m_VAO);
+    for (int p = 0; p < TerrainQuadtree::PART_COUNT; ++p) {
+        if (m_count[p] == 0) continue;
+        // GL 3.3 has no base instance, point the attribute at the first
+        // node of the part instead
+        glVertexAttribPointer(NODE_LOCATION, 4, GL_FLOAT, GL_FALSE, 0,
+            (const char*)NULL + m_first[p] * sizeof(vec4));
+        glDrawElementsInstanced(GL_TRIANGLES, m_partCount[p], GL_UNSIGNED_SHORT,
+            (const char*)NULL + m_partFirst[p] * sizeof(GLushort), m_count[p]);
+    }
+    glBindVertexArray(0);
+
+    glUniform1i(uniforms->useTerrainLOD, 0);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+int TerrainRenderer::getTriangleCount() const {
+    return TerrainQuadtree::triangleCount(m_selection, m_tree.getGridSize());
+}
@@ -0,0 +1,77 @@
+#ifndef TERRAIN_RENDERER_H
+#define TERRAIN_RENDERER_H
+
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "terrainQuadtree.h"
+
+class Heightfield;
+
+// Draws the terrain as the CDLOD nodes of a TerrainQuadtree.
+// The heights live in a float texture sampled by the vertex shader, every
+// node is the same small patch mesh moved and scaled by a per-instance
+// attribute, so a frame costs one instanced call per part (whole patch or one
+// of the four quarters) whatever the size of the map.
+// The shaders take this path when useTerrainLOD is 1; the renderer sets the
+// flag and its other uniforms itself.
+class TerrainRenderer {
+public:
+    // per-instance node attribute (shared with the balloon instance slot)
+    static const GLuint NODE_LOCATION = 3;
+    // texture unit of the heightmap
+    static const int HEIGHTMAP_UNIT = 4;
+
+    TerrainRenderer(const Heightfield& field, const TerrainQuadtree& tree);
+    ~TerrainRenderer();
+
+    TerrainRenderer(const TerrainRenderer&) = delete;
+    TerrainRenderer& operator=(const TerrainRenderer&) = delete;
+
+    // looks up the terrain uniforms of a program and sets the constant ones
+    // (changes the current program)
+    void attachProgram(GLuint program);
+
+    // selects the nodes seen from eye inside the frustum of viewProjection
+    // and draws them. program must be current and attached
+    void draw(GLuint program, const glm::vec3& eye, const glm::mat4& viewProjection);
+
+    // last draw
+    int getNodeCount() const { return (int)m_selection.size(); }
+    int getTriangleCount() const;
+
+private:
+    struct ProgramUniforms {
+        GLuint program;
+        GLint useTerrainLOD;
+        GLint eye;
+    };
+
+    void createPatch();
+    void createHeightmap(const Heightfield& field);
+
+    const TerrainQuadtree& m_tree;
+    std::vector<ProgramUniforms> m_programs;
+
+    GLuint m_VAO;
+    GLuint m_VBO;
+    GLuint m_EBO;
+    GLuint m_instanceVBO;
+    GLuint m_heightmap;
+    glm::vec2 m_mapOrigin; // world x, z of texel 0
+    float m_mapStep;    // world units per texel
+    int m_mapTexels;    // per side
+    size_t m_capacity; // instances the GPU buffer can hold
+
+    // index range of every part in the patch index buffer
+    int m_partFirst[TerrainQuadtree::PART_COUNT];
+    int m_partCount[TerrainQuadtree::PART_COUNT];
+
+    std::vector<TerrainQuadtree::Selection> m_selection;
+    std::vector<glm::vec4> m_instances; // sorted by part
+    int m_first[TerrainQuadtree::PART_COUNT];
+    int m_count[TerrainQuadtree::PART_COUNT];
+};
+
+#endif
@@ -0,0 +1,239 @@
+// Terrain::sampleHeights: the terrain function of Terrain::getHeight on
+// several points at once (AVX2: 8, SSE2: 4, otherwise 1 lane), branch free
+// and with polynomial sin / exp.
+//
+// Error bound: fastSin is within 3.5e-7 of sin for |x| < 1.6e6 (Cody-Waite
+// range reduction to [-pi, pi] + degree 11 polynomial), which covers the
+// streamed terrain out to a few million units; fastExp within 3e-7 relative
+// for x in [-87, 88] and clamped outside. On the terrain (maxHeight 15) the
+// heights stay within 2.5e-4 of Terrain::sampleHeight, see
+// tests/terrainHeights.cpp. Far from the origin the arguments of the cliff
+// noise sins (0.4 z, 12 x / size) are large, and one ulp of them (4e-3 at
+// z = 1e5) moves the height by the sin's amplitude times that: the two paths
+// may round them apart, which adds 0.2 ulp(0.4 z) + 0.08 ulp(12 x / size)
+// to the bound. An fma would round them differently again, this file is
+// built without contraction. The worst points are on the tepui cliffs, where
+// the slope turns float rounding of the inputs into 1e-4 of height; on
+// the smooth parts both agree to a few ulp.
+#include "terrain.h"
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TERRAIN_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TERRAIN_SIMD_SSE2
+#endif
+
+namespace {
+
+// one register of lanes with the handful of operations the kernel needs
+#if defined(TERRAIN_SIMD_AVX2)
+
+struct Lanes {
+    static const int WIDTH = 8;
+    __m256 v;
+    Lanes() {}
+    Lanes(__m256 v) : v(v) {}
+    Lanes(float f) : v(_mm256_set1_ps(f)) {}
+    static Lanes load(const float* p) { return _mm256_loadu_ps(p); }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+};
+inline Lanes operator+(Lanes a, Lanes b) { return _mm256_add_ps(a.v, b.v); }
+inline Lanes operator-(Lanes a, Lanes b) { return _mm256_sub_ps(a.v, b.v); }
+inline Lanes operator*(Lanes a, Lanes b) { return _mm256_mul_ps(a.v, b.v); }
+inline Lanes operator/(Lanes a, Lanes b) { return _mm256_div_ps(a.v, b.v); }
+inline Lanes min(Lanes a, Lanes b) { return _mm256_min_ps(a.v, b.v); }
+inline Lanes max(Lanes a, Lanes b) { return _mm256_max_ps(a.v, b.v); }
+inline Lanes abs(Lanes a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+inline Lanes round(Lanes a) {
+    return _mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+// 2^n for integral n in [-126, 127]
+inline Lanes exp2i(Lanes n) {
+    __m256i e = _mm256_add_epi32(_mm256_cvtps_epi32(n.v), _mm256_set1_epi32(127));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(e, 23));
+}
+
+#elif defined(TERRAIN_SIMD_SSE2)
+
+struct Lanes {
+    static const int WIDTH = 4;
+    __m128 v;
+    Lanes() {}
+    Lanes(__m128 v) : v(v) {}
+    Lanes(float f) : v(_mm_set1_ps(f)) {}
+    static Lanes load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+};
+inline Lanes operator+(Lanes a, Lanes b) { return _mm_add_ps(a.v, b.v); }
+inline Lanes operator-(Lanes a, Lanes b) { return _mm_sub_ps(a.v, b.v); }
+inline Lanes operator*(Lanes a, Lanes b) { return _mm_mul_ps(a.v, b.v); }
+inline Lanes operator/(Lanes a, Lanes b) { return _mm_div_ps(a.v, b.v); }
+inline Lanes min(Lanes a, Lanes b) { return _mm_min_ps(a.v, b.v); }
+inline Lanes max(Lanes a, Lanes b) { return _mm_max_ps(a.v, b.v); }
+inline Lanes abs(Lanes a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+// SSE2 has no round, the conversion rounds to nearest (default MXCSR)
+inline Lanes round(Lanes a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a.v)); }
+inline Lanes exp2i(Lanes n) {
+    __m128i e = _mm_add_epi32(_mm_cvtps_epi32(n.v), _mm_set1_epi32(127));
+    return _mm_castsi128_ps(_mm_slli_epi32(e, 23));
+}
+
+#else
+
+struct Lanes {
+    static const int WIDTH = 1;
+    float v;
+    Lanes() {}
+    Lanes(float f) : v(f) {}
+    static Lanes load(const float* p) { return *p; }
+    void store(float* p) const { *p = v; }
+};
+inline Lanes operator+(Lanes a, Lanes b) { return a.v + b.v; }
+inline Lanes operator-(Lanes a, Lanes b) { return a.v - b.v; }
+inline Lanes operator*(Lanes a, Lanes b) { return a.v * b.v; }
+inline Lanes operator/(Lanes a, Lanes b) { return a.v / b.v; }
+inline Lanes min(Lanes a, Lanes b) { return a.v < b.v ? a.v : b.v; }
+inline Lanes max(Lanes a, Lanes b) { return a.v > b.v ? a.v : b.v; }
+inline Lanes abs(Lanes a) { return std::fabs(a.v); }
+inline Lanes round(Lanes a) { return (float)std::lrint(a.v); }
+inline Lanes exp2i(Lanes n) { return std::ldexp(1.0f, (int)n.v); }
+
+#endif
+
+inline Lanes clamp01(Lanes a) {
+    return min(max(a, Lanes(0.0f)), Lanes(1.0f));
+}
+
+inline Lanes smoothstep(float edge0, float edge1, Lanes x) {
+    Lanes t = clamp01((x - Lanes(edge0)) / Lanes(edge1 - edge0));
+    return t * t * (Lanes(3.0f) - Lanes(2.0f) * t);
+}
+
+inline Lanes fastSin(Lanes x) {
+    // x = k * 2pi + r, r in [-pi, pi]. 2pi is split in four, the first three
+    // of 6 significant bits, so k * part is exact for |k| < 2^18 and r keeps
+    // its precision out to |x| ~ 1.6e6
+    const float TWO_PI_A = 6.25f;
+    const float TWO_PI_B = 3.22265625e-2f;
+    const float TWO_PI_C = 9.46044921875e-4f;
+    const float TWO_PI_D = 1.2699757462542038e-5f;
+    const float PI = 3.14159265358979f;
+    Lanes k = round(x * Lanes(0.15915494309189535f));
+    Lanes r = x - k * Lanes(TWO_PI_A) - k * Lanes(TWO_PI_B) - k * Lanes(TWO_PI_C) -
+        k * Lanes(TWO_PI_D);
+
+    // sin(r) = sin(pi - r) = sin(-pi - r): fold into [-pi/2, pi/2]
+    r = min(r, Lanes(PI) - r);
+    r = max(r, Lanes(-PI) - r);
+
+    Lanes r2 = r * r;
+    Lanes p = Lanes(-2.50521083854417e-8f);
+    p = p * r2 + Lanes(2.75573192239859e-6f);
+    p = p * r2 + Lanes(-1.98412698412698e-4f);
+    p = p * r2 + Lanes(8.33333333333333e-3f);
+    p = p * r2 + Lanes(-1.66666666666667e-1f);
+    return r + r * r2 * p;
+}
+
+inline Lanes fastExp(Lanes x) {
+    // below -87 the result (< 2e-38) is rounded up to exp(-87)
+    x = min(max(x, Lanes(-87.0f)), Lanes(88.0f));
+
+    // x = n * ln2 + f, f in [-ln2/2, ln2/2]
+    const float LN2_HI = 0.693359375f;
+    const float LN2_LO = -2.12194440e-4f;
+    Lanes n = round(x * Lanes(1.44269504088896341f));
+    Lanes f = x - n * Lanes(LN2_HI) - n * Lanes(LN2_LO);
+
+    // degree 6 Taylor of e^f
+    Lanes p = Lanes(1.0f / 720.0f);
+    p = p * f + Lanes(1.0f / 120.0f);
+    p = p * f + Lanes(1.0f / 24.0f);
+    p = p * f + Lanes(1.0f / 6.0f);
+    p = p * f + Lanes(0.5f);
+    p = p * f + Lanes(1.0f);
+    p = p * f + Lanes(1.0f);
+    return p * exp2i(n);
+}
+
+inline Lanes plateau(Lanes x, float center, float topWidth, float cliffWidth) {
+    Lanes d = abs(x - Lanes(center));
+    Lanes t = clamp01((d - Lanes(topWidth)) / Lanes(cliffWidth));
+    return Lanes(1.0f) - t * t * (Lanes(3.0f) - Lanes(2.0f) * t);
+}
+
+// same steps as Terrain::getHeight
+inline Lanes height(Lanes x, Lanes z, Lanes size, float maxHeight) {
+    Lanes nx = x / size;
+    Lanes nz = z / size;
+
+    // edge wobble
+    Lanes edgeWobble = fastSin(nz * Lanes(6.0f)) * Lanes(0.035f)
+        + fastSin(nz * Lanes(13.0f)) * Lanes(0.015f);
+    Lanes wx = nx + edgeWobble;
+
+    Lanes left = plateau(wx, -0.30f, 0.10f, 0.015f);
+    Lanes right = plateau(wx, 0.30f, 0.14f, 0.015f);
+
+    Lanes h = left * Lanes(maxHeight * 0.55f) + right * Lanes(maxHeight * 1.15f);
+
+    // canyon
+    Lanes meander = fastSin(nz * Lanes(16.0f)) * Lanes(0.025f);
+    Lanes sx = nx + meander;
+    Lanes wide = sx / Lanes(0.04f);
+    Lanes narrow = sx / Lanes(0.012f);
+    h = h - fastExp(Lanes(0.0f) - wide * wide) * Lanes(maxHeight);
+    h = h + fastExp(Lanes(0.0f) - narrow * narrow) * Lanes(maxHeight * 0.12f);
+
+    // masks
+    Lanes topMask = max(left, right);
+    Lanes edgeMask = Lanes(1.0f) - smoothstep(0.7f, 1.0f, topMask);
+
+    // rocky cliffs
+    Lanes cliffNoise = fastSin(h * Lanes(5.0f) + z * Lanes(0.4f)) * Lanes(0.20f)
+        + fastSin(h * Lanes(17.0f) + nx * Lanes(12.0f)) * Lanes(0.08f);
+
+    Lanes slopeMask = smoothstep(0.2f, 0.6f, edgeMask);
+
+    return h + cliffNoise * slopeMask;
+}
+
+}
+
+void Terrain::sampleHeights(const float* x, const float* z, float* out, size_t n,
+    float size, float maxHeight) {
+    const size_t W = Lanes::WIDTH;
+    Lanes s(size);
+
+    size_t i = 0;
+    for (; i + W <= n; i += W) {
+        height(Lanes::load(x + i), Lanes::load(z + i), s, maxHeight).store(out + i);
+    }
+
+    // the tail goes through the same kernel, padded
+    if (i < n) {
+        float px[W], pz[W], ph[W];
+        for (size_t k = 0; k < W; ++k) {
+            size_t src = (i + k < n) ? i + k : n - 1;
+            px[k] = x[src];
+            pz[k] = z[src];
+        }
+        height(Lanes::load(px), Lanes::load(pz), s, maxHeight).store(ph);
+        for (size_t k = 0; i + k < n; ++k) {
+            out[i + k] = ph[k];
+        }
+    }
+}
+
+const char* Terrain::simdPath() {
+#if defined(TERRAIN_SIMD_AVX2)
+    return "AVX2";
+#elif defined(TERRAIN_SIMD_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,276 @@
+#include "terrainStreamer.h"
+#include "heightfield.h"
+#include "river.h"
+#include <algorithm>
+#include <cmath>
+#include <common/frustum.h>
+
+using namespace glm;
+using namespace std;
+
+TerrainStreamer::TerrainStreamer(float terrainSize, float maxHeight, float waterLevel,
+    float tileSize, int tileResolution, size_t memoryBudget, int workerCount)
+    : m_terrainSize(terrainSize), m_maxHeight(maxHeight), m_waterLevel(waterLevel),
+    m_tileSize(tileSize), m_tileResolution(tileResolution), m_memoryBudget(memoryBudget),
+    m_viewRadius(150.0f), m_lookAhead(4.0f), m_frame(0), m_residentBytes(0),
+    m_quit(false) {
+    workerCount = glm::max(1, workerCount);
+    for (int i = 0; i < workerCount; ++i) {
+        m_workers.push_back(thread(&TerrainStreamer::workerLoop, this));
+    }
+}
+
+TerrainStreamer::~TerrainStreamer() {
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_quit = true;
+        m_requests.clear();
+    }
+    m_wake.notify_all();
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        m_workers[i].join();
+    }
+
+    for (auto& entry : m_tiles) {
+        destroy(entry.second);
+    }
+}
+
+void TerrainStreamer::workerLoop() {
+    while (true) {
+        Tile* tile;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_quit || !m_requests.empty(); });
+            if (m_quit) return;
+            tile = m_requests.front();
+            m_requests.pop_front();
+            tile->state = BUILDING;
+        }
+
+        buildTile(*tile);
+
+        lock_guard<mutex> lock(m_mutex);
+        tile->state = READY;
+        m_ready.push_back(tile);
+    }
+}
+
+// everything but GL: bake, terrain grid, water
+void TerrainStreamer::buildTile(Tile& tile) const {
+    int res = m_tileResolution;
+    float x0 = tile.tx * m_tileSize;
+    float z0 = tile.tz * m_tileSize;
+
+    Heightfield field;
+    field.bake(x0, z0, m_tileSize, res, m_terrainSize, m_maxHeight);
+    Terrain::buildGrid(field, res, tile.grid);
+
+    // the grid takes one-sided differences on its border, use the
+    // neighbouring tile's heights instead so the shading has no seams
+    float step = field.getStep();
+    int n = res + 1;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            if (i != 0 && i != res && j != 0 && j != res) continue;
+            vec3& p = tile.grid.positions[i * n + j];
+            float dx = Terrain::sampleHeight(p.x + step, p.z, m_terrainSize, m_maxHeight) -
+                Terrain::sampleHeight(p.x - step, p.z, m_terrainSize, m_maxHeight);
+            float dz = Terrain::sampleHeight(p.x, p.z + step, m_terrainSize, m_maxHeight) -
+                Terrain::sampleHeight(p.x, p.z - step, m_terrainSize, m_maxHeight);
+            tile.grid.normals[i * n + j] = normalize(vec3(-dx, 2.0f * step, -dz));
+        }
+    }
+
+    float minY = m_waterLevel, maxY = m_waterLevel;
+    for (size_t v = 0; v < tile.grid.positions.size(); ++v) {
+        minY = glm::min(minY, tile.grid.positions[v].y);
+        maxY = glm::max(maxY, tile.grid.positions[v].y);
+    }
+    tile.min = vec3(x0, minY, z0);
+    tile.max = vec3(x0 + m_tileSize, maxY, z0 + m_tileSize);
+
+    // water at half the terrain density is plenty for a flat surface
+    vector<vec3> vertices, normals;
+    vector<vec2> uvs;
+    River::buildFloodedCanyon(field, res / 2, m_waterLevel, vertices, uvs, normals);
+    if (!vertices.empty()) {
+        indexVBO(vertices, uvs, normals, tile.waterIndices, tile.waterVertices,
+            tile.waterUVs, tile.waterNormals);
+    }
+}
+
+void TerrainStreamer::update(const vec3& position, const vec3& velocity) {
+    m_frame++;
+
+    // tiles touching either circle, on the xz plane
+    vec2 centers[2] = {
+        vec2(position.x, position.z),
+        vec2(position.x, position.z) + vec2(velocity.x, velocity.z) * m_lookAhead
+    };
+    vector<Tile*> queued;
+    for (int c = 0; c < 2; ++c) {
+        int tx0 = (int)floor((centers[c].x - m_viewRadius) / m_tileSize);
+        int tx1 = (int)floor((centers[c].x + m_viewRadius) / m_tileSize);
+        int tz0 = (int)floor((centers[c].y - m_viewRadius) / m_tileSize);
+        int tz1 = (int)floor((centers[c].y + m_viewRadius) / m_tileSize);
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            for (int tz = tz0; tz <= tz1; ++tz) {
+                vec2 lo = vec2(tx, tz) * m_tileSize;
+                vec2 nearest = clamp(centers[c], lo, lo + vec2(m_tileSize));
+                float d = distance(nearest, centers[c]);
+                if (d > m_viewRadius) continue;
+
+                Tile*& tile = m_tiles[key(tx, tz)];
+                if (!tile) {
+                    tile = new Tile();
+                    tile->tx = tx;
+                    tile->tz = tz;
+                    tile->state = QUEUED;
+                    tile->resident = false;
+                    tile->mesh = nullptr;
+                    tile->water = nullptr;
+                    tile->bytes = 0;
+                    tile->wantedFrame = -1;
+                }
+                if (tile->wantedFrame != m_frame) {
+                    tile->wantedFrame = m_frame;
+                    tile->priority = d;
+                    queued.push_back(tile);
+                }
+                else {
+                    tile->priority = glm::min(tile->priority, d);
+                }
+            }
+        }
+    }
+
+    // replace the request queue: wanted tiles still waiting, closest first.
+    // Waiting tiles that are no longer wanted are dropped before any work
+    sort(queued.begin(), queued.end(), [](const Tile* a, const Tile* b) {
+        return a->priority < b->priority;
+    });
+    vector<Tile*> dropped;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        for (size_t i = 0; i < m_requests.size(); ++i) {
+            if (m_requests[i]->wantedFrame != m_frame) dropped.push_back(m_requests[i]);
+        }
+        m_requests.clear();
+        for (size_t i = 0; i < queued.size(); ++i) {
+            if (queued[i]->state == QUEUED) m_requests.push_back(queued[i]);
+        }
+    }
+    m_wake.notify_all();
+
+    for (size_t i = 0; i < dropped.size(); ++i) {
+        m_tiles.erase(key(dropped[i]->tx, dropped[i]->tz));
+        delete dropped[i];
+    }
+
+    evict();
+}
+
+int TerrainStreamer::uploadReady(int maxTiles) {
+    vector<Tile*> ready;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        int count = glm::min(maxTiles, (int)m_ready.size());
+        ready.assign(m_ready.begin(), m_ready.begin() + count);
+        m_ready.erase(m_ready.begin(), m_ready.begin() + count);
+    }
+
+    int uploaded = 0;
+    for (size_t i = 0; i < ready.size(); ++i) {
+        Tile* tile = ready[i];
+        // flew past it while it was built
+        if (tile->wantedFrame != m_frame) {
+            m_tiles.erase(key(tile->tx, tile->tz));
+            destroy(tile);
+            continue;
+        }
+
+        TerrainGrid& grid = tile->grid;
+        tile->mesh = new Drawable(grid.positions, grid.uvs, grid.normals, grid.indices);
+        tile->bytes = tile->mesh->getGPUBytes() + tile->mesh->getCPUBytes();
+        if (!tile->waterVertices.empty()) {
+            tile->water = new Drawable(tile->waterVertices, tile->waterUVs,
+                tile->waterNormals, tile->waterIndices);
+            tile->bytes += tile->water->getGPUBytes() + tile->water->getCPUBytes();
+        }
+
+        // the Drawables own the data now
+        grid = TerrainGrid();
+        vector<vec3>().swap(tile->waterVertices);
+        vector<vec3>().swap(tile->waterNormals);
+        vector<vec2>().swap(tile->waterUVs);
+        vector<unsigned int>().swap(tile->waterIndices);
+
+        tile->resident = true;
+        m_residentBytes += tile->bytes;
+        uploaded++;
+    }
+    return uploaded;
+}
+
+// farthest unwanted resident tiles first, until under budget
+void TerrainStreamer::evict() {
+    if (m_residentBytes <= m_memoryBudget) return;
+
+    vector<Tile*> candidates;
+    for (auto& entry : m_tiles) {
+        Tile* tile = entry.second;
+        if (tile->resident && tile->wantedFrame != m_frame) {
+            candidates.push_back(tile);
+        }
+    }
+    // the oldest were wanted the longest time ago, i.e. are the farthest back
+    sort(candidates.begin(), candidates.end(), [](const Tile* a, const Tile* b) {
+        return a->wantedFrame < b->wantedFrame;
+    });
+
+    for (size_t i = 0; i < candidates.size() && m_residentBytes > m_memoryBudget; ++i) {
+        m_tiles.erase(key(candidates[i]->tx, candidates[i]->tz));
+        destroy(candidates[i]);
+    }
+}
+
+void TerrainStreamer::destroy(Tile* tile) {
+    if (tile->resident) {
+        m_residentBytes -= tile->bytes;
+    }
+    delete tile->mesh;
+    delete tile->water;
+    delete tile;
+}
+
+void TerrainStreamer::drawTerrain(const Frustum& frustum) const {
+    for (auto& entry : m_tiles) {
+        const Tile* tile = entry.second;
+        if (!tile->resident || !frustum.intersects(tile->min, tile->max)) continue;
+        tile->mesh->bind();
+        tile->mesh->draw();
+    }
+}
+
+void TerrainStreamer::drawWater(const Frustum& frustum) const {
+    for (auto& entry : m_tiles) {
+        const Tile* tile = entry.second;
+        if (!tile->resident || !tile->water ||
+            !frustum.intersects(tile->min, tile->max)) continue;
+        tile->water->bind();
+        tile->water->draw();
+    }
+}
+
+int TerrainStreamer::getResidentCount() const {
+    int count = 0;
+    for (auto& entry : m_tiles) {
+        if (entry.second->resident) count++;
+    }
+    return count;
+}
+
+int TerrainStreamer::getPendingCount() const {
+    return (int)m_tiles.size() - getResidentCount();
+}
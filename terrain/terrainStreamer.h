@@ -0,0 +1,112 @@
+#ifndef TERRAIN_STREAMER_H
+#define TERRAIN_STREAMER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <common/model.h>
+
+#include "terrain.h"
+
+class Frustum;
+
+// Endless terrain: square tiles of the analytic terrain function, generated
+// around the house and ahead of its velocity.
+// Worker threads bake and mesh the tiles (terrain grid + flooded canyon
+// water); update() only decides which tiles are wanted and uploadReady()
+// turns a bounded number of finished tiles into GL meshes, so the render
+// thread never generates anything. Tiles that are no longer wanted are
+// evicted, farthest first, once the resident tiles exceed the memory budget.
+// update(), uploadReady(), draw*() and the destructor run on the GL thread.
+class TerrainStreamer {
+public:
+    TerrainStreamer(float terrainSize, float maxHeight, float waterLevel,
+        float tileSize = 50.0f, int tileResolution = 100,
+        size_t memoryBudget = 128u << 20, int workerCount = 2);
+    ~TerrainStreamer();
+
+    TerrainStreamer(const TerrainStreamer&) = delete;
+    TerrainStreamer& operator=(const TerrainStreamer&) = delete;
+
+    // tiles within the view radius of position and of where the velocity
+    // takes it in lookAhead seconds, closest first
+    void update(const glm::vec3& position, const glm::vec3& velocity);
+    // GL upload of at most maxTiles finished tiles, returns how many
+    int uploadReady(int maxTiles = 2);
+
+    // resident tiles inside the frustum; shader, material and model matrix
+    // (identity) are set by the caller
+    void drawTerrain(const Frustum& frustum) const;
+    void drawWater(const Frustum& frustum) const;
+
+    void setViewRadius(float radius) { m_viewRadius = radius; }
+    void setLookAhead(float seconds) { m_lookAhead = seconds; }
+
+    int getResidentCount() const;
+    size_t getResidentBytes() const { return m_residentBytes; }
+    // requested and not uploaded yet
+    int getPendingCount() const;
+
+private:
+    enum State { QUEUED, BUILDING, READY };
+
+    struct Tile {
+        int tx, tz;
+        State state;           // guarded by m_mutex
+        // main thread only
+        bool resident;         // uploaded
+        long long wantedFrame;
+        float priority;        // distance
+        glm::vec3 min, max;
+
+        // built by a worker, released after the upload
+        TerrainGrid grid;
+        std::vector<glm::vec3> waterVertices, waterNormals;
+        std::vector<glm::vec2> waterUVs;
+        std::vector<unsigned int> waterIndices;
+
+        // GL thread
+        Drawable* mesh;
+        Drawable* water;
+        size_t bytes;
+    };
+
+    // through unsigned, shifting a negative tx would be undefined
+    static unsigned long long key(int tx, int tz) {
+        return (unsigned long long)(unsigned int)tx << 32 | (unsigned int)tz;
+    }
+
+    void workerLoop();
+    void buildTile(Tile& tile) const;
+    void evict();
+    void destroy(Tile* tile);
+
+    float m_terrainSize;
+    float m_maxHeight;
+    float m_waterLevel;
+    float m_tileSize;
+    int m_tileResolution;
+    size_t m_memoryBudget;
+    float m_viewRadius;
+    float m_lookAhead;
+
+    // GL thread
+    std::unordered_map<unsigned long long, Tile*> m_tiles;
+    long long m_frame;
+    size_t m_residentBytes;
+
+    // shared with the workers
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<Tile*> m_requests; // closest first
+    std::vector<Tile*> m_ready;
+    bool m_quit;
+    std::vector<std::thread> m_workers;
+};
+
+#endif
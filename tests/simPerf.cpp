@@ -0,0 +1,507 @@
+// Performance gates on headless scenarios: every scenario builds a World
+// without a window, runs its prelude, then a fixed number of measured steps,
+// recording the wall time and the heap allocations (operator new calls) of
+// every step. Exits with 1 when the median step time or the allocations per
+// step exceed the baseline by more than the tolerance, when a step after the
+// warm-up allocates at all, or when a scenario did not do what it is meant
+// to (no crash, no ropes).
+//
+// The baselines (tests/simPerfBaseline.json) are wall times of one machine
+// and an optimized build; after an intended change, or on another machine,
+// refresh them with --update-baseline. Unoptimized builds, --no-time-gate
+// and a non-empty SIM_PERF_NO_TIME_GATE (for shared CI machines) only gate
+// the allocations.
+//
+// usage: sim_perf_test [--baseline file.json] [--scenario name]
+//                      [--update-baseline] [--tolerance f]
+//                      [--alloc-tolerance f] [--no-time-gate] [--threads n]
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <sim/world.h>
+
+using namespace std;
+
+// --- allocation counting ----------------------------------------------------
+
+static atomic<long long> g_allocations(0);
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    g_allocations.fetch_add(1, memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { free(p); }
+
+// --- scenarios --------------------------------------------------------------
+
+static const float DT = 1.0f / 120.0f;     // the game's fixed step
+static const unsigned int SEED = 7;
+// measured steps that may still grow the buffers (first pops, first ropes),
+// every later step must not allocate
+static const int WARMUP_STEPS = 120;
+
+// times of debug builds say nothing about the baseline
+#if defined(__OPTIMIZE__) || (defined(_MSC_VER) && defined(NDEBUG))
+static const bool OPTIMIZED_BUILD = true;
+#else
+static const bool OPTIMIZED_BUILD = false;
+#endif
+
+struct Scenario {
+    string name;
+    int balloons;
+    int birds;
+    int steps;                              // measured
+    function<bool(World&)> prelude;         // not measured, false = failed
+    function<bool(World&)> check;           // after the steps, false = failed
+};
+
+static vector<Scenario> makeScenarios() {
+    vector<Scenario> scenarios;
+
+    // the game as shipped
+    Scenario small;
+    small.name = "15_balloons_10_birds";
+    small.balloons = 15;
+    small.birds = 10;
+    small.steps = 1200;
+    scenarios.push_back(small);
+
+    Scenario large;
+    large.name = "1k_balloons_200_birds";
+    large.balloons = 1000;
+    large.birds = 200;
+    large.steps = 600;
+    scenarios.push_back(large);
+
+    // lift the house, pop everything, measure the fall, crash and sparks
+    Scenario crash;
+    crash.name = "crash_explosion";
+    crash.balloons = 60;
+    crash.birds = 10;
+    crash.steps = 900;
+    crash.prelude = [](World& world) {
+        float start = world.house->getPosition().y;
+        for (int i = 0; i < 6000; ++i) {
+            world.step(DT);
+            if (world.house->getPosition().y > start + 15.0f) {
+                world.popAllBalloons();
+                return true;
+            }
+        }
+        printf("the house never took off\n");
+        return false;
+    };
+    crash.check = [](World& world) {
+        if (!world.houseCrashed) printf("the house did not crash\n");
+        return world.houseCrashed;
+    };
+    scenarios.push_back(crash);
+
+    // every balloon popped at once, its rope left hanging off the house
+    Scenario ropes;
+    ropes.name = "100_popped_ropes";
+    ropes.balloons = 100;
+    ropes.birds = 10;
+    ropes.steps = 1200;
+    ropes.prelude = [](World& world) {
+        world.popAllBalloons();
+        return true;
+    };
+    ropes.check = [](World& world) {
+        int count = world.balloons.getRopes().ropeCount();
+        if (count < 100) printf("only %d verlet ropes\n", count);
+        return count >= 100;
+    };
+    scenarios.push_back(ropes);
+
+    return scenarios;
+}
+
+struct Measurement {
+    int steps;
+    double msPerStep;       // median, what the gate compares
+    double meanMs;
+    double p95Ms;
+    double allocsPerStep;   // mean
+    long long maxAllocs;    // in one step
+    long long steadyAllocs; // after WARMUP_STEPS, must be 0
+};
+
+static bool run(const Scenario& scenario, int threads, Measurement& m) {
+    WorldConfig config;
+    config.numBalloons = scenario.balloons;
+    config.numBirds = scenario.birds;
+    config.seed = SEED;
+    config.threads = threads;
+
+    World world(config);
+    if (scenario.prelude && !scenario.prelude(world)) return false;
+
+    vector<double> times(scenario.steps);
+    long long total = 0;
+    m.maxAllocs = 0;
+    m.steadyAllocs = 0;
+    for (int i = 0; i < scenario.steps; ++i) {
+        long long allocations = g_allocations.load(memory_order_relaxed);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        world.step(DT);
+        times[i] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        allocations = g_allocations.load(memory_order_relaxed) - allocations;
+        total += allocations;
+        m.maxAllocs = std::max(m.maxAllocs, allocations);
+        if (i >= WARMUP_STEPS) m.steadyAllocs += allocations;
+    }
+
+    m.steps = scenario.steps;
+    m.allocsPerStep = (double)total / scenario.steps;
+    double sum = 0.0;
+    for (double t : times) sum += t;
+    m.meanMs = sum / scenario.steps;
+    sort(times.begin(), times.end());
+    m.msPerStep = times[times.size() / 2];
+    m.p95Ms = times[std::min(times.size() - 1, times.size() * 95 / 100)];
+
+    return !scenario.check || scenario.check(world);
+}
+
+// --- baseline file ----------------------------------------------------------
+
+struct Baseline {
+    double msPerStep;
+    double allocsPerStep;
+};
+
+struct BaselineFile {
+    double timeTolerance = 1.0;     // fail above baseline * (1 + tolerance)
+    double allocTolerance = 0.1;
+    map<string, Baseline> scenarios;
+};
+
+// just enough JSON for the baseline file: objects of numbers
+class JsonReader {
+public:
+    explicit JsonReader(const string& text) : m_text(text), m_at(0) {}
+
+    // calls member(key) for every member of the object at the cursor,
+    // member reads the value
+    bool readObject(const function<bool(const string&)>& member) {
+        if (!consume('{')) return false;
+        if (consume('}')) return true;
+        do {
+            string key;
+            if (!readString(key) || !consume(':') || !member(key)) return false;
+        } while (consume(','));
+        return consume('}');
+    }
+
+    bool readNumber(double& value) {
+        skipSpace();
+        const char* start = m_text.c_str() + m_at;
+        char* end = nullptr;
+        value = strtod(start, &end);
+        if (end == start) return false;
+        m_at += end - start;
+        return true;
+    }
+
+    bool readString(string& value) {
+        if (!consume('"')) return false;
+        value.clear();
+        while (m_at < m_text.size() && m_text[m_at] != '"') {
+            if (m_text[m_at] == '\\') m_at++;
+            if (m_at < m_text.size()) value += m_text[m_at++];
+        }
+        return consume('"');
+    }
+
+    // any value, for keys this reader does not know
+    bool skipValue() {
+        skipSpace();
+        if (m_at >= m_text.size()) return false;
+        char c = m_text[m_at];
+        if (c == '{') return readObject([this](const string&) { return skipValue(); });
+        if (c == '"') {
+            string ignored;
+            return readString(ignored);
+        }
+        if (c == '[') {
+            consume('[');
+            if (consume(']')) return true;
+            do {
+                if (!skipValue()) return false;
+            } while (consume(','));
+            return consume(']');
+        }
+        for (const char* word : {"true", "false", "null"}) {
+            if (m_text.compare(m_at, strlen(word), word) == 0) {
+                m_at += strlen(word);
+                return true;
+            }
+        }
+        double ignored;
+        return readNumber(ignored);
+    }
+
+    bool atEnd() {
+        skipSpace();
+        return m_at == m_text.size();
+    }
+
+private:
+    void skipSpace() {
+        while (m_at < m_text.size() && isspace((unsigned char)m_text[m_at])) m_at++;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (m_at < m_text.size() && m_text[m_at] == c) {
+            m_at++;
+            return true;
+        }
+        return false;
+    }
+
+    const string& m_text;
+    size_t m_at;
+};
+
+static bool readBaseline(const string& path, BaselineFile& file) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    string text;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) text.append(buffer, n);
+    fclose(f);
+
+    JsonReader json(text);
+    bool ok = json.readObject([&](const string& key) {
+        if (key == "tolerance") {
+            return json.readObject([&](const string& kind) {
+                if (kind == "time") return json.readNumber(file.timeTolerance);
+                if (kind == "allocations") return json.readNumber(file.allocTolerance);
+                return json.skipValue();
+            });
+        }
+        if (key == "scenarios") {
+            return json.readObject([&](const string& name) {
+                Baseline baseline = {0.0, 0.0};
+                bool read = json.readObject([&](const string& field) {
+                    if (field == "ms_per_step") return json.readNumber(baseline.msPerStep);
+                    if (field == "allocs_per_step") return json.readNumber(baseline.allocsPerStep);
+                    return json.skipValue();
+                });
+                file.scenarios[name] = baseline;
+                return read;
+            });
+        }
+        return json.skipValue();
+    });
+    if (!ok || !json.atEnd()) {
+        printf("%s is not a valid baseline file\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool writeBaseline(const string& path, const BaselineFile& file,
+    const map<string, Measurement>& measured) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    fprintf(f, "{\n  \"tolerance\": {\"time\": %g, \"allocations\": %g},\n  \"scenarios\": {",
+        file.timeTolerance, file.allocTolerance);
+    bool first = true;
+    for (const auto& entry : file.scenarios) {
+        fprintf(f, "%s\n    \"%s\": {", first ? "" : ",", entry.first.c_str());
+        auto m = measured.find(entry.first);
+        // extra information, only for the scenarios just measured
+        if (m != measured.end()) {
+            fprintf(f, "\"steps\": %d, \"mean_ms\": %.6f, \"p95_ms\": %.6f, \"max_allocs\": %lld, ",
+                m->second.steps, m->second.meanMs, m->second.p95Ms, m->second.maxAllocs);
+        }
+        fprintf(f, "\"ms_per_step\": %.6f, \"allocs_per_step\": %.4f}",
+            entry.second.msPerStep, entry.second.allocsPerStep);
+        first = false;
+    }
+    fprintf(f, "\n  }\n}\n");
+    fclose(f);
+    return true;
+}
+
+// --- main -------------------------------------------------------------------
+
+struct Options {
+    string baselinePath = "simPerfBaseline.json";
+    string scenario;                // empty = all
+    bool update = false;
+    double timeTolerance = -1.0;    // < 0: the file's
+    double allocTolerance = -1.0;
+    bool gateTime = OPTIMIZED_BUILD;
+    int threads = 1;
+};
+
+static bool parseArguments(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--baseline" && hasValue) {
+            options.baselinePath = argv[++i];
+        }
+        else if (arg == "--scenario" && hasValue) {
+            options.scenario = argv[++i];
+        }
+        else if (arg == "--update-baseline") {
+            options.update = true;
+        }
+        else if (arg == "--tolerance" && hasValue) {
+            options.timeTolerance = atof(argv[++i]);
+        }
+        else if (arg == "--alloc-tolerance" && hasValue) {
+            options.allocTolerance = atof(argv[++i]);
+        }
+        else if (arg == "--no-time-gate") {
+            options.gateTime = false;
+        }
+        else if (arg == "--threads" && hasValue) {
+            options.threads = atoi(argv[++i]);
+        }
+        else {
+            printf("Unknown argument: %s\n", arg.c_str());
+            printf("usage: %s [--baseline file.json] [--scenario name] [--update-baseline] "
+                "[--tolerance f] [--alloc-tolerance f] [--no-time-gate] [--threads n]\n",
+                argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    const char* noTimeGate = getenv("SIM_PERF_NO_TIME_GATE");
+    if (noTimeGate && noTimeGate[0] != '\0') {
+        options.gateTime = false;
+    }
+    if (!parseArguments(argc, argv, options)) {
+        return 1;
+    }
+
+    BaselineFile baseline;
+    bool haveBaseline = readBaseline(options.baselinePath, baseline);
+    if (!haveBaseline && !options.update) {
+        printf("no baseline in %s, create it with --update-baseline\n",
+            options.baselinePath.c_str());
+        return 1;
+    }
+    if (options.update && !OPTIMIZED_BUILD) {
+        printf("not an optimized build, its times would make a useless baseline\n");
+        return 1;
+    }
+    if (!options.gateTime) {
+        printf("%s, only the allocations are gated\n",
+            OPTIMIZED_BUILD ? "time gate off" : "not an optimized build");
+    }
+    if (options.timeTolerance >= 0.0) baseline.timeTolerance = options.timeTolerance;
+    if (options.allocTolerance >= 0.0) baseline.allocTolerance = options.allocTolerance;
+
+    vector<Scenario> scenarios = makeScenarios();
+    map<string, Measurement> measured;
+    bool failed = false;
+    int ran = 0;
+    for (const Scenario& scenario : scenarios) {
+        if (!options.scenario.empty() && scenario.name != options.scenario) continue;
+        ran++;
+
+        Measurement m;
+        if (!run(scenario, options.threads, m)) {
+            printf("FAIL %s: the scenario did not run as intended\n", scenario.name.c_str());
+            failed = true;
+            continue;
+        }
+        measured[scenario.name] = m;
+        printf("%s: %d steps, %.4f ms/step (median; mean %.4f, p95 %.4f), "
+            "%.3f allocations/step (max %lld in a step, %lld after the warm-up)\n",
+            scenario.name.c_str(), m.steps, m.msPerStep, m.meanMs, m.p95Ms, m.allocsPerStep,
+            m.maxAllocs, m.steadyAllocs);
+
+        // absolute, whatever the baseline says
+        if (m.steadyAllocs > 0) {
+            printf("FAIL %s: %lld allocations after the first %d steps, the step "
+                "should not allocate\n", scenario.name.c_str(), m.steadyAllocs, WARMUP_STEPS);
+            failed = true;
+            continue;
+        }
+
+        if (options.update) {
+            Baseline b = {m.msPerStep, m.allocsPerStep};
+            baseline.scenarios[scenario.name] = b;
+            continue;
+        }
+
+        auto found = baseline.scenarios.find(scenario.name);
+        if (found == baseline.scenarios.end()) {
+            printf("FAIL %s: no baseline, add it with --update-baseline\n",
+                scenario.name.c_str());
+            failed = true;
+            continue;
+        }
+        const Baseline& b = found->second;
+        double timeLimit = b.msPerStep * (1.0 + baseline.timeTolerance);
+        // plus one allocation per 100 steps, so a 0 baseline is not all or nothing
+        double allocLimit = b.allocsPerStep * (1.0 + baseline.allocTolerance) + 0.01;
+        bool slow = options.gateTime && m.msPerStep > timeLimit;
+        bool allocates = m.allocsPerStep > allocLimit;
+        printf("%s %s: time %.4f ms (limit %.4f), allocations %.3f (limit %.3f)\n",
+            slow || allocates ? "FAIL" : "ok", scenario.name.c_str(), m.msPerStep, timeLimit,
+            m.allocsPerStep, allocLimit);
+        failed = failed || slow || allocates;
+    }
+
+    if (ran == 0) {
+        printf("no scenario named %s\n", options.scenario.c_str());
+        return 1;
+    }
+    if (options.update) {
+        if (failed) {
+            printf("baseline not updated, a scenario failed\n");
+            return 1;
+        }
+        if (!writeBaseline(options.baselinePath, baseline, measured)) {
+            printf("Cannot write %s\n", options.baselinePath.c_str());
+            return 1;
+        }
+        printf("baseline written to %s\n", options.baselinePath.c_str());
+    }
+    return failed ? 1 : 0;
+}
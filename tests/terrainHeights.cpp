@@ -0,0 +1,93 @@
+// Terrain::sampleHeights against the scalar Terrain::sampleHeight.
+// Exits with 1 when a height is further than the stated bound.
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <terrain/terrain.h>
+
+using namespace std;
+
+static const float SIZE = 100.0f;
+static const float MAX_HEIGHT = 15.0f;
+// stated in terrainSimd.cpp
+static const float MAX_ERROR = 2.5e-4f;
+
+static float ulp(float v) {
+    v = fabs(v);
+    return nextafter(v, INFINITY) - v;
+}
+
+// MAX_ERROR plus the rounding of the cliff noise sin arguments far out,
+// stated in terrainSimd.cpp as well
+static float maxError(float maxX, float maxZ) {
+    return MAX_ERROR + 0.2f * ulp(0.4f * maxZ) + 0.08f * ulp(12.0f * maxX / SIZE);
+}
+
+// worst |batch - scalar| over points spread on the square of half size
+// extent around (cx, cz), n not a multiple of the lane count so the tail is
+// covered too
+static float worstError(float cx, float cz, float extent, int side, float* worstX,
+    float* worstZ) {
+    vector<float> x, z;
+    for (int i = 0; i < side; ++i) {
+        for (int j = 0; j < side; ++j) {
+            x.push_back(cx - extent + 2.0f * extent * i / (side - 1));
+            z.push_back(cz - extent + 2.0f * extent * j / (side - 1));
+        }
+    }
+    // a few random points off the grid
+    srand(1);
+    for (int k = 0; k < 10007; ++k) {
+        x.push_back(cx + extent * (2.0f * rand() / RAND_MAX - 1.0f));
+        z.push_back(cz + extent * (2.0f * rand() / RAND_MAX - 1.0f));
+    }
+
+    vector<float> h(x.size());
+    Terrain::sampleHeights(&x[0], &z[0], &h[0], x.size(), SIZE, MAX_HEIGHT);
+
+    float worst = 0.0f;
+    for (size_t i = 0; i < x.size(); ++i) {
+        float error = fabs(h[i] - Terrain::sampleHeight(x[i], z[i], SIZE, MAX_HEIGHT));
+        if (error > worst) {
+            worst = error;
+            *worstX = x[i];
+            *worstZ = z[i];
+        }
+    }
+    return worst;
+}
+
+int main() {
+    printf("sampleHeights path: %s\n", Terrain::simdPath());
+
+    bool ok = true;
+    // the scene, around it, and far away as the streamed terrain goes: down
+    // the canyon (tepui cliffs) and off to the side (cliff noise only)
+    struct Area { float cx, cz, extent; };
+    const Area areas[] = {
+        { 0.0f, 0.0f, SIZE / 2.0f },
+        { 0.0f, 0.0f, 2000.0f },
+        { 0.0f, 1e5f, SIZE / 2.0f },
+        { 1e5f, -1e5f, SIZE / 2.0f },
+    };
+    for (const Area& a : areas) {
+        float wx = 0.0f, wz = 0.0f;
+        float error = worstError(a.cx, a.cz, a.extent, 401, &wx, &wz);
+        float bound = maxError(fabs(a.cx) + a.extent, fabs(a.cz) + a.extent);
+        printf("%g around (%g, %g): max error %.3g at (%.3f, %.3f), bound %.3g\n", a.extent,
+            a.cx, a.cz, error, wx, wz, bound);
+        ok = ok && error <= bound;
+    }
+
+    // n smaller than a register
+    float x[3] = { 1.0f, -20.0f, 30.0f }, z[3] = { 2.0f, 5.0f, -7.0f }, h[3];
+    Terrain::sampleHeights(x, z, h, 3, SIZE, MAX_HEIGHT);
+    for (int i = 0; i < 3; ++i) {
+        ok = ok && fabs(h[i] - Terrain::sampleHeight(x[i], z[i], SIZE, MAX_HEIGHT)) <= MAX_ERROR;
+    }
+
+    printf(ok ? "PASS\n" : "FAIL\n");
+    return ok ? 0 : 1;
+}